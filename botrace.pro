@@ -73,4 +73,5 @@ SUBDIRS += \
     src/core \
     src/editor \
     src/server \
+    src/loadtest \
     src/client
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "animationclock.h"
+
+#include <QTimer>
+
+#include <QDebug>
+
+using namespace BotRace;
+using namespace Client;
+
+/**
+ * @brief Time passed to the tracks by AnimationClock::finishAll(), after the end of every track
+ */
+static const int TRACK_END_TIME = 0x7fffffff;
+
+PauseTrack::PauseTrack( int duration )
+    : m_duration( duration )
+{
+}
+
+void PauseTrack::setDuration( int duration )
+{
+    m_duration = duration;
+}
+
+bool PauseTrack::advanceTrack( int time )
+{
+    return time < m_duration;
+}
+
+AnimationClock::AnimationClock( QObject *parent )
+    : QObject( parent ),
+      m_lastTick( 0 ),
+      m_timeScale( 1.0 )
+{
+    // Qt offers no vsync signal, the interval matches a 60Hz display
+    m_timer = new QTimer( this );
+    m_timer->setInterval( ANIMATION_FRAME_INTERVAL );
+    connect( m_timer, SIGNAL( timeout() ), this, SLOT( tick() ) );
+}
+
+void AnimationClock::startTrack( AnimationTrack *track )
+{
+    bool found = false;
+    for( int i = 0; i < m_tracks.size(); i++ ) {
+        if( m_tracks.at( i ).track == track ) {
+            m_tracks[i].time = 0;
+            found = true;
+            break;
+        }
+    }
+
+    if( !found ) {
+        RunningTrack_T running;
+        running.track = track;
+        running.time = 0;
+        m_tracks.append( running );
+    }
+
+    if( !m_timer->isActive() ) {
+        m_elapsed.start();
+        m_lastTick = 0;
+        m_timer->start();
+    }
+}
+
+bool AnimationClock::isRunning( AnimationTrack *track ) const
+{
+    foreach( const RunningTrack_T & running, m_tracks ) {
+        if( running.track == track ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AnimationClock::setTimeScale( qreal scale )
+{
+    if( scale <= 0 ) {
+        qWarning() << "AnimationClock::setTimeScale || invalid time scale" << scale;
+        return;
+    }
+
+    m_timeScale = scale;
+}
+
+qreal AnimationClock::timeScale() const
+{
+    return m_timeScale;
+}
+
+void AnimationClock::finishAll()
+{
+    QList<AnimationTrack *> finished;
+    foreach( const RunningTrack_T & running, m_tracks ) {
+        running.track->advanceTrack( TRACK_END_TIME );
+        finished.append( running.track );
+    }
+
+    m_tracks.clear();
+    m_timer->stop();
+
+    foreach( AnimationTrack * track, finished ) {
+        emit trackFinished( track );
+    }
+}
+
+void AnimationClock::stopAll()
+{
+    m_tracks.clear();
+    m_timer->stop();
+}
+
+void AnimationClock::tick()
+{
+    qint64 now = m_elapsed.elapsed();
+    qreal delta = ( now - m_lastTick ) * m_timeScale;
+    m_lastTick = now;
+
+    QList<AnimationTrack *> finished;
+    QMutableListIterator<RunningTrack_T> it( m_tracks );
+    while( it.hasNext() ) {
+        RunningTrack_T &running = it.next();
+        running.time += delta;
+
+        if( !running.track->advanceTrack( qRound( running.time ) ) ) {
+            finished.append( running.track );
+            it.remove();
+        }
+    }
+
+    if( m_tracks.isEmpty() ) {
+        m_timer->stop();
+    }
+
+    // the receivers may start new tracks
+    foreach( AnimationTrack * track, finished ) {
+        emit trackFinished( track );
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANIMATIONCLOCK_H
+#define ANIMATIONCLOCK_H
+
+#include <QObject>
+#include <QList>
+#include <QElapsedTimer>
+
+class QTimer;
+
+namespace BotRace {
+namespace Client {
+
+/**
+ * @brief Interval of the AnimationClock in ms, one frame of a 60Hz display
+ */
+const int ANIMATION_FRAME_INTERVAL = 16;
+
+/**
+ * @brief Time scale of the AnimationClock when the fast playback is enabled
+ */
+const qreal FAST_PLAYBACK_TIME_SCALE = 3.0;
+
+/**
+ * @brief Something on the GameScene that changes over time and is driven by the AnimationClock
+ */
+class AnimationTrack {
+public:
+    virtual ~AnimationTrack() {}
+
+    /**
+     * @brief Moves the track to @p time
+     *
+     * Only changes the items of the track, the GameScene repaints all changes of one tick together.
+     *
+     * @param time ms since the track was started, already scaled by the AnimationClock
+     * @return @c true while the track runs, @c false once @p time reached its end
+     */
+    virtual bool advanceTrack( int time ) = 0;
+};
+
+/**
+ * @brief Track that changes nothing, used to keep effects on the board for a while
+ */
+class PauseTrack : public AnimationTrack {
+public:
+    explicit PauseTrack( int duration = 0 );
+
+    void setDuration( int duration );
+    bool advanceTrack( int time );
+
+private:
+    int m_duration; /**< Length of the pause in ms */
+};
+
+/**
+ * @brief The one timer that runs all animations of the GameScene
+ *
+ * Robot moves, board animations and laser shots are AnimationTracks. Each tick advances all
+ * running tracks at once, so their item updates end up in the same repaint of the scene.
+ * The time of the tracks is taken from a QElapsedTimer, a late tick does not slow them down.
+ *
+ * The time scale speeds up or slows down all tracks together, also the ones already running.
+ * The clock only ticks while a track runs.
+ */
+class AnimationClock : public QObject {
+    Q_OBJECT
+public:
+    explicit AnimationClock( QObject *parent = 0 );
+
+    /**
+     * @brief Starts @p track at time 0, a running track starts again
+     *
+     * The clock does not take ownership of the track.
+     */
+    void startTrack( AnimationTrack *track );
+
+    bool isRunning( AnimationTrack *track ) const;
+
+    /**
+     * @brief Sets the factor of the track time to the real time
+     *
+     * @param scale 1.0 is the normal speed, 2.0 runs all tracks twice as fast
+     */
+    void setTimeScale( qreal scale );
+    qreal timeScale() const;
+
+public slots:
+    /**
+     * @brief Jumps all running tracks to their end and emits trackFinished() for each of them
+     */
+    void finishAll();
+
+    /**
+     * @brief Removes all tracks without advancing them again
+     */
+    void stopAll();
+
+signals:
+    /**
+     * @brief Emitted for each track that reached its end
+     *
+     * Emitted after all tracks of the tick are advanced, so none of them is running anymore.
+     */
+    void trackFinished( BotRace::Client::AnimationTrack *track );
+
+private slots:
+    void tick();
+
+private:
+    /**
+     * @brief A track and its scaled time in ms
+     */
+    struct RunningTrack_T {
+        AnimationTrack *track;
+        qreal time;
+    };
+
+    QTimer *m_timer;                  /**< Calls tick() while tracks are running */
+    QElapsedTimer m_elapsed;          /**< Real time since the timer started */
+    qint64 m_lastTick;                /**< Real time of the last tick in ms */
+    qreal m_timeScale;                /**< Factor of the track time to the real time */
+    QList<RunningTrack_T> m_tracks;   /**< All running tracks */
+};
+
+}
+}
+
+#endif // ANIMATIONCLOCK_H
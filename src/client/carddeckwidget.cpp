@@ -311,7 +311,7 @@ void CardDeckWidget::paintEvent( QPaintEvent *event )
     QPainter painter( this );
     painter.setRenderHint( QPainter::Antialiasing );
 
-    painter.drawImage( rect(), m_renderer->getUiTheme()->getUiElement( "Card_Deck" ) );
+    m_renderer->getUiTheme()->drawUiElement( &painter, rect(), QString( "Card_Deck" ) );
 
     QWidget::paintEvent( event );
 }
@@ -48,6 +48,7 @@ HEADERS += \
     gameresultscreen.h \
     gamelogandchatwidget.h \
     gameboardanimation.h \
+    animationclock.h \
     introscene.h\
     joingamedialog.h \
     gamesimulationitem.h \
@@ -76,6 +77,7 @@ SOURCES += \
     gameresultscreen.cpp \
     gamelogandchatwidget.cpp \
     gameboardanimation.cpp \
+    animationclock.cpp \
     introscene.cpp \
     joingamedialog.cpp \
     gamesimulationitem.cpp \
@@ -18,6 +18,7 @@
 #include "flagitem.h"
 #include "renderer/gametheme.h"
 #include "renderer/tiletheme.h"
+#include "renderer/paintprofiler.h"
 
 #include "engine/boardmanager.h"
 
@@ -102,6 +103,8 @@ void FlagItem::paint( QPainter *painter, const QStyleOptionGraphicsItem *option,
     Q_UNUSED( option );
     Q_UNUSED( widget );
 
+    Renderer::ProfileTimer profileTimer( Renderer::PROFILE_FLAG );
+
     painter->drawPixmap( 0, 0, m_tileSize.width(), m_tileSize.height(), m_cachedPixmap );
 }
 
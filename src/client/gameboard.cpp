@@ -18,8 +18,10 @@
 #include "gameboard.h"
 
 #include "engine/boardmanager.h"
+#include "renderer/paintprofiler.h"
 
 #include <QGraphicsSceneResizeEvent>
+#include <QStyleOptionGraphicsItem>
 
 #include <QPainter>
 #include <QImage>
@@ -28,12 +30,32 @@
 using namespace BotRace;
 using namespace Client;
 
+static QImage grayImage( const QImage &image )
+{
+    QImage grayedImage = image;
+    QRgb col;
+    int gray;
+    for( int i = 0; i < grayedImage.width(); ++i ) {
+        for( int j = 0; j < grayedImage.height(); ++j ) {
+            col = grayedImage.pixel( i, j );
+            gray = qGray( col );
+            grayedImage.setPixel( i, j, qRgb( gray, gray, gray ) );
+        }
+    }
+
+    return grayedImage;
+}
+
 GameBoard::GameBoard( Renderer::BoardTheme *renderer, QGraphicsItem *parent ) :
     QGraphicsItem( parent ),
     m_currentPhase(0),
     m_renderer( renderer )
 {
+    // paint() only draws the chunks of the exposed rect
+    setFlag( QGraphicsItem::ItemUsesExtendedStyleOption );
+
     connect( m_renderer, SIGNAL( boardUpdateAvailable() ), this, SLOT( updateImage() ) );
+    connect( m_renderer, SIGNAL( boardChunkAvailable( QRect ) ), this, SLOT( updateChunk( QRect ) ) );
 }
 
 void GameBoard::setGameClientManager( Core::BoardManager *manager )
@@ -50,9 +72,24 @@ void GameBoard::setTileSize( const QSizeF &sizeOfOneTile )
 
 void GameBoard::setCurrentPhase(int phase)
 {
+    // only the tiles that differ from the base board in the old or new phase change
+    QRectF changedRect = phaseSpriteBounds( m_currentPhase );
     m_currentPhase = phase;
+    changedRect |= phaseSpriteBounds( m_currentPhase );
 
-    updateImage();
+    if( !changedRect.isEmpty() ) {
+        update( changedRect );
+    }
+}
+
+QRectF GameBoard::phaseSpriteBounds( int phase ) const
+{
+    QRectF bounds;
+    foreach( const Renderer::BoardSprite_T & sprite, m_renderer->getPhaseSprites( phase ) ) {
+        bounds |= tileRect( sprite.position );
+    }
+
+    return bounds;
 }
 
 QRectF GameBoard::boundingRect() const
@@ -63,38 +100,131 @@ QRectF GameBoard::boundingRect() const
 
 void GameBoard::paint( QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget )
 {
-    Q_UNUSED( option );
     Q_UNUSED( widget );
 
-    if( isEnabled() ) {
-        painter->drawPixmap( 0, 0,
-                             boundingRect().width(),
-                             boundingRect().height(),
-                             m_cachedBackground );
+    Renderer::ProfileTimer profileTimer( Renderer::PROFILE_GAMEBOARD );
+
+    int level = detailLevel( painter );
+
+    paintChunks( painter, option->exposedRect, level, !isEnabled() );
+
+    // the tiles that look different in the current phase are drawn on top of the base board
+    foreach( const Renderer::BoardSprite_T & sprite, m_renderer->getPhaseSprites( m_currentPhase ) ) {
+        QRectF drawRect = tileRect( sprite.position );
+        if( !option->exposedRect.intersects( drawRect ) ) {
+            continue;
+        }
+
+        if( isEnabled() ) {
+            paintSprite( painter, drawRect, sprite, 0, level );
+        }
+        else if( m_renderer->isFlat( level ) ) {
+            QColor color = m_renderer->getBoardSpriteColor( sprite, 0 );
+            int gray = qGray( color.rgb() );
+            painter->fillRect( drawRect, QColor( gray, gray, gray, color.alpha() ) );
+        }
+        else {
+            painter->drawImage( drawRect, grayImage( m_renderer->getBoardSprite( sprite, 0 ) ) );
+        }
+    }
+}
+
+int GameBoard::detailLevel( const QPainter *painter ) const
+{
+    QSize boardSize = m_renderer->boardSize();
+    if( boardSize.isEmpty() ) {
+        return 0;
+    }
+
+    // device pixel per board pixel, the view may be scaled and the item may be bigger or smaller than the rendered board
+    qreal viewScale = QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
+    return m_renderer->detailLevel( viewScale * boundingRect().width() / boardSize.width() );
+}
+
+void GameBoard::paintSprite( QPainter *painter, const QRectF &target, const Renderer::BoardSprite_T &sprite, int frame, int detailLevel )
+{
+    if( m_renderer->isFlat( detailLevel ) ) {
+        painter->fillRect( target, m_renderer->getBoardSpriteColor( sprite, frame ) );
     }
     else {
-        QImage disabledBoard = m_cachedBackground.toImage();
-        QRgb col;
-        int gray;
-        for( int i = 0; i < m_cachedBackground.width(); ++i ) {
-            for( int j = 0; j < m_cachedBackground.height(); ++j ) {
-                col = disabledBoard.pixel( i, j );
-                gray = qGray( col );
-                disabledBoard.setPixel( i, j, qRgb( gray, gray, gray ) );
-            }
+        m_renderer->drawBoardSprite( painter, target, sprite, frame );
+    }
+}
+
+void GameBoard::paintChunks( QPainter *painter, const QRectF &exposedRect, int detailLevel, bool grayed )
+{
+    QSize boardSize = m_renderer->boardSize();
+    if( boardSize.isEmpty() ) {
+        return;
+    }
+
+    // the rendered board may have a different tile size than the item while the tiles are rendered again
+    qreal scaleX = boundingRect().width() / boardSize.width();
+    qreal scaleY = boundingRect().height() / boardSize.height();
+
+    QRectF boardRect( exposedRect.x() / scaleX, exposedRect.y() / scaleY,
+                      exposedRect.width() / scaleX, exposedRect.height() / scaleY );
+    boardRect = boardRect.intersected( QRectF( QPointF( 0, 0 ), boardSize ) );
+    if( boardRect.isEmpty() ) {
+        return;
+    }
+
+    int firstColumn = ( int )boardRect.left() / Renderer::BOARD_CHUNK_SIZE;
+    int lastColumn = ( int )boardRect.right() / Renderer::BOARD_CHUNK_SIZE;
+    int firstRow = ( int )boardRect.top() / Renderer::BOARD_CHUNK_SIZE;
+    int lastRow = ( int )boardRect.bottom() / Renderer::BOARD_CHUNK_SIZE;
+
+    QList<QPoint> chunks;
+    for( int column = firstColumn; column <= lastColumn; column++ ) {
+        for( int row = firstRow; row <= lastRow; row++ ) {
+            chunks.append( QPoint( column, row ) );
+        }
+    }
+
+    // missing chunks are rendered in the background, updateChunk() paints them once they are ready
+    QList<QImage> chunkImages = m_renderer->getBoardChunks( chunks, detailLevel );
+
+    for( int i = 0; i < chunks.size(); i++ ) {
+        QRect rect = m_renderer->chunkRect( chunks.at( i ) );
+        QRectF target( rect.x() * scaleX, rect.y() * scaleY,
+                       rect.width() * scaleX, rect.height() * scaleY );
+
+        QImage chunkImage = chunkImages.at( i );
+        if( chunkImage.isNull() ) {
+            painter->fillRect( target, Qt::darkGray );
+            continue;
+        }
+
+        if( grayed ) {
+            chunkImage = grayImage( chunkImage );
         }
 
-        painter->drawPixmap( 0, 0,
-                             boundingRect().width(),
-                             boundingRect().height(),
-                             QPixmap::fromImage( disabledBoard ) );
+        painter->drawImage( target, chunkImage );
     }
 }
 
-void GameBoard::updateImage()
+QRectF GameBoard::tileRect( const QPoint &tile ) const
+{
+    return QRectF( tile.x() * m_sizeOfOneTile.width(), tile.y() * m_sizeOfOneTile.height(),
+                   m_sizeOfOneTile.width() + 1, m_sizeOfOneTile.height() + 1 );
+}
+
+void GameBoard::updateChunk( const QRect &rect )
 {
-    m_cachedBackground = QPixmap::fromImage( m_renderer->getBoard(m_currentPhase) );
+    QSize boardSize = m_renderer->boardSize();
+    if( boardSize.isEmpty() ) {
+        return;
+    }
 
+    qreal scaleX = boundingRect().width() / boardSize.width();
+    qreal scaleY = boundingRect().height() / boardSize.height();
+
+    update( rect.x() * scaleX, rect.y() * scaleY,
+            rect.width() * scaleX, rect.height() * scaleY );
+}
+
+void GameBoard::updateImage()
+{
     update( 0, 0,
             boundingRect().width(),
             boundingRect().height() );
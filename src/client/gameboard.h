@@ -22,7 +22,7 @@
 #include <QObject>
 
 #include <QSizeF>
-#include <QPixmap>
+#include <QImage>
 
 #include "renderer/boardtheme.h"
 
@@ -46,6 +46,37 @@ public:
     QRectF boundingRect() const;
     void paint( QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = 0 );
 
+protected:
+    /**
+     * @brief Returns the area of one board tile in item coordinates
+     *
+     * The area is 1 pixel bigger than the tile, the same way the board chunks are drawn.
+     *
+     * @param tile column and row of the board tile
+     */
+    QRectF tileRect( const QPoint &tile ) const;
+
+    /**
+     * @brief Picks the board detail level for the current transformation of @p painter
+     *
+     * Zoomed out views use chunks with a lower resolution and flat colored tiles.
+     *
+     * @param painter the painter of paint()
+     * @return the detail level for Renderer::BoardTheme::getBoardChunks()
+     */
+    int detailLevel( const QPainter *painter ) const;
+
+    /**
+     * @brief Paints a board sprite, as flat color if the tiles are too small in @p detailLevel
+     *
+     * @param painter the painter of paint()
+     * @param target the area of the sprite in item coordinates
+     * @param sprite the sprite to paint
+     * @param frame the current animation frame (0-4)
+     * @param detailLevel the detail level from detailLevel()
+     */
+    void paintSprite( QPainter *painter, const QRectF &target, const Renderer::BoardSprite_T &sprite, int frame, int detailLevel );
+
 public slots:
     void setTileSize( const QSizeF &sizeOfOneTile );
     void setCurrentPhase(int phase);
@@ -53,7 +84,29 @@ public slots:
 private slots:
     void updateImage();
 
+    /**
+     * @brief Repaints the part of the board covered by a chunk that was rendered in the background
+     *
+     * @param rect the chunk in board pixel
+     */
+    void updateChunk( const QRect &rect );
+
 private:
+    /**
+     * @brief Paints all board chunks that intersect @p exposedRect
+     *
+     * @param painter the painter of paint()
+     * @param exposedRect the exposed part of the item in item coordinates
+     * @param detailLevel the detail level from detailLevel()
+     * @param grayed draws the chunks in grayscale if @c true
+     */
+    void paintChunks( QPainter *painter, const QRectF &exposedRect, int detailLevel, bool grayed );
+
+    /**
+     * @brief The area covered by the tiles that differ from the base board in @p phase
+     */
+    QRectF phaseSpriteBounds( int phase ) const;
+
     QSizeF m_sizeOfTheBoard;
     QSizeF m_sizeOfOneTile;
 
@@ -61,7 +114,6 @@ private:
 
     Renderer::BoardTheme *m_renderer;
     Core::BoardManager *m_boardManager;
-    QPixmap m_cachedBackground;
 };
 
 }
@@ -19,12 +19,10 @@
 
 #include "renderer/gametheme.h"
 #include "renderer/boardrenderer.h"
+#include "renderer/paintprofiler.h"
 
-#include <QPropertyAnimation>
 #include <QPainter>
-
-#include <QTimer>
-#include <QSettings>
+#include <QStyleOptionGraphicsItem>
 
 #include <QDebug>
 
@@ -35,17 +33,11 @@ GameBoardAnimation::GameBoardAnimation( Renderer::BoardTheme *renderer, QGraphic
     : GameBoard( renderer, parent ),
       m_renderer( renderer ),
       m_animationType( Renderer::FLOOR_ANIM_GEARS ),
-      m_frame( 0 )
+      m_phase( 0 ),
+      m_frame( 0 ),
+      m_stepTime( 0 )
 {
     hide();
-
-    m_spriteAnim = new QPropertyAnimation( this, "frame" );
-    connect( m_spriteAnim, SIGNAL( finished() ), this, SLOT( animationOver() ) );
-}
-
-GameBoardAnimation::~GameBoardAnimation()
-{
-    delete m_spriteAnim;
 }
 
 void GameBoardAnimation::setAnimationType( BotRace::Renderer::AnimationType type )
@@ -55,35 +47,42 @@ void GameBoardAnimation::setAnimationType( BotRace::Renderer::AnimationType type
     connect( m_renderer, SIGNAL( animationUpdateAvailable(BotRace::Renderer::AnimationType) ), this, SLOT( updateImage(BotRace::Renderer::AnimationType) ) );
 }
 
-void GameBoardAnimation::startAnimation(int phase)
+void GameBoardAnimation::startAnimation( int phase, int stepTime )
 {
+    m_phase = qBound( 0, phase - 1, 4 );
+    m_sprites = m_renderer->getAnimationSprites( m_animationType, m_phase );
+    m_stepTime = stepTime;
+
     m_frame = 0;
     show();
-
-    uint startFrame = (phase-1) * 4;
-
-    QSettings settings;
-    m_spriteAnim->setDuration( settings.value( "Game/animation_step_time" ).toInt() );
-    m_spriteAnim->setStartValue( startFrame + 0 );
-    m_spriteAnim->setEndValue( startFrame + 4 );
-
-    m_spriteAnim->start();
 }
 
-void GameBoardAnimation::animationOver()
+bool GameBoardAnimation::advanceTrack( int time )
 {
-    hide();
+    // the sprites are hidden during the second step
+    if( time >= m_stepTime ) {
+        if( isVisible() ) {
+            m_frame = 4;
+            hide();
+        }
+
+        return time < 2 * m_stepTime;
+    }
 
-    QSettings settings;
-    QTimer::singleShot( settings.value( "Game/animation_step_time" ).toInt(),
-                        this, SIGNAL( finishAnimation( ) ) );
+    int newFrame = time * 4 / m_stepTime;
+    if( newFrame != m_frame ) {
+        setFrame( newFrame );
+    }
+
+    return true;
 }
 
 void GameBoardAnimation::setFrame( int newFrame )
 {
     m_frame = newFrame;
 
-    update( boundingRect() );
+    // only the animated tiles change
+    update( spriteBounds() );
 }
 
 int GameBoardAnimation::frame()
@@ -91,27 +90,36 @@ int GameBoardAnimation::frame()
     return m_frame;
 }
 
-bool GameBoardAnimation::finished()
+void GameBoardAnimation::paint( QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget )
 {
-    if( m_spriteAnim->state() == QAbstractAnimation::Stopped ) {
-        return true;
+    Q_UNUSED( widget );
+
+    Renderer::ProfileTimer profileTimer( Renderer::PROFILE_BOARD_ANIMATION );
+
+    if( !isEnabled() ) {
+        return;
     }
-    else {
-        return false;
+
+    int level = detailLevel( painter );
+
+    foreach( const Renderer::BoardSprite_T & sprite, m_sprites ) {
+        QRectF drawRect = tileRect( sprite.position );
+        if( !option->exposedRect.intersects( drawRect ) ) {
+            continue;
+        }
+
+        paintSprite( painter, drawRect, sprite, m_frame, level );
     }
 }
 
-void GameBoardAnimation::paint( QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget )
+QRectF GameBoardAnimation::spriteBounds() const
 {
-    Q_UNUSED( option );
-    Q_UNUSED( widget );
-
-    if( isEnabled() && !m_cachedAnimation.isEmpty() ) {
-        painter->drawImage( QRect( 0, 0,
-                                   boundingRect().width(),
-                                   boundingRect().height() ),
-                            m_cachedAnimation.at( m_frame ) );
+    QRectF bounds;
+    foreach( const Renderer::BoardSprite_T & sprite, m_sprites ) {
+        bounds |= tileRect( sprite.position );
     }
+
+    return bounds;
 }
 
 void GameBoardAnimation::updateImage(BotRace::Renderer::AnimationType type)
@@ -120,6 +128,6 @@ void GameBoardAnimation::updateImage(BotRace::Renderer::AnimationType type)
     if(type != m_animationType)
         return;
 
-    m_cachedAnimation.clear();
-    m_cachedAnimation = m_renderer->getAnimation(m_animationType);
+    m_sprites = m_renderer->getAnimationSprites( m_animationType, m_phase );
+    update( boundingRect() );
 }
@@ -22,10 +22,9 @@
 #include <QImage>
 
 #include "gameboard.h"
+#include "animationclock.h"
 #include "renderer/boardrenderer.h"
 
-class QPropertyAnimation;
-
 namespace BotRace {
 namespace Renderer {
     class GameTheme;
@@ -33,38 +32,59 @@ namespace Renderer {
 
 namespace Client {
 
-class GameBoardAnimation : public GameBoard {
+/**
+ * @brief Shows the sprite frames of one board animation type
+ *
+ * The animation is an AnimationTrack of the GameScene. The sprites run through all frames
+ * within the first step, during the second step the animation is hidden again and waits
+ * for the robots moved by the board elements.
+ */
+class GameBoardAnimation : public GameBoard, public AnimationTrack {
     Q_OBJECT
     Q_INTERFACES( QGraphicsItem );
     Q_PROPERTY( int frame READ frame WRITE setFrame );
 public:
     explicit GameBoardAnimation( Renderer::BoardTheme *renderer, QGraphicsItem *parent = 0 );
-    ~GameBoardAnimation();
 
     void setAnimationType( BotRace::Renderer::AnimationType type );
 
     void setFrame( int newFrame );
     int frame();
-    bool finished();
 
-    void paint( QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = 0 );
+    /**
+     * @brief Shows the sprite frame for @p time
+     *
+     * @param time ms since startAnimation()
+     * @return @c true until two steps are over
+     */
+    bool advanceTrack( int time );
 
-signals:
-    void finishAnimation();
+    void paint( QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = 0 );
 
 public slots:
-    void startAnimation(int phase);
-    void animationOver();
+    /**
+     * @brief Shows the first frame of the sprites for @p phase, the AnimationClock runs the rest
+     *
+     * @param phase the current phase (1-5)
+     * @param stepTime duration of one step in ms
+     */
+    void startAnimation( int phase, int stepTime );
     void updateImage(BotRace::Renderer::AnimationType type);
 
 private:
+    /**
+     * @brief The area covered by all sprites of the running animation
+     */
+    QRectF spriteBounds() const;
+
     Renderer::BoardTheme *m_renderer;
-    QList<QImage> m_cachedAnimation;
-    QPropertyAnimation *m_spriteAnim;
 
     BotRace::Renderer::AnimationType m_animationType;
+    Renderer::BoardSprites m_sprites; /**< sprites of the running animation */
 
+    int m_phase;
     int m_frame;
+    int m_stepTime; /**< Duration of one step in ms */
 
 };
 
@@ -22,31 +22,28 @@
 #include "gameview.h"
 #include "gameboard.h"
 #include "gameboardanimation.h"
+#include "animationclock.h"
 #include "robotitem.h"
 #include "laseritem.h"
 #include "flagitem.h"
 #include "startspot.h"
 #include "renderer/gametheme.h"
+#include "renderer/paintprofiler.h"
 #include "gameresultscreen.h"
 #include "gamesimulationitem.h"
 
 #include "localclient.h"
 #include "engine/boardmanager.h"
 #include "engine/participant.h"
+#include "engine/clientsettings.h"
 
 #include <QString>
-#include <QStringList>
-#include <QParallelAnimationGroup>
-#include <QSequentialAnimationGroup>
 #include <QPainter>
 #include <QGraphicsView>
 #include <QGraphicsItem>
 #include <QGraphicsLinearLayout>
 #include <QGraphicsSceneMouseEvent>
 
-#include <QPropertyAnimation>
-#include <QSettings>
-#include <QTimer>
 
 #include <QDebug>
 
@@ -62,12 +59,21 @@ GameScene::GameScene( Renderer::GameTheme *renderer )
       m_boardGearAnim( 0 ),
       m_boardBelt1Anim( 0 ),
       m_boardBelt2Anim( 0 ),
-      m_moveAnimation( 0 ),
-      m_LaserTimer( 0 ),
+      m_moveAnimationRunning( false ),
+      m_moveBarrier( 0 ),
+      m_laserBarrier( 0 ),
       m_renderer( renderer ),
       m_gameSimulation( 0 )
 {
-    m_moveAnimation = new QParallelAnimationGroup();
+    m_robotByType.fill( 0, Core::MAX_ROBOTS );
+
+    m_clock = new AnimationClock( this );
+    m_laserShot = new PauseTrack();
+    connect( m_clock, SIGNAL( trackFinished( BotRace::Client::AnimationTrack * ) ),
+             this, SLOT( trackFinished( BotRace::Client::AnimationTrack * ) ) );
+
+    connect( Core::ClientSettings::instance(), SIGNAL( changed() ), this, SLOT( updateSettings() ) );
+    updateSettings();
 
     setProperty( "boardRotated", false );
 
@@ -78,8 +84,10 @@ GameScene::GameScene( Renderer::GameTheme *renderer )
 
 GameScene::~GameScene()
 {
-    delete m_moveAnimation;
-    delete m_LaserTimer;
+    // the tracks are items of the scene, which are deleted below
+    m_clock->stopAll();
+
+    delete m_laserShot;
     delete m_phaseLayer;
 
     m_robotList.clear();
@@ -95,14 +103,14 @@ void GameScene::setUpNewGame( Core::AbstractClient *client )
     connect( m_gameClient->getBoardManager(), SIGNAL( boardChanged() ), this, SLOT( changeBoardScene() ) );
     connect( m_gameClient, SIGNAL( gameStarted() ), this, SLOT( startGame() ) );
 
-    connect( this, SIGNAL( moveAnimationFinished() ), m_gameClient, SLOT( animationFinished() ) );
 
-    connect( m_moveAnimation, SIGNAL( finished() ), this, SLOT( finishMoveAnimation() ) );
     connect( m_gameClient, SIGNAL( animateRobotMovement() ), this, SLOT( moveRobots() ) );
-    connect( m_gameClient, SIGNAL( animateRobotMovement( QStringList ) ), this, SLOT( moveRobots( QStringList ) ) );
+    connect( m_gameClient, SIGNAL( animateRobotMovement( BotRace::Core::RobotAnimation_T ) ), this, SLOT( moveRobots( BotRace::Core::RobotAnimation_T ) ) );
     connect( m_gameClient, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ),
              this, SLOT( animateGraphicElements(BotRace::Core::AnimateElements,int) ) );
 
+    connect( m_gameClient, SIGNAL( skipAnimations() ), this, SLOT( skipAnimations() ) );
+
     connect(m_gameClient, SIGNAL(phaseChanged(int)), this, SLOT(phaseChanged(int)) );
 
     connect( m_gameClient, SIGNAL( gameStarted() ), this, SLOT( updateSceneElements() ) );
@@ -123,42 +131,36 @@ void GameScene::setUpNewGame( Core::AbstractClient *client )
     m_phaseLayer->setZValue( 50 );
     addItem(m_phaseLayer);
 
-    QSettings settings;
-    if( settings.value( "Game/use_animation" ).toBool() ) {
+    if( Core::ClientSettings::values().useAnimation ) {
         m_boardGearAnim = new GameBoardAnimation( m_renderer->getBoardTheme(), m_board );
         m_boardGearAnim->setGameClientManager( m_gameClient->getBoardManager() );
         m_boardGearAnim->setAnimationType( Renderer::FLOOR_ANIM_GEARS );
         m_boardGearAnim->setTileSize( m_tileSize );
         connect( this, SIGNAL( newTileSize( QSizeF ) ), m_boardGearAnim, SLOT( setTileSize( QSizeF ) ) );
-        connect( m_boardGearAnim, SIGNAL( finishAnimation() ), this, SLOT( finishMoveAnimation() ) );
 
         m_boardBelt1Anim = new GameBoardAnimation( m_renderer->getBoardTheme(), m_board );
         m_boardBelt1Anim->setGameClientManager( m_gameClient->getBoardManager() );
         m_boardBelt1Anim->setAnimationType( Renderer::FLOOR_ANIM_BELT2 );
         m_boardBelt1Anim->setTileSize( m_tileSize );
         connect( this, SIGNAL( newTileSize( QSizeF ) ), m_boardBelt1Anim, SLOT( setTileSize( QSizeF ) ) );
-        connect( m_boardBelt1Anim, SIGNAL( finishAnimation() ), this, SLOT( finishMoveAnimation() ) );
 
         m_boardBelt2Anim = new GameBoardAnimation( m_renderer->getBoardTheme(), m_board );
         m_boardBelt2Anim->setGameClientManager( m_gameClient->getBoardManager() );
         m_boardBelt2Anim->setAnimationType( Renderer::FLOOR_ANIM_BELT1AND2 );
         m_boardBelt2Anim->setTileSize( m_tileSize );
         connect( this, SIGNAL( newTileSize( QSizeF ) ), m_boardBelt2Anim, SLOT( setTileSize( QSizeF ) ) );
-        connect( m_boardBelt2Anim, SIGNAL( finishAnimation() ), this, SLOT( finishMoveAnimation() ) );
 
         m_boardPusherAnim = new GameBoardAnimation( m_renderer->getBoardTheme(), m_board );
         m_boardPusherAnim->setGameClientManager( m_gameClient->getBoardManager() );
         m_boardPusherAnim->setAnimationType( Renderer::WALL_ANIM_PUSHER );
         m_boardPusherAnim->setTileSize( m_tileSize );
         connect( this, SIGNAL( newTileSize( QSizeF ) ), m_boardPusherAnim, SLOT( setTileSize( QSizeF ) ) );
-        connect( m_boardPusherAnim, SIGNAL( finishAnimation() ), this, SLOT( finishMoveAnimation() ) );
 
         m_boardCrusherAnim = new GameBoardAnimation( m_renderer->getBoardTheme(), m_board );
         m_boardCrusherAnim->setGameClientManager( m_gameClient->getBoardManager() );
         m_boardCrusherAnim->setAnimationType( Renderer::WALL_ANIM_CRUSHER );
         m_boardCrusherAnim->setTileSize( m_tileSize );
         connect( this, SIGNAL( newTileSize( QSizeF ) ), m_boardCrusherAnim, SLOT( setTileSize( QSizeF ) ) );
-        connect( m_boardCrusherAnim, SIGNAL( finishAnimation() ), this, SLOT( finishMoveAnimation() ) );
     }
 
     // add all lasers / flags
@@ -184,10 +186,9 @@ QPointF GameScene::getpositionForPlayer( Core::AbstractClient *client )
 {
     Core::Participant *p = client->getPlayer();
 
-    foreach(RobotItem *ri, m_robotList) {
-        if( ri->isEqualTo( p->getRobotType() ) ) {
-            return ri->scenePos();
-        }
+    RobotItem *robotItem = m_robotByType.value( p->getRobotType(), 0 );
+    if( robotItem ) {
+        return robotItem->scenePos();
     }
 
     return QPointF();
@@ -242,6 +243,9 @@ void GameScene::addOpponent( Core::Participant *participant )
     robot->show();
     robot->updateRobotPosition();
     m_robotList.append( robot );
+    if( participant->getRobotType() < m_robotByType.size() ) {
+        m_robotByType[participant->getRobotType()] = robot;
+    }
     connect( this, SIGNAL( newTileSize( QSizeF ) ), robot, SLOT( setTileSize( QSizeF ) ) );
 
     // draw the startspot of the participant
@@ -259,7 +263,10 @@ void GameScene::startGame()
         addOpponent( player );
     }
 
-    addOpponent( m_gameClient->getPlayer() );
+    // spectators have no robot on the board
+    if( !m_gameClient->isSpectator() ) {
+        addOpponent( m_gameClient->getPlayer() );
+    }
 }
 
 void GameScene::startSelectionFinished( QPoint point )
@@ -276,79 +283,59 @@ void GameScene::startSelectionFinished( QPoint point )
 
 void GameScene::moveRobots()
 {
-    m_moveAnimation->clear();
+    int stepTime = Core::ClientSettings::values().animationStepTime;
 
-    for( int i = 0; i < m_robotList.size(); i++ ) {
-        //create animator for each robot
-        QParallelAnimationGroup *robotMovement = m_robotList.at( i )->getMoveAnimation();
-
-        if( robotMovement && robotMovement->animationCount() >=  1 ) {
-            m_moveAnimation->addAnimation( robotMovement );
-        }
-        else {
-            delete robotMovement;
-        }
+    // each robot moves straight to the position of its participant
+    foreach( RobotItem * robotItem, m_robotList ) {
+        robotItem->beginTimeline( stepTime );
+        robotItem->addParticipantStep();
+        m_clock->startTrack( robotItem );
     }
 
-    m_moveAnimation->start();
+    m_moveAnimationRunning = true;
+    m_moveBarrier = m_gameClient->getAnimationBarrier();
 }
 
-void GameScene::moveRobots( QStringList sequence )
+void GameScene::moveRobots( const BotRace::Core::RobotAnimation_T &sequence )
 {
-    m_moveAnimation->clear();
-
-    QSequentialAnimationGroup *sequentiellAnimation = new QSequentialAnimationGroup();
-
-    foreach( const QString & entry, sequence ) {
-        QParallelAnimationGroup *parallelMovement = new QParallelAnimationGroup();
-
-        QStringList robotEntry = entry.split( '|' );
-
-        foreach( const QString & robot, robotEntry ) {
-            // split the sequence
-            Core::RobotType robotType;
-            Core::Orientation newRot;
-            QPoint newPos;
-            QRegExp rx( "(\\d+);(\\d);(\\d+),(\\d+)" );
-            if( rx.indexIn( robot ) != -1 ) {
-                robotType = ( Core::RobotType )rx.cap( 1 ).toInt();
-                newRot = ( Core::Orientation )rx.cap( 2 ).toInt();
-                newPos.setX( rx.cap( 3 ).toInt() );
-                newPos.setY( rx.cap( 4 ).toInt() );
-            }
-            else {
-                continue; // this robot won't be changed at all
-            }
+    int stepTime = Core::ClientSettings::values().animationStepTime;
 
-            RobotItem *robotItem = 0;
-            // find the robot item connected to the robot type
-            foreach( RobotItem * ri, m_robotList ) {
-                if( ri->isEqualTo( robotType ) ) {
-                    robotItem = ri;
-                }
-            }
+    foreach( RobotItem * robotItem, m_robotList ) {
+        robotItem->beginTimeline( stepTime );
+    }
+
+    int moveIndex = 0;
+    int step = 0;
+    foreach( quint8 stepSize, sequence.stepSize ) {
+        bool robotMoved = false;
+
+        for( int i = moveIndex; i < moveIndex + stepSize && i < sequence.moves.size(); i++ ) {
+            const Core::RobotMove_T &move = sequence.moves.at( i );
 
+            RobotItem *robotItem = m_robotByType.value( move.robot, 0 );
             if( !robotItem ) {
                 qWarning() << "animation sequence error ... could not find robotitem";
                 continue;
             }
 
-            // create animation
-            QParallelAnimationGroup *robotMovement = robotItem->getMoveAnimation( newRot, newPos );
-
-            if( robotMovement && robotMovement->animationCount() >=  1 ) {
-                parallelMovement->addAnimation( robotMovement );
-            }
-            else {
-                delete robotMovement;
+            if( robotItem->addTimelineStep( step, ( Core::Orientation )move.orientation, QPoint( move.x, move.y ) ) ) {
+                robotMoved = true;
             }
         }
+        moveIndex += stepSize;
 
-        sequentiellAnimation->addAnimation( parallelMovement );
+        // steps without any movement take no time
+        if( robotMoved ) {
+            step++;
+        }
     }
 
-    m_moveAnimation->addAnimation( sequentiellAnimation );
-    m_moveAnimation->start();
+    foreach( RobotItem * robotItem, m_robotList ) {
+        m_clock->startTrack( robotItem );
+    }
+
+    m_moveAnimationRunning = true;
+    m_moveBarrier = m_gameClient->getAnimationBarrier();
 }
 
 void GameScene::animateGraphicElements(BotRace::Core::AnimateElements animation, int phase)
@@ -358,8 +345,8 @@ void GameScene::animateGraphicElements(BotRace::Core::AnimateElements animation,
         return;
     }
 
-    QSettings settings;
-    if( !settings.value( "Game/use_animation" ).toBool()) {
+    // the board animations only exist if animations were enabled when the game was set up
+    if( !m_boardGearAnim ) {
         moveRobots();
         finishMoveAnimation();
         return;
@@ -370,29 +357,38 @@ void GameScene::animateGraphicElements(BotRace::Core::AnimateElements animation,
         break;
     }
     case BotRace::Core::ANIM_GEARS: {
-        m_boardGearAnim->startAnimation(phase);
+        startBoardAnimation( m_boardGearAnim, phase );
         break;
     }
     case BotRace::Core::ANIM_BELT2: {
-        m_boardBelt1Anim->startAnimation(phase);
+        startBoardAnimation( m_boardBelt1Anim, phase );
         break;
     }
     case BotRace::Core::ANIM_BELT1AND2: {
-        m_boardBelt2Anim->startAnimation(phase);
+        startBoardAnimation( m_boardBelt2Anim, phase );
         break;
     }
     case BotRace::Core::ANIM_PUSHER: {
-        m_boardPusherAnim->startAnimation(phase);
+        startBoardAnimation( m_boardPusherAnim, phase );
         break;
     }
     case BotRace::Core::ANIM_CRUSHER: {
-        m_boardCrusherAnim->startAnimation(phase);
+        startBoardAnimation( m_boardCrusherAnim, phase );
         break;
     }
 
     }
 }
 
+void GameScene::startBoardAnimation( GameBoardAnimation *animation, int phase )
+{
+    animation->startAnimation( phase, Core::ClientSettings::values().animationStepTime );
+    m_clock->startTrack( animation );
+
+    m_moveAnimationRunning = true;
+    m_moveBarrier = m_gameClient->getAnimationBarrier();
+}
+
 void GameScene::updatePhaseLayer()
 {
     if( m_phaseLayer )
@@ -412,15 +408,14 @@ void GameScene::shootLasers(int phase)
         }
     }
 
-    if( robotsGotHit ) {
-        m_LaserTimer = new QTimer( this );
-        connect( m_LaserTimer, SIGNAL( timeout() ), this, SLOT( shootLasersFinished() ) );
+    m_laserBarrier = m_gameClient->getAnimationBarrier();
 
-        QSettings settings;
-        m_LaserTimer->start( settings.value( "Game/animation_step_time" ).toInt() );
+    if( robotsGotHit ) {
+        m_laserShot->setDuration( Core::ClientSettings::values().animationStepTime );
+        m_clock->startTrack( m_laserShot );
     }
     else {
-        m_gameClient->animationFinished();
+        m_gameClient->animationFinished( m_laserBarrier );
     }
 }
 
@@ -434,9 +429,14 @@ void GameScene::shootLasersFinished()
         }
     }
 
-    delete m_LaserTimer;
-    m_LaserTimer = 0;
-    m_gameClient->animationFinished();
+    m_gameClient->animationFinished( m_laserBarrier );
+}
+
+void GameScene::skipAnimations()
+{
+    // jump to the end of all running animations
+    // the usual finish handling informs the client afterwards
+    m_clock->finishAll();
 }
 
 void GameScene::updateSceneElements()
@@ -524,23 +524,48 @@ void GameScene::phaseChanged(int phase)
 
 void GameScene::finishMoveAnimation()
 {
-    QSettings settings;
-    if( settings.value( "Game/use_animation" ).toBool() ) {
-        if( m_moveAnimation->state() == QAbstractAnimation::Stopped
-            && m_boardGearAnim->finished()
-            && m_boardBelt1Anim->finished()
-            && m_boardBelt2Anim->finished()
-            && m_boardPusherAnim->finished()
-            && m_boardCrusherAnim->finished() ) {
-            emit moveAnimationFinished();
+    // several tracks end in the same tick, the client is informed only once
+    if( !m_moveAnimationRunning ) {
+        return;
+    }
+
+    foreach( RobotItem * robotItem, m_robotList ) {
+        if( m_clock->isRunning( robotItem ) ) {
+            return;
+        }
+    }
+
+    // the board animations only exist if animations are enabled
+    if( m_boardGearAnim ) {
+        if( m_clock->isRunning( m_boardGearAnim )
+            || m_clock->isRunning( m_boardBelt1Anim )
+            || m_clock->isRunning( m_boardBelt2Anim )
+            || m_clock->isRunning( m_boardPusherAnim )
+            || m_clock->isRunning( m_boardCrusherAnim ) ) {
+            return;
         }
     }
+
+    m_moveAnimationRunning = false;
+    m_gameClient->animationFinished( m_moveBarrier );
+    emit moveAnimationFinished();
+}
+
+void GameScene::trackFinished( BotRace::Client::AnimationTrack *track )
+{
+    if( track == m_laserShot ) {
+        shootLasersFinished();
+    }
     else {
-        if( m_moveAnimation->state() == QAbstractAnimation::Stopped)
-            emit moveAnimationFinished();
+        finishMoveAnimation();
     }
 }
 
+void GameScene::updateSettings()
+{
+    m_clock->setTimeScale( Core::ClientSettings::values().fastPlayback ? FAST_PLAYBACK_TIME_SCALE : 1.0 );
+}
+
 void GameScene::resizeScene( const QRectF &newRect )
 {
     Q_UNUSED( newRect );
@@ -608,4 +633,14 @@ void GameScene::drawBackground( QPainter *painter, const QRectF &rect )
 {
     Q_UNUSED(painter)
     Q_UNUSED(rect)
+
+    Renderer::PaintProfiler::beginFrame();
+}
+
+void GameScene::drawForeground( QPainter *painter, const QRectF &rect )
+{
+    Q_UNUSED(painter)
+    Q_UNUSED(rect)
+
+    Renderer::PaintProfiler::endFrame();
 }
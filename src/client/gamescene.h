@@ -20,13 +20,9 @@
 
 #include <QGraphicsScene>
 #include <QVector>
-#include <QAbstractAnimation>
 
 #include "engine/gameengine.h"
 
-class QParallelAnimationGroup;
-class QTimer;
-
 namespace BotRace {
 namespace Core {
     class AbstractClient;
@@ -42,6 +38,9 @@ namespace Client {
     class LaserItem;
     class GameSimulationItem;
     class FlagItem;
+    class AnimationClock;
+    class AnimationTrack;
+    class PauseTrack;
 
 /**
  * @brief Represents the visual part of the gameboard
@@ -99,11 +98,12 @@ signals:
 
 private slots:
     void moveRobots(); // called from gameengine signal
-    void moveRobots( QStringList sequence ); // called from gameengine signal
+    void moveRobots( const BotRace::Core::RobotAnimation_T &sequence ); // called from gameengine signal
     void animateGraphicElements(BotRace::Core::AnimateElements animation, int phase); // called from gameengine signal
     void updatePhaseLayer();
     void shootLasers(int phase); // called from animateGraphicElements
-    void shootLasersFinished(); // called from timer in shootLasers
+    void shootLasersFinished(); // called when the laser shot track of shootLasers is over
+    void skipAnimations(); // called when the gameengine stopped waiting for us
     void startSelectionFinished( QPoint point ); // called from the gameboard when the user clicked on something
 
     void addOpponent( Core::Participant *participant );
@@ -116,10 +116,31 @@ private slots:
     void phaseChanged(int phase);
     void finishMoveAnimation();
 
+    /**
+     * @brief Called by the AnimationClock for each finished track
+     */
+    void trackFinished( BotRace::Client::AnimationTrack *track );
+
+    /**
+     * @brief Applies the fast playback of the Core::ClientSettings to the AnimationClock
+     */
+    void updateSettings();
+
 private:
     void calculateTileSize();
+
+    /**
+     * @brief Starts a board animation as track of the AnimationClock
+     */
+    void startBoardAnimation( GameBoardAnimation *animation, int phase );
+
     void drawBackground( QPainter *painter, const QRectF &rect );
 
+    /**
+     * @brief Ends the frame of the Renderer::PaintProfiler, all items are painted at this point
+     */
+    void drawForeground( QPainter *painter, const QRectF &rect );
+
     bool m_showStartPositionsSelection;
 
     Core::AbstractClient *m_gameClient;
@@ -131,9 +152,13 @@ private:
     GameBoardAnimation *m_boardPusherAnim;
     GameBoardAnimation *m_boardCrusherAnim;
     QVector<RobotItem *> m_robotList;
-    QParallelAnimationGroup *m_moveAnimation;
+    QVector<RobotItem *> m_robotByType; /**< The robot items indexed by Core::RobotType for the animation sequence */
+    AnimationClock *m_clock;            /**< Runs the robot moves, board animations and laser shots */
+    PauseTrack *m_laserShot;            /**< Keeps the laser shots and explosions on the board for one step */
+    bool m_moveAnimationRunning;        /**< Robot moves or board animations started and not yet reported as finished */
+    quint32 m_moveBarrier;              /**< Animation barrier of the running robot moves and board animations */
+    quint32 m_laserBarrier;             /**< Animation barrier of the running laser shots */
     QVector<LaserItem *> m_laserList;
-    QTimer *m_LaserTimer;
     Renderer::GameTheme *m_renderer;
     QSizeF m_tileSize;
     GameSimulationItem *m_gameSimulation;
@@ -18,9 +18,15 @@
 #include "gameview.h"
 
 #include "renderer/gametheme.h"
+#include "renderer/paintprofiler.h"
 
 #include <QResizeEvent>
 #include <QWheelEvent>
+#include <QLabel>
+#include <QTimer>
+#include <QDir>
+#include <QDateTime>
+#include <QCoreApplication>
 
 #include <QDebug>
 
@@ -36,6 +42,17 @@ GameView::GameView( Renderer::GameTheme *renderer, QWidget *parent )
 
     //optimize rendering
     setOptimizationFlags( QGraphicsView::DontSavePainterState | QGraphicsView::DontAdjustForAntialiasing );
+
+    // the overlay is a widget on top of the viewport, so it does not show up in the painting it measures
+    m_profilerLabel = new QLabel( viewport() );
+    m_profilerLabel->setStyleSheet( "QLabel { background-color: rgba(0, 0, 0, 160); color: white; padding: 4px; font-family: monospace; }" );
+    m_profilerLabel->setAttribute( Qt::WA_TransparentForMouseEvents );
+    m_profilerLabel->move( 4, 4 );
+    m_profilerLabel->hide();
+
+    m_profilerTimer = new QTimer( this );
+    m_profilerTimer->setInterval( 500 );
+    connect( m_profilerTimer, SIGNAL( timeout() ), this, SLOT( updateProfiler() ) );
 }
 
 void GameView::setScene( QGraphicsScene *scene )
@@ -78,6 +95,42 @@ void GameView::resetZoom()
     resizeEvent( 0 );
 }
 
+void GameView::showProfiler( bool show )
+{
+    if( show == Renderer::PaintProfiler::isEnabled() ) {
+        return;
+    }
+
+    if( show ) {
+        Renderer::PaintProfiler::setEnabled( true );
+        updateProfiler();
+        m_profilerLabel->show();
+        m_profilerTimer->start();
+        return;
+    }
+
+    m_profilerTimer->stop();
+    m_profilerLabel->hide();
+
+    QString fileName = QString( "%1/.%2/profile/paint-%3.csv" )
+                       .arg( QDir::homePath() )
+                       .arg( QCoreApplication::applicationName() )
+                       .arg( QDateTime::currentDateTime().toString( "yyyyMMdd-hhmmss" ) );
+
+    qDebug() << "GameView::showProfiler ::" << Renderer::PaintProfiler::overlayText();
+    if( Renderer::PaintProfiler::exportCsv( fileName ) ) {
+        qDebug() << "GameView::showProfiler :: frames written to" << fileName;
+    }
+
+    Renderer::PaintProfiler::setEnabled( false );
+}
+
+void GameView::updateProfiler()
+{
+    m_profilerLabel->setText( Renderer::PaintProfiler::overlayText() );
+    m_profilerLabel->adjustSize();
+}
+
 void GameView::resizeEvent( QResizeEvent *event )
 {
     Q_UNUSED( event )
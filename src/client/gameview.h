@@ -20,6 +20,9 @@
 
 #include <QGraphicsView>
 
+class QLabel;
+class QTimer;
+
 namespace BotRace {
 namespace Renderer {
     class GameTheme;
@@ -74,6 +77,16 @@ public slots:
      */
     void resetZoom();
 
+    /**
+     * @brief Shows or hides the overlay of the Renderer::PaintProfiler
+     *
+     * The profiler only runs while the overlay is shown. When it is hidden the
+     * recorded frames are logged and written to a CSV file in the profile folder.
+     *
+     * @param show @c true to start the profiler
+     */
+    void showProfiler( bool show );
+
 protected:
     /**
      * @brief Keeps the scene size in sync with the view size
@@ -93,12 +106,20 @@ protected:
     void mouseReleaseEvent(QMouseEvent* event);
     void mouseMoveEvent(QMouseEvent* event);
 
+private slots:
+    /**
+     * @brief Shows the current values of the profiler in the overlay
+     */
+    void updateProfiler();
+
 private:
     QPointF getCenter() { return m_currentCenterPoint; }
 
     QPoint m_lastPanPoint;
     QPointF m_currentCenterPoint;
     Renderer::GameTheme *m_renderer;  /**< Renderer find out the current tile render scale */
+    QLabel *m_profilerLabel;          /**< Overlay with the values of the paint profiler */
+    QTimer *m_profilerTimer;          /**< Updates the overlay while the profiler runs */
 };
 
 }
@@ -46,6 +46,7 @@ JoinDetails_T JoinGameDialog::getDetails()
     details.robot = ui->robotComboBox->currentIndex();
     details.ip = ui->ipLineEdit->text();
     details.port = ui->portSpinBox->value();
+    details.spectator = ui->spectatorCheckBox->isChecked();
 
     return details;
 }
@@ -33,6 +33,8 @@ struct JoinDetails_T {
 
     QString ip;
     int port;
+
+    bool spectator;
 };
 
 class JoinGameDialog : public QDialog
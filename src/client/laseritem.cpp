@@ -18,6 +18,7 @@
 #include "laseritem.h"
 #include "renderer/gametheme.h"
 #include "renderer/tiletheme.h"
+#include "renderer/paintprofiler.h"
 
 #include <QPainter>
 
@@ -55,6 +56,8 @@ void LaserItem::paint( QPainter *painter, const QStyleOptionGraphicsItem *option
     Q_UNUSED( option );
     Q_UNUSED( widget );
 
+    Renderer::ProfileTimer profileTimer( Renderer::PROFILE_LASER );
+
     if( isEnabled() ) {
         painter->drawPixmap( 0, 0, m_maxActualSize.width(),
                              m_maxActualSize.height(),
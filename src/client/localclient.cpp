@@ -122,9 +122,9 @@ void LocalClient::powerDownRobot()
     emit robotPoweredDown( powerDownPossible );
 }
 
-void LocalClient::animationFinished()
+void LocalClient::animationFinished( quint32 barrier )
 {
-    m_gameEngine->clientAnimationFinished( this );
+    m_gameEngine->clientAnimationFinished( this, barrier );
 }
 
 void LocalClient::setGameEngine( Core::GameEngine *ge )
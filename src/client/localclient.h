@@ -47,7 +47,7 @@ public slots:
     void programmingFinished();
     void powerDownRobot();
 
-    void animationFinished();
+    void animationFinished( quint32 barrier );
 
     void selectStartingPoint( QList<QPoint> allowedStartingPoints );
     void selectStartingOrientation( QList<BotRace::Core::Orientation> allowedOrientations );
@@ -35,6 +35,7 @@
 
 #include "localclient.h"
 #include "engine/gameengine.h"
+#include "engine/clientsettings.h"
 #include "networkclient.h"
 
 #include "joingamedialog.h"
@@ -198,6 +199,7 @@ void MainWindow::joinGame()
         m_networkClient = new NetworkClient( );
 
         m_networkClient->setName( details.name );
+        m_networkClient->setSpectator( details.spectator );
         m_networkClient->connectToServer( details.ip, details.port );
 
         m_sld = new Network::ServerLobbyDialog();
@@ -367,6 +369,16 @@ void MainWindow::changeAnimationSpeed()
     }
 
     settings.sync();
+    Core::ClientSettings::instance()->reload();
+}
+
+void MainWindow::changePlaybackSpeed( bool fast )
+{
+    QSettings settings;
+    settings.setValue( "Game/fast_playback", fast );
+
+    settings.sync();
+    Core::ClientSettings::instance()->reload();
 }
 
 void MainWindow::showSettings()
@@ -462,6 +474,9 @@ void MainWindow::initUI()
     ui->actionFast->setChecked(false);
     ui->actionSlow->setChecked(false);
 
+    ui->actionFast_Playback->setChecked( Core::ClientSettings::values().fastPlayback );
+    connect( ui->actionFast_Playback, SIGNAL( toggled( bool ) ), this, SLOT( changePlaybackSpeed( bool ) ) );
+
     connect( ui->actionGame_Settings, SIGNAL( triggered() ), this, SLOT( showSettings() ) );
 
     //Help Menu
@@ -497,6 +512,7 @@ void MainWindow::initUI()
     connect(ui->actionZoomIn, SIGNAL(triggered()), m_gameView, SLOT(zoomIn()) );
     connect(ui->actionZoomOut, SIGNAL(triggered()), m_gameView, SLOT(zoomOut()) );
     connect(ui->actionZoom_fit_to_view, SIGNAL(triggered()), m_gameView, SLOT(resetZoom()) );
+    connect(ui->actionPaint_Profiler, SIGNAL(toggled(bool)), m_gameView, SLOT(showProfiler(bool)) );
 
     connect(ui->actionShow_Simulator, SIGNAL(triggered()), this, SLOT(showSimulator()) );
 
@@ -661,6 +677,7 @@ void MainWindow::createDefaultSettings()
     settings.setValue( "player/name", QString( "unknown player" ) );
 
     settings.sync();
+    Core::ClientSettings::instance()->reload();
 }
 
 QString MainWindow::findDefaultDataDirectory()
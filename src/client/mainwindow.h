@@ -69,6 +69,7 @@ public slots:
     void changeGUISize();
     void fixGuiElements();
     void changeAnimationSpeed();
+    void changePlaybackSpeed( bool fast );
     void showSettings();
     void aboutBotRace();
     void showManual();
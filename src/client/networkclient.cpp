@@ -21,6 +21,8 @@
 #include "engine/carddeck.h"
 #include "engine/boardmanager.h"
 #include "engine/gamelogandchat.h"
+#include "engine/scenariocache.h"
+#include "engine/coreconst.h"
 
 #include "selectorientationdialog.h"
 #include "gamescene.h"
@@ -30,6 +32,7 @@
 #include <QNetworkSession>
 #include <QSettings>
 #include <QDataStream>
+#include <QTimer>
 
 #include <QDebug>
 
@@ -39,14 +42,27 @@ using namespace Client;
 NetworkClient::NetworkClient( ) :
     AbstractClient(),
     m_connection( 0 ),
+    m_port( 0 ),
+    m_spectator( false ),
+    m_gameRunning( false ),
+    m_reconnectAttempts( 0 ),
+    m_reconnectPending( false ),
     m_scene( 0 )
 {
+    m_scenarioTimer = new QTimer( this );
+    m_scenarioTimer->setSingleShot( true );
+    m_scenarioTimer->setInterval( Network::SCENARIO_REQUEST_TIMEOUT );
+    connect( m_scenarioTimer, SIGNAL( timeout() ), this, SLOT( scenarioRequestTimedOut() ) );
+
     setPlayer( new Core::Participant() );
     Core::CardDeck *cd = new Core::CardDeck();
     getPlayer()->setDeck( cd );
     setBoardManager( new Core::BoardManager() );
 
     m_logAndChat = new Core::GameLogAndChat();
+    m_lastLogSequence = 0;
+    m_logSyncRunning = false;
+    m_resumeRequested = false;
 }
 
 void NetworkClient::setName( const QString &name )
@@ -59,6 +75,16 @@ bool NetworkClient::isBot()
     return false;
 }
 
+void NetworkClient::setSpectator( bool spectator )
+{
+    m_spectator = spectator;
+}
+
+bool NetworkClient::isSpectator() const
+{
+    return m_spectator;
+}
+
 void NetworkClient::joinGame()
 {
 
@@ -88,9 +114,14 @@ void NetworkClient::powerDownRobot()
     m_connection->sendSignal( Network::DATA_POWER_DOWN_REQUEST );
 }
 
-void NetworkClient::animationFinished()
+void NetworkClient::animationFinished( quint32 barrier )
 {
-    m_connection->sendSignal( Network::SIGNAL_ANIMATION_FINISHED );
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << barrier;
+
+    m_connection->sendData( Network::DATA_ANIMATION_FINISHED, data );
 }
 
 void NetworkClient::startProgramming()
@@ -173,16 +204,9 @@ void NetworkClient::connectToServer( const QString &ip, int port )
         ipAddress = QHostAddress( QHostAddress::LocalHost ).toString();
     }
 
-    QTcpSocket *tcpSocket = new QTcpSocket( this );
-    tcpSocket->abort();
-    tcpSocket->connectToHost( ip, port );
-
-    m_connection = new Network::Connection( tcpSocket );
-    connect( m_connection, SIGNAL( dataReceived( BotRace::Network::DataType_T, QByteArray ) ),
-             this, SLOT( onDataReceived( BotRace::Network::DataType_T, QByteArray ) ) );
-
-    connect( tcpSocket, SIGNAL( error( QAbstractSocket::SocketError ) ),
-             this, SLOT( displayError( QAbstractSocket::SocketError ) ) );
+    m_host = ip;
+    m_port = port;
+    openConnection();
 
     QNetworkConfigurationManager manager;
     if( manager.capabilities() & QNetworkConfigurationManager::NetworkSessionRequired ) {
@@ -206,6 +230,65 @@ void NetworkClient::connectToServer( const QString &ip, int port )
     }
 }
 
+void NetworkClient::openConnection()
+{
+    QTcpSocket *tcpSocket = new QTcpSocket( this );
+    tcpSocket->abort();
+    tcpSocket->connectToHost( m_host, m_port );
+
+    m_connection = new Network::Connection( tcpSocket );
+    connect( m_connection, SIGNAL( dataReceived( BotRace::Network::DataType_T, QByteArray ) ),
+             this, SLOT( onDataReceived( BotRace::Network::DataType_T, QByteArray ) ) );
+    connect( m_connection, SIGNAL( disconnected() ), this, SLOT( connectionLost() ) );
+
+    connect( tcpSocket, SIGNAL( error( QAbstractSocket::SocketError ) ),
+             this, SLOT( displayError( QAbstractSocket::SocketError ) ) );
+}
+
+void NetworkClient::connectionLost()
+{
+    // an old connection from a previous attempt
+    if( sender() != m_connection ) {
+        return;
+    }
+
+    scheduleReconnect();
+}
+
+void NetworkClient::scheduleReconnect()
+{
+    if( !m_gameRunning || m_sessionToken.isNull() || m_reconnectPending ) {
+        return;
+    }
+
+    if( m_reconnectAttempts >= Network::RECONNECT_ATTEMPTS ) {
+        qWarning() << "NetworkClient::scheduleReconnect || giving up after" << m_reconnectAttempts << "attempts";
+        m_gameRunning = false;
+        m_reconnectAttempts = 0;
+        return;
+    }
+
+    m_reconnectPending = true;
+    QTimer::singleShot( Network::RECONNECT_INTERVAL, this, SLOT( reconnectToServer() ) );
+}
+
+void NetworkClient::reconnectToServer()
+{
+    m_reconnectPending = false;
+    m_reconnectAttempts++;
+
+    qDebug() << "NetworkClient::reconnectToServer || attempt" << m_reconnectAttempts << "to" << m_host << m_port;
+
+    // everything still expected from the old connection is lost, the snapshot replaces it
+    m_scenarioTimer->stop();
+    m_requestedScenario.clear();
+    m_scenarioData.clear();
+    m_deferredMessages.clear();
+
+    m_connection->deleteLater();
+    openConnection();
+}
+
 void NetworkClient::setGameScene( GameScene *scene )
 {
     m_scene = scene;
@@ -222,12 +305,44 @@ Core::GameLogAndChat *NetworkClient::getGameLogAndChat()
 
 void NetworkClient::onDataReceived( BotRace::Network::DataType_T dataType, QByteArray data )
 {
+    // all following messages expect the new scenario, so keep them until it is received
+    if( !m_requestedScenario.isEmpty() && dataType != Network::DATA_SCENARIO_DATA ) {
+        m_deferredMessages.append( qMakePair( dataType, data ) );
+
+        // the requested scenario is outdated, stop waiting for it and handle the newer one in order
+        if( dataType == Network::DATA_SCENARIO_CHANGED ) {
+            QByteArray hash;
+            QDataStream instream( &data, QIODevice::ReadOnly );
+            instream >> hash;
+
+            if( hash != m_requestedScenario ) {
+                qDebug() << "NetworkClient::onDataReceived || scenario changed during the download";
+                abortScenarioRequest();
+            }
+        }
+        return;
+    }
+
     switch( dataType ) {
     case Network::HANDSHAKE: {
         qDebug() << "NetworkClient::onDataReceived || Network::HANDSHAKE";
         QUuid uuid;
+        QUuid sessionToken;
+        quint32 protocolVersion = 0;
         QDataStream instream( &data, QIODevice::ReadOnly );
         instream >> uuid;
+        if( !instream.atEnd() ) {
+            instream >> sessionToken;
+        }
+        if( !instream.atEnd() ) {
+            instream >> protocolVersion;
+        }
+
+        // the messages of another version can't be parsed
+        if( protocolVersion != Network::PROTOCOL_VERSION ) {
+            refuseProtocol( protocolVersion );
+            break;
+        }
 
         m_connection->setUid( uuid );
         getPlayer()->setUid( uuid );
@@ -235,10 +350,24 @@ void NetworkClient::onDataReceived( BotRace::Network::DataType_T dataType, QByte
 
         QByteArray data;
         QDataStream datastream( &data, QIODevice::WriteOnly );
+        // the server answers with a snapshot if it still waits for us,
+        // otherwise we join the lobby as new client
         datastream << getName();
+        datastream << ( m_reconnectAttempts > 0 ? m_sessionToken : QUuid() );
+        m_resumeRequested = m_reconnectAttempts > 0 && !m_sessionToken.isNull();
+        datastream << m_spectator;
+        datastream << Network::PROTOCOL_VERSION;
 
         m_connection->sendData( Network::HANDSHAKE, data );
 
+        m_sessionToken = sessionToken;
+        m_gameRunning = false;
+        m_reconnectAttempts = 0;
+
+        // fetch the log entries written before we joined
+        m_logSyncRunning = true;
+        requestLogAndChatHistory();
+
         break;
     }
     case Network::CLIENT_ADDED: {
@@ -293,67 +422,7 @@ void NetworkClient::onDataReceived( BotRace::Network::DataType_T dataType, QByte
 
         qDebug() << "NetworkClient::onDataReceived || Network::PARTICIPANT_CHANGES ::" << player->getUuid() << player->getName();
 
-        // the the uuid is the same as the players one, update his states
-        if( player->getUuid() == getUuid() ) {
-            getPlayer()->setName( player->getName() );
-            getPlayer()->setUid( player->getUuid() );
-            getPlayer()->setLife( player->getLife() );
-            getPlayer()->setRobotType( player->getRobotType() );
-            getPlayer()->setDamageToken( player->getDamageToken() );
-            getPlayer()->setPosition( player->getPosition() );
-            getPlayer()->setPowerDown( player->getPowerDown() );
-            getPlayer()->setIsVirtual( player->getIsVirtual() );
-
-            getPlayer()->setKingOfPoints( player->getKingOfPoints() );
-            getPlayer()->pickedUpFlagChanged( player->hasFlag() );
-
-            getPlayer()->setOrientation( player->getOrientation() );
-            getPlayer()->setNextFlagFoal( player->getNextFlagGoal() );
-            getPlayer()->setArchiveMarker( player->getArchiveMarker() );
-            getPlayer()->setDeaths( player->getDeath());
-            getPlayer()->setKills( player->getKills());
-            getPlayer()->setSuicides( player->getSuicides());
-
-            delete player;
-        }
-        //otherwise check the opponents
-        else {
-            bool opponentFound = false;
-            foreach( Core::Participant * p, getOpponents() ) {
-                if( p->getUuid() == player->getUuid() ) {
-                    p->setName( player->getName() );
-                    p->setLife( player->getLife() );
-                    p->setUid( player->getUuid() );
-                    p->setRobotType( player->getRobotType() );
-                    p->setDamageToken( player->getDamageToken() );
-                    p->setPosition( player->getPosition() );
-
-                    p->setKingOfPoints( player->getKingOfPoints() );
-                    p->pickedUpFlagChanged( player->hasFlag() );
-                    p->setPowerDown( player->getPowerDown() );
-                    p->setIsVirtual( player->getIsVirtual() );
-
-                    p->setOrientation( player->getOrientation() );
-                    p->setNextFlagFoal( player->getNextFlagGoal() );
-                    p->setArchiveMarker( player->getArchiveMarker() );
-                    p->setDeaths( player->getDeath());
-                    p->setKills( player->getKills());
-                    p->setSuicides( player->getSuicides());
-
-                    opponentFound = true;
-                    break;
-                }
-            }
-
-            // if it is an unknown add it
-            if( !opponentFound ) {
-                qDebug() << "NetworkClient::onDataReceived || Network::PARTICIPANT_CHANGES :: ADD as new opponent";
-                addOpponent( player );
-            }
-            else {
-                delete player;
-            }
-        }
+        updateParticipant( player );
         break;
     }
 
@@ -518,17 +587,64 @@ void NetworkClient::onDataReceived( BotRace::Network::DataType_T dataType, QByte
             p->deleteLater();
         }
 
-        Core::BoardScenario_T scenario;
+        QByteArray hash;
+        QString fileName;
         QDataStream instream( &data, QIODevice::ReadOnly );
-        instream >> scenario;
+        instream >> hash >> fileName;
 
-        getBoardManager()->setScenario( scenario );
+        changeScenario( hash, fileName );
+        break;
+    }
+    case Network::DATA_SCENARIO_DATA: {
+        QByteArray hash;
+        quint32 offset;
+        quint32 totalSize;
+        QByteArray chunk;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> hash >> offset >> totalSize >> chunk;
+
+        qDebug() << "NetworkClient::onDataReceived || Network::DATA_SCENARIO_DATA ::" << offset + chunk.size() << "of" << totalSize;
 
+        if( hash != m_requestedScenario || offset != ( quint32 )m_scenarioData.size() ) {
+            qWarning() << "NetworkClient::onDataReceived || unexpected scenario data";
+            break;
+        }
+
+        m_scenarioData.append( chunk );
+        if( ( quint32 )m_scenarioData.size() < totalSize ) {
+            m_scenarioTimer->start();
+            break;
+        }
+        m_scenarioTimer->stop();
+
+        Core::BoardScenario_T scenario;
+        if( Core::ScenarioCache::decodeScenario( m_scenarioData, scenario ) &&
+            Core::ScenarioCache::scenarioHash( scenario ) == hash ) {
+            Core::ScenarioCache::storeScenario( hash, m_scenarioData );
+            getBoardManager()->setScenario( scenario );
+        }
+        else {
+            qWarning() << "NetworkClient::onDataReceived || received scenario is broken";
+        }
+
+        m_requestedScenario.clear();
+        m_scenarioData.clear();
+
+        processDeferredMessages();
+        break;
+    }
+    case Network::DATA_GAME_SNAPSHOT: {
+        qDebug() << "NetworkClient::onDataReceived || Network::DATA_GAME_SNAPSHOT";
+        applyGameSnapshot( data );
         break;
     }
+    case Network::DATA_SCENARIO_REQUEST:
+        qWarning() << "NetworkClient::onDataReceived || Network::DATA_SCENARIO_REQUEST can't be handled";
+        break;
     case Network::SIGNAL_GAME_STARTED: {
         qDebug() << "NetworkClient::onDataReceived || Network::SIGNAL_GAME_STARTED with" << m_opponents.size() << "opponents and" << getOpponents().size() << "players/bots";
 
+        m_gameRunning = true;
         emit gameStarted();
         break;
     }
@@ -565,11 +681,11 @@ void NetworkClient::onDataReceived( BotRace::Network::DataType_T dataType, QByte
     case Network::DATA_ANIMATE_ROBOTS_LIST: {
         qDebug() << "NetworkClient::onDataReceived || Network::SIGNAL_ANIMATE_ROBOTS_LIST";
 
-        QStringList list;
+        Core::RobotAnimation_T sequence;
         QDataStream instream( &data, QIODevice::ReadOnly );
-        instream >> list;
+        instream >> sequence;
 
-        emit animateRobotMovement(list);
+        emit animateRobotMovement(sequence);
         break;
     }
     case Network::SIGNAL_ANIMATE_ROBOT_LASER: {
@@ -614,6 +730,7 @@ void NetworkClient::onDataReceived( BotRace::Network::DataType_T dataType, QByte
     }
     case Network::DATA_GAME_OVER: {
         qDebug() << "NetworkClient::onDataReceived || Network::DATA_GAME_OVER";
+        m_gameRunning = false;
 
         if( data.isEmpty() ) {
             emit gameLost();
@@ -703,8 +820,23 @@ void NetworkClient::onDataReceived( BotRace::Network::DataType_T dataType, QByte
         }
         break;
     }
-    case Network::SIGNAL_ANIMATION_FINISHED: {
-        qDebug() << "NetworkClient::onDataReceived || Network::SIGNAL_ANIMATION_FINISHED";
+    case Network::DATA_ANIMATION_FINISHED: {
+        qDebug() << "NetworkClient::onDataReceived || Network::DATA_ANIMATION_FINISHED";
+        break;
+    }
+    case Network::DATA_ANIMATION_BARRIER: {
+        quint32 barrier;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+
+        instream >> barrier;
+
+        qDebug() << "NetworkClient::onDataReceived || Network::DATA_ANIMATION_BARRIER :" << barrier;
+        setAnimationBarrier( barrier );
+        break;
+    }
+    case Network::SIGNAL_SKIP_ANIMATIONS: {
+        qDebug() << "NetworkClient::onDataReceived || Network::SIGNAL_SKIP_ANIMATIONS";
+        emit skipAnimations();
         break;
     }
     case Network::DATA_SELECTED_STARTING_ORIENTATION: {
@@ -724,18 +856,287 @@ void NetworkClient::onDataReceived( BotRace::Network::DataType_T dataType, QByte
             QDataStream instream( &data, QIODevice::ReadOnly );
             instream >> entry;
 
-            m_logAndChat->addEntry( entry );
+            // keep the order, new entries are added after the history is complete
+            if( m_logSyncRunning ) {
+                m_pendingLogEntries.append( entry );
+                break;
+            }
+
+            // the server threads may broadcast entries out of order, the history has the missing ones
+            if( entry.sequence > m_lastLogSequence + 1 ) {
+                qDebug() << "NetworkClient::onDataReceived || missing log entries before" << entry.sequence;
+
+                m_pendingLogEntries.append( entry );
+                m_logSyncRunning = true;
+                requestLogAndChatHistory();
+                break;
+            }
+
+            if( entry.sequence > m_lastLogSequence ) {
+                m_lastLogSequence = entry.sequence;
+                m_logAndChat->addEntry( entry );
+            }
+            break;
+        }
+    case Network::DATA_LOG_AND_CHAT_HISTORY: {
+        quint32 serverSequence;
+        QList<Core::LogChatEntry_T> entries;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> serverSequence;
+        instream >> entries;
+
+        qDebug() << "NetworkClient::onDataReceived || Network::DATA_LOG_AND_CHAT_HISTORY ::" << entries.size() << "entries, server at" << serverSequence;
+
+        foreach( const Core::LogChatEntry_T & entry, entries ) {
+            if( entry.sequence > m_lastLogSequence ) {
+                m_lastLogSequence = entry.sequence;
+                m_logAndChat->addEntry( entry );
+            }
+        }
+
+        if( !entries.isEmpty() && m_lastLogSequence < serverSequence ) {
+            requestLogAndChatHistory();
             break;
         }
-    case Network::DATA_LOG_AND_CHAT_HISTORY:
-        //TODO return complete history from server
-        qWarning() << "Network::DATA_LOG_AND_CHAT_HISTORY: Not implemented yet";
+
+        // history is complete, add everything that was received in the meantime
+        m_logSyncRunning = false;
+        foreach( const Core::LogChatEntry_T & entry, m_pendingLogEntries ) {
+            if( entry.sequence > m_lastLogSequence ) {
+                m_lastLogSequence = entry.sequence;
+                m_logAndChat->addEntry( entry );
+            }
+        }
+        m_pendingLogEntries.clear();
+        break;
+    }
+    case Network::DATA_LOG_AND_CHAT_HISTORY_REQUEST:
+        qWarning() << "NetworkClient::onDataReceived || Network::DATA_LOG_AND_CHAT_HISTORY_REQUEST can't be handled";
         break;
+    case Network::DATA_PROTOCOL_MISMATCH: {
+        quint32 protocolVersion;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> protocolVersion;
+
+        refuseProtocol( protocolVersion );
+        break;
+    }
     case Network::INVALID:
         qWarning() << "NetworkClient::onDataReceived | invalid data type requested";
     }
 }
 
+void NetworkClient::updateParticipant( Core::Participant *participant )
+{
+    // the the uuid is the same as the players one, update his states
+    if( participant->getUuid() == getUuid() ) {
+        getPlayer()->setName( participant->getName() );
+        getPlayer()->setUid( participant->getUuid() );
+        getPlayer()->setLife( participant->getLife() );
+        getPlayer()->setRobotType( participant->getRobotType() );
+        getPlayer()->setDamageToken( participant->getDamageToken() );
+        getPlayer()->setPosition( participant->getPosition() );
+        getPlayer()->setPowerDown( participant->getPowerDown() );
+        getPlayer()->setIsVirtual( participant->getIsVirtual() );
+
+        getPlayer()->setKingOfPoints( participant->getKingOfPoints() );
+        getPlayer()->pickedUpFlagChanged( participant->hasFlag() );
+
+        getPlayer()->setOrientation( participant->getOrientation() );
+        getPlayer()->setNextFlagFoal( participant->getNextFlagGoal() );
+        getPlayer()->setArchiveMarker( participant->getArchiveMarker() );
+        getPlayer()->setDeaths( participant->getDeath());
+        getPlayer()->setKills( participant->getKills());
+        getPlayer()->setSuicides( participant->getSuicides());
+
+        delete participant;
+    }
+    //otherwise check the opponents
+    else {
+        bool opponentFound = false;
+        foreach( Core::Participant * p, getOpponents() ) {
+            if( p->getUuid() == participant->getUuid() ) {
+                p->setName( participant->getName() );
+                p->setLife( participant->getLife() );
+                p->setUid( participant->getUuid() );
+                p->setRobotType( participant->getRobotType() );
+                p->setDamageToken( participant->getDamageToken() );
+                p->setPosition( participant->getPosition() );
+
+                p->setKingOfPoints( participant->getKingOfPoints() );
+                p->pickedUpFlagChanged( participant->hasFlag() );
+                p->setPowerDown( participant->getPowerDown() );
+                p->setIsVirtual( participant->getIsVirtual() );
+
+                p->setOrientation( participant->getOrientation() );
+                p->setNextFlagFoal( participant->getNextFlagGoal() );
+                p->setArchiveMarker( participant->getArchiveMarker() );
+                p->setDeaths( participant->getDeath());
+                p->setKills( participant->getKills());
+                p->setSuicides( participant->getSuicides());
+
+                opponentFound = true;
+                break;
+            }
+        }
+
+        // if it is an unknown add it
+        if( !opponentFound ) {
+            qDebug() << "NetworkClient::updateParticipant || ADD as new opponent";
+            addOpponent( participant );
+        }
+        else {
+            delete participant;
+        }
+    }
+}
+
+void NetworkClient::applyGameSnapshot( QByteArray data )
+{
+    QUuid uuid;
+    QUuid sessionToken;
+    int phase;
+    quint32 lastSequence;
+    bool flagDropped;
+    QPoint flagPosition;
+    quint16 participantCount;
+
+    QDataStream instream( &data, QIODevice::ReadOnly );
+    instream >> uuid >> sessionToken >> phase >> lastSequence >> flagDropped >> flagPosition >> participantCount;
+
+    qDebug() << "NetworkClient::applyGameSnapshot || rejoined in phase" << phase << "with" << participantCount << "participants";
+
+    // the server continues the game with the old client, so take over its identity again
+    // spectators receive a snapshot without identity
+    m_gameRunning = true;
+    if( !uuid.isNull() ) {
+        m_sessionToken = sessionToken;
+        m_connection->setUid( uuid );
+        getPlayer()->setUid( uuid );
+        setUuid( uuid );
+    }
+
+    for( int i = 0; i < participantCount; i++ ) {
+        Core::Participant *participant = new Core::Participant();
+        instream >> *participant;
+        updateParticipant( participant );
+    }
+
+    QList<Core::GameCard_T> deckCards;
+    QList<Core::GameCard_T> programCards;
+    quint16 minLockedSlot;
+    instream >> deckCards >> programCards >> minLockedSlot;
+
+    // unlock everything first, so the cards of the locked slots are replaced too
+    Core::CardDeck *deck = getDeck();
+    deck->lockProgramSlot( MAX_PROGRAM_SIZE + 1 );
+    deck->clearCards();
+
+    foreach( const Core::GameCard_T & card, deckCards ) {
+        if( card.type != Core::CARD_EMPTY ) {
+            deck->addCardToDeck( card );
+        }
+    }
+    for( int slot = 1; slot <= programCards.size() && slot <= MAX_PROGRAM_SIZE; slot++ ) {
+        if( programCards.at( slot - 1 ).type != Core::CARD_EMPTY ) {
+            deck->replaceCardInProgram( programCards.at( slot - 1 ), slot );
+        }
+    }
+    deck->lockProgramSlot( minLockedSlot );
+
+    if( flagDropped != getBoardManager()->isKingOfFlagDropped()
+        || flagPosition != getBoardManager()->getKingOfFlagPosition() ) {
+        if( flagDropped ) {
+            getBoardManager()->dropKingOfFlag( flagPosition );
+        }
+        else {
+            getBoardManager()->pickupKingOfFlag();
+        }
+    }
+
+    emit phaseChanged( phase );
+
+    // entries written while we were away, the history request of the handshake may have
+    // reached the server while it handed the connection to the game
+    if( m_resumeRequested || ( !m_logSyncRunning && m_lastLogSequence < lastSequence ) ) {
+        m_resumeRequested = false;
+        m_logSyncRunning = true;
+        requestLogAndChatHistory();
+    }
+}
+
+void NetworkClient::changeScenario( const QByteArray &hash, const QString &fileName )
+{
+    Core::BoardScenario_T scenario;
+
+    if( Core::ScenarioCache::loadLocalScenario( fileName, hash, scenario ) ||
+        Core::ScenarioCache::loadCachedScenario( hash, scenario ) ) {
+        getBoardManager()->setScenario( scenario );
+        return;
+    }
+
+    qDebug() << "NetworkClient::changeScenario || request unknown scenario" << fileName << hash.toHex();
+
+    m_requestedScenario = hash;
+    m_scenarioData.clear();
+    m_scenarioTimer->start();
+
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+    outstream << hash;
+
+    m_connection->sendData( Network::DATA_SCENARIO_REQUEST, data );
+}
+
+void NetworkClient::scenarioRequestTimedOut()
+{
+    qWarning() << "NetworkClient::scenarioRequestTimedOut || no scenario data received for" << m_requestedScenario.toHex();
+    abortScenarioRequest();
+}
+
+void NetworkClient::abortScenarioRequest()
+{
+    m_scenarioTimer->stop();
+    m_requestedScenario.clear();
+    m_scenarioData.clear();
+
+    processDeferredMessages();
+}
+
+void NetworkClient::processDeferredMessages()
+{
+    // stops again if one of the messages requests another scenario
+    while( !m_deferredMessages.isEmpty() && m_requestedScenario.isEmpty() ) {
+        QPair<Network::DataType_T, QByteArray> message = m_deferredMessages.takeFirst();
+        onDataReceived( message.first, message.second );
+    }
+}
+
+void NetworkClient::refuseProtocol( quint32 serverVersion )
+{
+    qWarning() << "NetworkClient::refuseProtocol || server uses protocol version" << serverVersion
+               << "this client" << Network::PROTOCOL_VERSION;
+
+    m_logAndChat->addEntry( Core::GAMEINFO_GENERAL,
+                            tr( "The server uses another network protocol (version %1, this client uses %2). "
+                                "Please use the same BotRace version as the server." )
+                            .arg( serverVersion ).arg( Network::PROTOCOL_VERSION ) );
+
+    // a reconnect would be refused again
+    m_gameRunning = false;
+    m_reconnectAttempts = 0;
+    m_connection->disconnect();
+}
+
+void NetworkClient::requestLogAndChatHistory()
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+    outstream << m_lastLogSequence;
+
+    m_connection->sendData( Network::DATA_LOG_AND_CHAT_HISTORY_REQUEST, data );
+}
+
 void NetworkClient::sendSelectedStartingPoint( QPoint selectedPoint )
 {
     qDebug() << "NetworkClient::sendSelectedStartingPoint";
@@ -778,6 +1179,11 @@ void NetworkClient::sessionOpened()
 
 void NetworkClient::displayError( QAbstractSocket::SocketError socketError )
 {
+    // a reconnect attempt failed, try again
+    if( m_reconnectAttempts > 0 ) {
+        scheduleReconnect();
+    }
+
     switch( socketError ) {
     case QAbstractSocket::RemoteHostClosedError:
         break;
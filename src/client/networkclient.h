@@ -23,8 +23,11 @@
 #include "engine/gamesettings.h"
 
 #include <QTcpSocket>
+#include <QPair>
+#include <QUuid>
 
 class QNetworkSession;
+class QTimer;
 
 namespace BotRace {
 namespace Client {
@@ -40,6 +43,15 @@ public:
 
     bool isBot();
 
+    /**
+     * @brief Watch the game only instead of joining with an own robot
+     *
+     * Must be set before connectToServer(), the server needs to allow spectators.
+     * @param spectator @c true to join as spectator
+     */
+    void setSpectator( bool spectator );
+    bool isSpectator() const;
+
     void joinGame();
     void leaveGame();
 
@@ -58,7 +70,7 @@ public slots:
     void startProgramming();
     void programmingFinished();
     void powerDownRobot();
-    void animationFinished();
+    void animationFinished( quint32 barrier );
 
     void selectStartingPoint( QList<QPoint> allowedStartingPoints );
     void selectStartingOrientation( QList<Core::Orientation> allowedOrientations );
@@ -73,14 +85,89 @@ private slots:
     void sendSelectedStartingPoint( QPoint selectedPoint );
     void sendSelectedStartingOrientation( Core::Orientation orientation );
 
+    // rejoin a running game after the connection was lost
+    void connectionLost();
+    void reconnectToServer();
+
+    // the server did not answer the scenario request in time
+    void scenarioRequestTimedOut();
+
 private:
     void initialize();
 
+    /**
+     * @brief Opens the connection to the host and port given in connectToServer()
+     */
+    void openConnection();
+
+    /**
+     * @brief Starts the next reconnect attempt after RECONNECT_INTERVAL ms
+     */
+    void scheduleReconnect();
+
+    /**
+     * @brief Updates the own player or the opponent with the same uuid as @p participant
+     *
+     * Unknown participants are added as new opponents.
+     * @param participant the participant received from the server, the object is taken over
+     */
+    void updateParticipant( Core::Participant *participant );
+
+    /**
+     * @brief Restores the game after a reconnect from the DATA_GAME_SNAPSHOT message
+     */
+    void applyGameSnapshot( QByteArray data );
+
+    /**
+     * @brief Shows that the server speaks another protocol version and closes the connection
+     *
+     * @param serverVersion the PROTOCOL_VERSION of the server, 0 for servers without version
+     */
+    void refuseProtocol( quint32 serverVersion );
+
+    /**
+     * @brief Asks the server for the log entries after the last received one
+     */
+    void requestLogAndChatHistory();
+
+    /**
+     * @brief Uses the scenario with the @p hash from the local boards or the cache or requests it from the server
+     *
+     * @param hash content hash of the scenario
+     * @param fileName file name of the scenario on the server
+     */
+    void changeScenario( const QByteArray &hash, const QString &fileName );
+
+    /**
+     * @brief Stops waiting for the requested scenario and handles the deferred messages
+     */
+    void abortScenarioRequest();
+
+    /**
+     * @brief Handles all messages received while the scenario was requested
+     */
+    void processDeferredMessages();
+
     Network::Connection *m_connection;
     QNetworkSession *m_networkSession;
+    QString m_host;                                 /**< Server address used for reconnects */
+    int m_port;                                     /**< Server port used for reconnects */
+    bool m_spectator;                               /**< Watches the game only, send with the handshake */
+    QUuid m_sessionToken;                           /**< Token of the server to rejoin the running game, kept in memory only */
+    bool m_gameRunning;                             /**< A game is running, reconnect when the connection is lost */
+    int m_reconnectAttempts;                        /**< Failed reconnects since the connection was lost */
+    bool m_reconnectPending;                        /**< A reconnect attempt is already scheduled */
+    bool m_resumeRequested;                         /**< The handshake asked to rejoin the game, the snapshot requests the log again */
 
     GameScene *m_scene;
     Core::GameLogAndChat *m_logAndChat;
+    quint32 m_lastLogSequence;                      /**< Newest server log entry received so far */
+    bool m_logSyncRunning;                          /**< The log history is still requested page by page */
+    QList<Core::LogChatEntry_T> m_pendingLogEntries; /**< New log entries received while the history is requested */
+    QByteArray m_requestedScenario;                 /**< Hash of the scenario requested from the server */
+    QByteArray m_scenarioData;                      /**< Received part of the compressed scenario */
+    QTimer *m_scenarioTimer;                        /**< Gives up the scenario request if the server stops sending */
+    QList<QPair<Network::DataType_T, QByteArray> > m_deferredMessages; /**< Messages received while the scenario is requested */
     QList<Client::NetworkClient *> m_opponents;
 };
 
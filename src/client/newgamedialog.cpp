@@ -101,6 +101,8 @@ void NewGameDialog::startGame()
     settings.setValue( "GameSettings/pointsToWinKingOf", currentGameSettings.pointsToWinKingOf );
     settings.setValue( "GameSettings/pushingDisabled", currentGameSettings.pushingDisabled );
     settings.setValue( "GameSettings/virtualRobotMode", currentGameSettings.virtualRobotMode );
+    settings.setValue( "GameSettings/animationTimeout", currentGameSettings.animationTimeout );
+    settings.setValue( "GameSettings/skipAnimations", currentGameSettings.skipAnimations );
     settings.sync();
 
     emit accept();
@@ -462,7 +462,7 @@ void ProgrammingWidget::paintEvent( QPaintEvent *event )
     QPainter painter( this );
     painter.setRenderHint( QPainter::Antialiasing );
 
-    painter.drawImage( rect(), m_renderer->getUiTheme()->getUiElement( "Programming_Deck" ) );
+    m_renderer->getUiTheme()->drawUiElement( &painter, rect(), QString( "Programming_Deck" ) );
 
     QWidget::paintEvent( event );
 }
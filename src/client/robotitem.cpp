@@ -20,13 +20,12 @@
 #include "renderer/gametheme.h"
 #include "renderer/tiletheme.h"
 #include "renderer/bottheme.h"
+#include "renderer/paintprofiler.h"
 #include "engine/participant.h"
 
 #include <QPainter>
 #include <QStyleOption>
 #include <QRectF>
-#include <QPropertyAnimation>
-#include <QParallelAnimationGroup>
 
 #include <QGraphicsPixmapItem>
 #include <QGraphicsScene>
@@ -45,6 +44,11 @@ RobotItem::RobotItem( Renderer::GameTheme *renderer, Core::Participant *player,
 {
     m_direction = m_player->getOrientation();
     m_tempNewPos = m_player->getPosition();
+    m_tempRotation = 0;
+
+    m_usedSteps = 0;
+    m_timelineSteps = 0;
+    m_stepTime = 0;
 
     connect( m_player, SIGNAL( gotHit( BotRace::Core::Robot::DamageReason_T ) ),
              this, SLOT( createHitAnimation( BotRace::Core::Robot::DamageReason_T ) ) );
@@ -99,197 +103,111 @@ void RobotItem::setTileSize( const QSizeF &scale )
     updateRobotPosition();
 }
 
-QParallelAnimationGroup *RobotItem::getMoveAnimation()
+void RobotItem::beginTimeline( int stepTime )
 {
-    QSettings settings;
-    int ANIMATION_STEP_TIME = settings.value( "Game/animation_step_time" ).toInt();
-
-    QParallelAnimationGroup *group = new QParallelAnimationGroup();
-
-    m_tempNewPos = m_player->getPosition();
-
-    QPointF newPos( m_player->getPosition().x() * m_sizeOfOneTile.width(),
-                    m_player->getPosition().y() * m_sizeOfOneTile.height() );
-
-    if( newPos != pos() ) {
-        QPropertyAnimation *movement = new QPropertyAnimation( this, "pos" );
-        movement->setDuration( ANIMATION_STEP_TIME );
-        movement->setStartValue( pos() );
-        movement->setEndValue( newPos );
-
-        group->addAnimation( movement );
+    // the steps stay in the vector for the next phase
+    m_usedSteps = 0;
+    m_timelineSteps = 0;
+    m_stepTime = stepTime;
+
+    // simple helper to avoid huge angles if we turn around a lot
+    // does not change the robot rotation at all as +-360 = 0
+    qreal rotAngle = rotation();
+    while( rotAngle >= 360 ) {
+        rotAngle -= 360;
     }
-
-    Core::Orientation newDirection = m_player->getOrientation();
-
-    if( newDirection != m_direction ) {
-        qreal rotAngle = rotation();
-
-        // simple helper to avoid huge angles if we turn around a lot
-        // does not changethe robot rotation at all as +-360 = 0
-        if( rotAngle == 360 ||  rotAngle == -360 ) {
-            setRotation( 0 );
-            rotAngle = 0;
-        }
-
-        switch( m_direction ) {
-        case Core::NORTH:
-            if( newDirection == Core::EAST ) {
-                rotAngle += 90;
-            }
-            else if( newDirection == Core::SOUTH ) {
-                rotAngle += 180;
-            }
-            else if( newDirection == Core::WEST ) {
-                rotAngle -= 90;
-            }
-            break;
-        case Core::EAST:
-            if( newDirection == Core::NORTH ) {
-                rotAngle -= 90;
-            }
-            else if( newDirection == Core::SOUTH ) {
-                rotAngle += 90;
-            }
-            else if( newDirection == Core::WEST ) {
-                rotAngle += 180;
-            }
-            break;
-        case Core::SOUTH:
-            if( newDirection == Core::NORTH ) {
-                rotAngle -= 180;
-            }
-            else if( newDirection == Core::EAST ) {
-                rotAngle -= 90;
-            }
-            else if( newDirection == Core::WEST ) {
-                rotAngle += 90;
-            }
-            break;
-        case Core::WEST:
-            if( newDirection == Core::NORTH ) {
-                rotAngle += 90;
-            }
-            else if( newDirection == Core::EAST ) {
-                rotAngle -= 180;
-            }
-            else if( newDirection == Core::SOUTH ) {
-                rotAngle -= 90;
-            }
-            break;
-        default:
-            // do nothing
-            break;
-        }
-
-        QPropertyAnimation *rotationAnim = new QPropertyAnimation( this, "rot" );
-        rotationAnim->setDuration( ANIMATION_STEP_TIME );
-        rotationAnim->setStartValue( rotation() );
-        rotationAnim->setEndValue( rotAngle );
-
-        group->addAnimation( rotationAnim );
-
-        m_direction = newDirection;
+    while( rotAngle <= -360 ) {
+        rotAngle += 360;
     }
+    setRotation( rotAngle );
 
-    return group;
+    m_tempRotation = rotAngle;
 }
 
-QParallelAnimationGroup *RobotItem::getMoveAnimation( Core::Orientation newDirection, QPoint boardPos )
+bool RobotItem::addTimelineStep( int step, Core::Orientation newDirection, const QPoint &boardPos )
 {
-    QSettings settings;
-    int ANIMATION_STEP_TIME = settings.value( "Game/animation_step_time" ).toInt();
-
-    QParallelAnimationGroup *group = new QParallelAnimationGroup();
-
     QPointF tempNewPos( m_tempNewPos.x() * m_sizeOfOneTile.width(),
                         m_tempNewPos.y() * m_sizeOfOneTile.height() );
 
     QPointF newPos( boardPos.x() * m_sizeOfOneTile.width(),
                     boardPos.y() * m_sizeOfOneTile.height() );
 
-    if( newPos != tempNewPos ) {
-        QPropertyAnimation *movement = new QPropertyAnimation( this, "pos" );
-        movement->setDuration( ANIMATION_STEP_TIME );
-        movement->setStartValue( tempNewPos );
-        movement->setEndValue( newPos );
+    if( newPos == tempNewPos && newDirection == m_direction ) {
+        return false;
+    }
 
-        group->addAnimation( movement );
+    qreal rotAngle = m_tempRotation;
+    switch(( newDirection - m_direction + 4 ) % 4 ) {
+    case 1:
+        rotAngle += 90;
+        break;
+    case 2:
+        // turn around clockwise from north and east, counter clockwise from south and west
+        if( m_direction == Core::NORTH || m_direction == Core::EAST ) {
+            rotAngle += 180;
+        }
+        else {
+            rotAngle -= 180;
+        }
+        break;
+    case 3:
+        rotAngle -= 90;
+        break;
+    default:
+        // do nothing
+        break;
+    }
 
-        m_tempNewPos = boardPos;
+    if( m_usedSteps == m_steps.size() ) {
+        m_steps.append( TimelineStep_T() );
     }
 
-    if( newDirection != m_direction ) {
-        qreal rotAngle = rotation();
+    // an unchanged position or rotation keeps its value for the whole step
+    TimelineStep_T &timelineStep = m_steps[m_usedSteps++];
+    timelineStep.step = step;
+    timelineStep.startPos = tempNewPos;
+    timelineStep.endPos = newPos;
+    timelineStep.startRotation = m_tempRotation;
+    timelineStep.endRotation = rotAngle;
 
-        // simple helper to avoid huge angles if we turn around a lot
-        // does not change the robot rotation at all as +-360 = 0
-        if( rotAngle == 360 ||  rotAngle == -360 ) {
-            setRotation( 0 );
-            rotAngle = 0;
-        }
+    m_tempNewPos = boardPos;
+    m_tempRotation = rotAngle;
+    m_direction = newDirection;
+    m_timelineSteps = qMax( m_timelineSteps, step + 1 );
 
-        switch( m_direction ) {
-        case Core::NORTH:
-            if( newDirection == Core::EAST ) {
-                rotAngle += 90;
-            }
-            else if( newDirection == Core::SOUTH ) {
-                rotAngle += 180;
-            }
-            else if( newDirection == Core::WEST ) {
-                rotAngle -= 90;
-            }
-            break;
-        case Core::EAST:
-            if( newDirection == Core::NORTH ) {
-                rotAngle -= 90;
-            }
-            else if( newDirection == Core::SOUTH ) {
-                rotAngle += 90;
-            }
-            else if( newDirection == Core::WEST ) {
-                rotAngle += 180;
-            }
-            break;
-        case Core::SOUTH:
-            if( newDirection == Core::NORTH ) {
-                rotAngle -= 180;
-            }
-            else if( newDirection == Core::EAST ) {
-                rotAngle -= 90;
-            }
-            else if( newDirection == Core::WEST ) {
-                rotAngle += 90;
-            }
-            break;
-        case Core::WEST:
-            if( newDirection == Core::NORTH ) {
-                rotAngle += 90;
-            }
-            else if( newDirection == Core::EAST ) {
-                rotAngle -= 180;
-            }
-            else if( newDirection == Core::SOUTH ) {
-                rotAngle -= 90;
-            }
-            break;
-        default:
-            // do nothing
-            break;
-        }
+    return true;
+}
 
-        QPropertyAnimation *rotationAnim = new QPropertyAnimation( this, "rot" );
-        rotationAnim->setDuration( ANIMATION_STEP_TIME );
-        rotationAnim->setStartValue( rotation() );
-        rotationAnim->setEndValue( rotAngle );
+bool RobotItem::addParticipantStep()
+{
+    // starts at the current position of the item instead of the end of the last sequence
+    if( !m_sizeOfOneTile.isEmpty() ) {
+        m_tempNewPos = QPoint( qRound( pos().x() / m_sizeOfOneTile.width() ),
+                               qRound( pos().y() / m_sizeOfOneTile.height() ) );
+    }
 
-        group->addAnimation( rotationAnim );
+    return addTimelineStep( 0, m_player->getOrientation(), m_player->getPosition() );
+}
 
-        m_direction = newDirection;
+bool RobotItem::advanceTrack( int time )
+{
+    // the last step that started until now, the robot waits at its end until the next one starts
+    const TimelineStep_T *current = 0;
+    for( int i = 0; i < m_usedSteps && m_steps.at( i ).step * m_stepTime <= time; i++ ) {
+        current = &m_steps.at( i );
     }
 
-    return group;
+    if( current ) {
+        qreal progress = 1.0;
+        if( m_stepTime > 0 ) {
+            progress = qMin( qreal( 1.0 ), ( time - current->step * m_stepTime ) / qreal( m_stepTime ) );
+        }
+
+        setPos( current->startPos + ( current->endPos - current->startPos ) * progress );
+        setRotation( current->startRotation + ( current->endRotation - current->startRotation ) * progress );
+    }
+
+    return time < m_timelineSteps * m_stepTime;
 }
 
 QRectF RobotItem::boundingRect() const
@@ -302,18 +220,20 @@ void RobotItem::paint( QPainter *painter, const QStyleOptionGraphicsItem *option
     Q_UNUSED( option );
     Q_UNUSED( widget );
 
-    QPixmap robot;
+    Renderer::ProfileTimer profileTimer( Renderer::PROFILE_ROBOT );
 
-    if(m_player->getIsVirtual()) {
-        robot = QPixmap::fromImage( m_renderer->getBotTheme()->getVirtualBot( m_player->getRobotType() ) );
-    }
-    else {
-        robot = QPixmap::fromImage( m_renderer->getBotTheme()->getBot( m_player->getRobotType() ) );
-    }
+    Renderer::BotTheme *botTheme = m_renderer->getBotTheme();
+    QRectF target( 0, 0, m_sizeOfOneTile.width(), m_sizeOfOneTile.height() );
 
     // creates a grayscale version of the robot image
     if( m_player->robotPoweredDown() ) {
-        QImage disabledRobot = robot.toImage();
+        QImage disabledRobot;
+        if( m_player->getIsVirtual() ) {
+            disabledRobot = botTheme->getVirtualBot( m_player->getRobotType() );
+        }
+        else {
+            disabledRobot = botTheme->getBot( m_player->getRobotType() );
+        }
         QRgb col;
         int gray;
         for( int i = 0; i < disabledRobot.width(); ++i ) {
@@ -326,17 +246,18 @@ void RobotItem::paint( QPainter *painter, const QStyleOptionGraphicsItem *option
             }
         }
 
-        painter->drawPixmap( 0, 0, m_sizeOfOneTile.width(), m_sizeOfOneTile.height(), QPixmap::fromImage( disabledRobot ) );
+        painter->drawImage( target, disabledRobot );
     }
     else {
-        painter->drawPixmap( 0, 0, m_sizeOfOneTile.width(), m_sizeOfOneTile.height(), robot );
+        // draws straight from the theme atlas, no copy of the sprite needed
+        botTheme->drawSprite( painter, target, botTheme->botId( m_player->getRobotType(), m_player->getIsVirtual() ) );
     }
 
     if( m_player->hasFlag() ) {
         // just draw the flag over the robot again
         // TODO: better drawing of the flag, maybe add anothr robot in bottheme with a flag
-        QPixmap flag = QPixmap::fromImage( m_renderer->getTileTheme()->getImage(QString("Flag_King")) );
-        painter->drawPixmap( 0, 0, m_sizeOfOneTile.width(), m_sizeOfOneTile.height(), flag );
+        Renderer::TileTheme *tileTheme = m_renderer->getTileTheme();
+        tileTheme->drawSprite( painter, target, tileTheme->spriteId( QString( "Flag_King" ) ) );
     }
 }
 
@@ -22,12 +22,11 @@
 #include <QGraphicsItem>
 
 #include <QSizeF>
+#include <QVector>
 
+#include "animationclock.h"
 #include "engine/robot.h"
 
-class QParallelAnimationGroup;
-class QPropertyAnimation;
-
 namespace BotRace {
 namespace Core {
 class Participant;
@@ -37,10 +36,21 @@ class GameTheme;
 }
 namespace Client {
 
+/**
+ * @brief One move or rotation of the robot timeline
+ */
+struct TimelineStep_T {
+    int step;               /**< Index of the scene step the move happens in */
+    QPointF startPos;       /**< Item position at the start of the step */
+    QPointF endPos;         /**< Item position at the end of the step */
+    qreal startRotation;    /**< Item rotation at the start of the step */
+    qreal endRotation;      /**< Item rotation at the end of the step */
+};
+
 /**
  * @brief This class is used to visualize each Participant Robot in the game
 */
-class RobotItem : public QObject, public QGraphicsItem {
+class RobotItem : public QObject, public QGraphicsItem, public AnimationTrack {
     Q_OBJECT
     Q_INTERFACES( QGraphicsItem );
     Q_PROPERTY( QPointF pos READ pos WRITE setPos );
@@ -66,26 +76,45 @@ public:
     Core::Participant *getPlayer() const;
 
     /**
-     * @brief Creates a Parallel animation (rotation position movement)
+     * @brief Empties the timeline for the next phase
      *
-     * Thus function is used in a non sequentiel way. The robot is rotated/moved
-     * from the current RobotItem parameters to the Participant Robot parameters
+     * The timeline is the AnimationTrack of the robot. For each phase it is filled again
+     * with addTimelineStep(), the steps of earlier phases are reused.
+     *
+     * @param stepTime duration of one step in ms
     */
-    QParallelAnimationGroup *getMoveAnimation();
+    void beginTimeline( int stepTime );
 
     /**
-     * @brief Creates the animation tfor the specific @p newDirection and @p boardPos
+     * @brief Adds one step of the sequentiel movement to the timeline
      *
-     * This is used when sequentiell movement is requested
      * In this mode each robot moves exactly as specifyed by the card priority, taking the pushing into account.
+     * Each step starts at @p step times the step time, so all robot timelines of the scene stay in sync.
      *
-     * Unlike the paralles animation above, this one will not create cases where a robot moves in a diagonal
-     * way over the board
-     *
+     * @param step index of the step, only steps that move at least one robot are counted
      * @param newDirection the new rotation of the robot as specifyed in the animation sequence
      * @param boardPos the new board position of the robot as specifyed in the animation sequence
+     * @return @c true if the robot moves or rotates in this step, @c false if nothing changes
     */
-    QParallelAnimationGroup *getMoveAnimation( Core::Orientation newDirection, QPoint boardPos );
+    bool addTimelineStep( int step, Core::Orientation newDirection, const QPoint &boardPos );
+
+    /**
+     * @brief Adds the move to the rotation/position of the Participant Robot as one step
+     *
+     * Used when no sequentiel movement is available. The robot is rotated/moved
+     * from the current RobotItem parameters to the Participant Robot parameters
+     *
+     * @return @c true if the robot moves or rotates, @c false if nothing changes
+    */
+    bool addParticipantStep();
+
+    /**
+     * @brief Moves the robot to its place in the timeline at @p time
+     *
+     * @param time ms since the timeline was started
+     * @return @c true until the last step of the timeline is over
+    */
+    bool advanceTrack( int time );
 
     /**
      * @brief Constructs the bounding rect
@@ -160,6 +189,12 @@ private:
 
     Core::Orientation m_direction;   /**< Cached last robot rotation used for the animation */
     QPoint m_tempNewPos;             /**< Cached last robot position used for the animation */
+    qreal m_tempRotation;            /**< Rotation angle at the end of the timeline */
+
+    QVector<TimelineStep_T> m_steps; /**< Steps of the timeline, only grows */
+    int m_usedSteps;                 /**< Steps used in the timeline of the current phase */
+    int m_timelineSteps;             /**< Number of scene steps covered by the timeline */
+    int m_stepTime;                  /**< Duration of one step in ms */
 };
 
 }
@@ -62,7 +62,7 @@ public:
     /**
      * @brief constructor
     */
-    AbstractClient(): QObject() ,m_boardManager(0), m_player(0), m_preferredRobotType(Core::MAX_ROBOTS) { }
+    AbstractClient(): QObject() ,m_boardManager(0), m_player(0), m_preferredRobotType(Core::MAX_ROBOTS), m_animationBarrier(0) { }
 
     /**
      * @brief destructor
@@ -131,6 +131,14 @@ public:
     */
     virtual bool isBot() = 0;
 
+    /**
+     * @brief Spectators only watch the game, they have no Participant in the running game
+     *
+    */
+    virtual bool isSpectator() const {
+        return false;
+    }
+
     /**
      * @brief Returns the CardDeck of the Participant connected t othis client
      *
@@ -193,6 +201,37 @@ public:
         return m_opponents;
     }
 
+    /**
+     * @brief Called by the GameEngine when it stopped waiting for the animation of this client
+     *
+     * The client should finish all running animations at once to catch up with the game.
+     *
+     * @see skipAnimations()
+    */
+    void requestAnimationSkip() {
+        emit skipAnimations();
+    }
+
+    /**
+     * @brief Sets the id of the animation barrier the next animations belong to
+     *
+     * Called by the GameEngine when an AnimationState starts, before any animation signal is emitted.
+     * The id is handed back with animationFinished(), so a late finish signal of an older
+     * animation can not count for the current one.
+     *
+     * @param barrier the id of the current animation barrier
+    */
+    void setAnimationBarrier( quint32 barrier ) {
+        m_animationBarrier = barrier;
+    }
+
+    /**
+     * @brief Returns the id of the animation barrier of the last started animation
+    */
+    quint32 getAnimationBarrier() const {
+        return m_animationBarrier;
+    }
+
     /**
      * @brief Sets the used BoardManager to retrieve the BoardScenario details
      *
@@ -273,8 +312,10 @@ public slots:
      * @see animateBoardGears()
      * @see animateBoardBelt1()
      * @see animateBoardBelt2()
+     *
+     * @param barrier the id of the finished animation barrier, see getAnimationBarrier()
     */
-    virtual void animationFinished() = 0;
+    virtual void animationFinished( quint32 barrier ) = 0;
 
     /**
      * @brief Called by the GameEngine to allow the client to select a new starting point
@@ -320,9 +361,9 @@ signals:
      *
      * @see animationFinished()
      *
-     * @param QStringList list of sequentiel robot movements in the right order
+     * @param sequence list of sequentiel robot movements in the right order
     */
-    void animateRobotMovement( QStringList );
+    void animateRobotMovement( const BotRace::Core::RobotAnimation_T &sequence );
 
     /**
      * @brief Emitted when the GameEngine request to animate the lasers and laser damage
@@ -428,12 +469,18 @@ signals:
       */
     void boardChanged();
 
+    /**
+      * @brief Emitted when the GameEngine does not wait for the current animation anymore
+      */
+    void skipAnimations();
+
 private:
     QUuid m_uuid; /**< The unique client identifer */
     QString m_name;
     Core::BoardManager *m_boardManager;
     Core::Participant *m_player;
     Core::RobotType m_preferredRobotType;
+    quint32 m_animationBarrier; /**< The id of the animation barrier of the last started animation */
 
 protected:
     QList<Core::Participant *> m_opponents;
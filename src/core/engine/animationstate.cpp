@@ -20,7 +20,9 @@
 #include "participant.h"
 #include "gameengine.h"
 #include "robot.h"
+#include "runtimemetrics.h"
 
+#include <QTimer>
 #include <QDebug>
 
 using namespace BotRace;
@@ -28,9 +30,15 @@ using namespace Core;
 
 AnimationState::AnimationState( GameEngine *engine, QState *parent )
     : QState( parent ),
-      m_engine( engine )
+      m_engine( engine ),
+      m_deadline( new QTimer( this ) ),
+      m_animationFinished( false )
 {
+    qRegisterMetaType<BotRace::Core::RobotAnimation_T> ( "BotRace::Core::RobotAnimation_T" );
+    qRegisterMetaType<quint32> ( "quint32" );
 
+    m_deadline->setSingleShot( true );
+    connect( m_deadline, SIGNAL( timeout() ), this, SLOT( animationTimedOut() ) );
 }
 
 void AnimationState::onEntry( QEvent *event )
@@ -38,23 +46,77 @@ void AnimationState::onEntry( QEvent *event )
     Q_UNUSED( event );
 
     m_waitingForAnimation.clear();
+    m_animationFinished = false;
+    m_animationTime.start();
+
+    // finish signals of older animations do not count for this state
+    m_engine->startAnimationBarrier();
+
+    // the timer fires after the inheriting state started its animation
+    GameSettings_T settings = m_engine->getGameSettings();
+    if( settings.skipAnimations ) {
+        m_deadline->start( 0 );
+    }
+    else if( settings.animationTimeout > 0 ) {
+        m_deadline->start( settings.animationTimeout * 1000 );
+    }
+}
+
+void AnimationState::onExit( QEvent *event )
+{
+    Q_UNUSED( event );
+
+    m_deadline->stop();
 }
 
 void AnimationState::animationFinished( Participant *p )
 {
+    if( m_animationFinished ) {
+        return;
+    }
+
     if( !m_waitingForAnimation.contains( p ) ) {
         m_waitingForAnimation.append( p );
+        m_engine->addAnimationLag( p, m_animationTime.elapsed() );
     }
 
     if( m_waitingForAnimation.size() == m_engine->getParticipants().size() ) {
-        // kill all robots that are falling into a pit or from the edge
-        // they have 9 damage token before and now they are dead
-        foreach( Robot * robot, m_engine->getRobots() ) {
-            if( robot->isFallingDown() ) {
-                robot->setDamageToken( 100 );
+        finishAnimation();
+    }
+}
+
+void AnimationState::animationTimedOut()
+{
+    if( m_animationFinished ) {
+        return;
+    }
+
+    if( !m_engine->getGameSettings().skipAnimations ) {
+        foreach( Participant * p, m_engine->getParticipants() ) {
+            if( !m_waitingForAnimation.contains( p ) ) {
+                m_engine->animationTimedOut( p, m_animationTime.elapsed() );
             }
         }
+    }
+
+    finishAnimation();
+}
+
+void AnimationState::finishAnimation()
+{
+    m_animationFinished = true;
+    m_deadline->stop();
 
-        emit finished();
+    RuntimeMetrics::add( METRIC_ANIMATION_BARRIERS );
+    RuntimeMetrics::record( METRIC_ANIMATION_BARRIER, m_animationTime.elapsed() );
+
+    // kill all robots that are falling into a pit or from the edge
+    // they have 9 damage token before and now they are dead
+    foreach( Robot * robot, m_engine->getRobots() ) {
+        if( robot->isFallingDown() ) {
+            robot->setDamageToken( 100 );
+        }
     }
+
+    emit finished();
 }
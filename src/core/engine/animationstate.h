@@ -21,9 +21,12 @@
 #include <QState>
 #include <QList>
 #include <QString>
-#include <QStringList>
+#include <QTime>
 
 #include "gameengine.h"
+#include "robotanimation.h"
+
+class QTimer;
 
 namespace BotRace {
 namespace Core {
@@ -39,6 +42,10 @@ class Participant;
  *
  * When the @c AbstractClient finished the animation, the state is informed
  * When all connected clients send the finish signal the state can be finished
+ *
+ * If GameSettings_T::animationTimeout is set, the state does not wait longer than this for
+ * slow clients. The missing clients are treated as finished and asked to skip their animation.
+ * With GameSettings_T::skipAnimations the state finishes without waiting for any client.
 */
 class AnimationState : public QState {
     Q_OBJECT
@@ -67,13 +74,26 @@ public:
 
 protected:
     /**
-      * @brief clears the client waiting list
+      * @brief clears the client waiting list and starts the animation deadline
       *
       * This must be called via AnimationState::onEntry(event) from any class
       * inheriting from this base calss
       */
     void onEntry( QEvent *event );
 
+    /**
+      * @brief stops the animation deadline
+      */
+    void onExit( QEvent *event );
+
+private slots:
+    /**
+     * @brief Called when the clients did not finish the animation in time
+     *
+     * All participants that did not send the finish signal yet are treated as finished
+    */
+    void animationTimedOut();
+
 signals:
     /**
      * @brief This signal is emitted to inform all @c AbstractClient 's to start its animation
@@ -94,17 +114,25 @@ signals:
      *
      * Used to animate the robots card movement in detail
      *
-     * Each String entry holds all robot positions/rotations.
+     * Each step holds the robot positions/rotations after one played card.
      * Only the robot with the highest card priority and the robots pushed by them
      * will have changed entries and thus be moved
      *
-     * Entry list : RobotType ; Orientation ; Position ;
+     * @param sequence the packed robot moves of this phase
     */
-    void startAnimation( QStringList sequence );
+    void startAnimation( const BotRace::Core::RobotAnimation_T &sequence );
 
 private:
+    /**
+     * @brief Finishes the state once all participants are done with the animation
+    */
+    void finishAnimation();
+
     GameEngine *m_engine;                        /**< Pointer to the friend game engine class */
     QList<Participant *> m_waitingForAnimation;  /**< list of clients already finished animation */
+    QTimer *m_deadline;                          /**< Ends the waiting for slow clients */
+    QTime m_animationTime;                       /**< Time since the animation was started */
+    bool m_animationFinished;                    /**< The finished() signal was already emitted */
 };
 
 }
@@ -432,6 +432,11 @@ QPoint BoardManager::getKingOfFlagPosition() const
     return m_currentKingOfFlagPosition;
 }
 
+bool BoardManager::isKingOfFlagDropped() const
+{
+    return m_kingOfFlagDropped;
+}
+
 QPoint BoardManager::getKingOfHillPosition() const
 {
     return m_scenario.kingOfTheHillPoint;
@@ -220,6 +220,12 @@ public:
     void pickupKingOfFlag();
     QPoint getKingOfFlagPosition() const;
 
+    /**
+     * @brief Returns if the king of the flag lies on the board
+     * @return @c true if the flag was dropped, @c false if a robot carries it
+    */
+    bool isKingOfFlagDropped() const;
+
     QPoint getKingOfHillPosition() const;
 
 signals:
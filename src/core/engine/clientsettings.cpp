@@ -0,0 +1,58 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "clientsettings.h"
+
+#include <QCoreApplication>
+#include <QSettings>
+
+using namespace BotRace;
+using namespace Core;
+
+ClientSettings *ClientSettings::instance()
+{
+    static ClientSettings *settings = 0;
+
+    if( !settings ) {
+        settings = new ClientSettings( QCoreApplication::instance() );
+    }
+
+    return settings;
+}
+
+const ClientSettings_T &ClientSettings::values()
+{
+    return instance()->m_values;
+}
+
+ClientSettings::ClientSettings( QObject *parent )
+    : QObject( parent )
+{
+    reload();
+}
+
+void ClientSettings::reload()
+{
+    QSettings settings;
+
+    m_values.useAnimation = settings.value( "Game/use_animation", false ).toBool();
+    m_values.animationStepTime = qMax( 0, settings.value( "Game/animation_step_time", 500 ).toInt() );
+    m_values.fastPlayback = settings.value( "Game/fast_playback", false ).toBool();
+    m_values.boardCacheSize = qMax( 1, settings.value( "Game/board_cache_size", DEFAULT_BOARD_CACHE_SIZE ).toInt() );
+
+    emit changed();
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLIENTSETTINGS_H
+#define CLIENTSETTINGS_H
+
+#include <QObject>
+
+namespace BotRace {
+namespace Core {
+
+/**
+ * @brief Default memory budget of the board chunk cache in MB, used if Game/board_cache_size is not set
+ */
+const int DEFAULT_BOARD_CACHE_SIZE = 64;
+
+/**
+ * @brief The game settings read while a game runs
+ */
+struct ClientSettings_T {
+    bool useAnimation;          /**< Game/use_animation, shows the board animations */
+    int animationStepTime;      /**< Game/animation_step_time, duration of one animation step in ms */
+    bool fastPlayback;          /**< Game/fast_playback, runs all scene animations faster */
+    int boardCacheSize;         /**< Game/board_cache_size, memory budget of the board chunk cache in MB */
+};
+
+/**
+ * @brief In-memory snapshot of the QSettings used by the client, the renderer and the editor
+ *
+ * Creating a QSettings object and reading from it can hit the disk. The animation code reads
+ * the plain fields of values() instead, which are only read from QSettings again by reload().
+ *
+ * Whoever writes one of these settings calls reload() afterwards, the ConfigDialog does it
+ * for all its pages. Objects that keep a copy of a setting connect to changed().
+ */
+class ClientSettings : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Returns the shared instance, the settings are read on the first call
+     */
+    static ClientSettings *instance();
+
+    /**
+     * @brief Returns the current snapshot of the settings
+     */
+    static const ClientSettings_T &values();
+
+public slots:
+    /**
+     * @brief Reads all settings from QSettings again and emits changed()
+     */
+    void reload();
+
+signals:
+    void changed();
+
+private:
+    explicit ClientSettings( QObject *parent = 0 );
+
+    ClientSettings_T m_values; /**< The current snapshot */
+};
+
+}
+}
+
+#endif // CLIENTSETTINGS_H
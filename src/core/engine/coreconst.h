@@ -56,6 +56,20 @@
   */
 #define CARDS_PER_ROUND 9
 
+/**
+  * @brief Number of log and chat entries kept in memory
+  *
+  * Older entries are dropped or written to the archive file
+  */
+#define MAX_LOG_HISTORY 500
+
+/**
+  * @brief Max number of log and chat entries send with one history message
+  *
+  * Keeps each message far below the 16bit network frame size
+  */
+#define LOG_HISTORY_PAGE_SIZE 50
+
 /**
  * @brief size of a single tile in the theme svg file
  *
@@ -34,7 +34,11 @@ HEADERS += \
     engine/coreconst.h \
     engine/statemovepusher.h \
     engine/statemovecrusher.h \
-    engine/stategamefinished.h
+    engine/stategamefinished.h \
+    engine/robotanimation.h \
+    engine/scenariocache.h \
+    engine/runtimemetrics.h \
+    engine/clientsettings.h
 
 SOURCES += \
     engine/carddeck.cpp \
@@ -63,5 +67,9 @@ SOURCES += \
     engine/gamesettings.cpp \
     engine/statemovepusher.cpp \
     engine/statemovecrusher.cpp \
-    engine/stategamefinished.cpp
+    engine/stategamefinished.cpp \
+    engine/robotanimation.cpp \
+    engine/scenariocache.cpp \
+    engine/runtimemetrics.cpp \
+    engine/clientsettings.cpp
 
@@ -26,6 +26,7 @@
 #include "ki/treedecisionbot.h"
 #include "gamelogandchat.h"
 #include "coreconst.h"
+#include "runtimemetrics.h"
 
 #include <QStateMachine>
 #include "animationstate.h"
@@ -56,7 +57,8 @@ GameEngine::GameEngine( GameLogAndChat *glac )
     m_logAndChat( 0 ),
     m_cardManager( 0 ),
     m_gameRoundMachine( 0 ),
-    m_currentPhase(1)
+    m_currentPhase(1),
+    m_animationBarrier( 0 )
 {
     m_board = new BoardManager();
     m_cardManager = new CardManager();
@@ -285,8 +287,8 @@ bool GameEngine::joinGame( AbstractClient *client )
     // connect gamenegine signals
     connect( this, SIGNAL( animateRobotMovement() ),
              client, SIGNAL( animateRobotMovement() ) );
-    connect( this, SIGNAL( animateRobotMovement( QStringList ) ),
-             client, SIGNAL( animateRobotMovement( QStringList ) ) );
+    connect( this, SIGNAL( animateRobotMovement( BotRace::Core::RobotAnimation_T ) ),
+             client, SIGNAL( animateRobotMovement( BotRace::Core::RobotAnimation_T ) ) );
 
     connect( this, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ),
              client, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int)) );
@@ -340,8 +342,8 @@ void GameEngine::clientLeft( QUuid clientUuid )
     // connect gamenegine signals
     connect( this, SIGNAL( animateRobotMovement() ),
              sb, SIGNAL( animateRobotMovement() ) );
-    connect( this, SIGNAL( animateRobotMovement( QStringList ) ),
-             sb, SIGNAL( animateRobotMovement( QStringList ) ) );
+    connect( this, SIGNAL( animateRobotMovement( BotRace::Core::RobotAnimation_T ) ),
+             sb, SIGNAL( animateRobotMovement( BotRace::Core::RobotAnimation_T ) ) );
     connect( this, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ),
             sb, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ) );
 
@@ -400,8 +402,21 @@ int GameEngine::getCurrentPhase() const
     return m_currentPhase;
 }
 
-void GameEngine::clientAnimationFinished( AbstractClient *client )
+void GameEngine::clientAnimationFinished( AbstractClient *client, quint32 barrier )
 {
+    Participant *p = client->getPlayer();
+
+    // the AnimationStates don't wait at all, nothing to do here
+    if( m_gameSettings.skipAnimations ) {
+        return;
+    }
+
+    // the finish signal belongs to an animation that timed out already
+    if( barrier != m_animationBarrier ) {
+        m_animationLag[p].lateFinished++;
+        return;
+    }
+
     foreach( QAbstractState * state, m_gameRoundMachine->configuration() ) {
         AnimationState *animState = qobject_cast<AnimationState *>( state );
         if( animState ) {
@@ -410,6 +425,51 @@ void GameEngine::clientAnimationFinished( AbstractClient *client )
     }
 }
 
+quint32 GameEngine::startAnimationBarrier()
+{
+    m_animationBarrier++;
+
+    foreach( AbstractClient * ac, m_clients ) {
+        ac->setAnimationBarrier( m_animationBarrier );
+    }
+
+    emit animationBarrierStarted( m_animationBarrier );
+
+    return m_animationBarrier;
+}
+
+void GameEngine::animationTimedOut( Participant *p, int msec )
+{
+    AnimationLag_T &lag = m_animationLag[p];
+    lag.timedOut++;
+    lag.totalLag += msec;
+    lag.maxLag = qMax( lag.maxLag, msec );
+
+    RuntimeMetrics::add( METRIC_ANIMATION_TIMEOUTS );
+
+    qDebug() << "GameEngine::animationTimedOut ||" << p->getName() << "did not finish the animation in" << msec << "ms";
+
+    foreach( AbstractClient * ac, m_clients ) {
+        if( ac->getPlayer() == p ) {
+            ac->requestAnimationSkip();
+            break;
+        }
+    }
+}
+
+void GameEngine::addAnimationLag( Participant *p, int msec )
+{
+    AnimationLag_T &lag = m_animationLag[p];
+    lag.finished++;
+    lag.totalLag += msec;
+    lag.maxLag = qMax( lag.maxLag, msec );
+}
+
+AnimationLag_T GameEngine::getAnimationLag( Participant *p ) const
+{
+    return m_animationLag.value( p );
+}
+
 bool GameEngine::powerDownRobot( Participant *p )
 {
     foreach( Robot * r, m_robots ) {
@@ -543,7 +603,7 @@ void GameEngine::setUpStateMachine()
         // move robots according to card -> move express belts
         stateMoveRobots->addTransition( stateMoveRobots, SIGNAL( finished() ), stateExpressConveyors );
         connect( stateMoveRobots, SIGNAL( startAnimation() ), this, SIGNAL( animateRobotMovement() ) );
-        connect( stateMoveRobots, SIGNAL( startAnimation( QStringList ) ), this, SIGNAL( animateRobotMovement( QStringList ) ) );
+        connect( stateMoveRobots, SIGNAL( startAnimation( BotRace::Core::RobotAnimation_T ) ), this, SIGNAL( animateRobotMovement( BotRace::Core::RobotAnimation_T ) ) );
         connect( stateMoveRobots, SIGNAL( phaseChanged(int) ), this, SIGNAL( phaseChanged(int)) );
 
         // belts moved -> move normal and express
@@ -610,4 +670,37 @@ void GameEngine::setUpStateMachine()
     m_gameRoundMachine->addState( stategameFinished );
 
     m_gameRoundMachine->setInitialState( stateSetUpNewGame );
+
+    // runtime metrics
+    foreach( QAbstractState * state, m_gameRoundMachine->findChildren<QAbstractState *>() ) {
+        connect( state, SIGNAL( entered() ), this, SLOT( countStateTransition() ) );
+    }
+    connect( stateMoveRobots, SIGNAL( entered() ), this, SLOT( startPhaseTimer() ) );
+    connect( stateProgrammingFinished, SIGNAL( entered() ), this, SLOT( recordPhaseTime() ) );
+    connect( stateDealCards, SIGNAL( entered() ), this, SLOT( recordRoundTime() ) );
+}
+
+void GameEngine::countStateTransition()
+{
+    RuntimeMetrics::add( METRIC_STATE_TRANSITIONS );
+}
+
+void GameEngine::startPhaseTimer()
+{
+    m_phaseTime.start();
+}
+
+void GameEngine::recordPhaseTime()
+{
+    RuntimeMetrics::record( METRIC_PHASE_DURATION, m_phaseTime.elapsed() );
+}
+
+void GameEngine::recordRoundTime()
+{
+    // the first deal has no round before
+    if( m_roundTime.isValid() ) {
+        RuntimeMetrics::record( METRIC_ROUND_DURATION, m_roundTime.elapsed() );
+    }
+
+    m_roundTime.start();
 }
@@ -21,10 +21,13 @@
 #include <QObject>
 #include <QUuid>
 #include <QList>
+#include <QHash>
 #include <QStringList>
+#include <QTime>
 
 #include "gamesettings.h"
 #include "robot.h"
+#include "robotanimation.h"
 
 class QStateMachine;
 
@@ -40,7 +43,7 @@ class GameLogAndChat;
 /**
  * @brief Enumaration that defines all availabe animated phases of the game
  *
- * Evertime a phase is animated the game waits for all clients to return the clientAnimationFinished( AbstractClient *client );
+ * Evertime a phase is animated the game waits for all clients to return the clientAnimationFinished( AbstractClient *client, quint32 barrier );
  * slot the the game can start the next phase
  */
 enum AnimateElements {
@@ -52,6 +55,19 @@ enum AnimateElements {
     ANIM_CRUSHER
 };
 
+/**
+ * @brief Statistic how long the game had to wait for the animations of one Participant
+ */
+struct AnimationLag_T {
+    AnimationLag_T() : finished( 0 ), timedOut( 0 ), lateFinished( 0 ), totalLag( 0 ), maxLag( 0 ) {}
+
+    int finished;       /**< Animations finished before the deadline */
+    int timedOut;       /**< Animations the game stopped waiting for */
+    int lateFinished;   /**< Finish signals received after the deadline */
+    qint64 totalLag;    /**< Sum of all waiting times in ms */
+    int maxLag;         /**< Longest waiting time in ms */
+};
+
 /**
  * @brief This connects all important parts of the game together
  *
@@ -138,9 +154,48 @@ public:
     /**
      * @brief Connects to the running state to indicate a client finished its animation
      *
+     * Finish signals with another @p barrier than the current one belong to an animation the
+     * game does not wait for anymore and are ignored.
+     *
      * @param client the client who finished the animation
+     * @param barrier the id of the finished animation barrier
+    */
+    void clientAnimationFinished( AbstractClient *client, quint32 barrier );
+
+    /**
+     * @brief Starts a new animation barrier, called by each AnimationState when it is entered
+     *
+     * All clients get the new id before the state emits its animation signals.
+     *
+     * @return the id of the new barrier
+    */
+    quint32 startAnimationBarrier();
+
+    /**
+     * @brief Called by the AnimationState when it stopped waiting for the animation of a Participant
+     *
+     * The client of the Participant is asked to skip its running animations. The finish signal it will
+     * send for this animation later on carries the id of the old barrier and is ignored.
+     *
+     * @param p the Participant who did not finish the animation in time
+     * @param msec the time the game waited for the Participant
     */
-    void clientAnimationFinished( AbstractClient *client );
+    void animationTimedOut( Participant *p, int msec );
+
+    /**
+     * @brief Adds the time the game waited for the animation of a Participant to its statistic
+     *
+     * @param p the Participant who finished the animation
+     * @param msec the time between the start of the animation and the finish signal
+    */
+    void addAnimationLag( Participant *p, int msec );
+
+    /**
+     * @brief Returns how long the game had to wait for the animations of a Participant so far
+     *
+     * @param p the Participant
+    */
+    AnimationLag_T getAnimationLag( Participant *p ) const;
 
     /**
      * @brief called by the client to change the power down anouncement
@@ -215,13 +270,20 @@ signals:
      *
      * @param sequence the sequence to be used for the sequentiel animation
     */
-    void animateRobotMovement( QStringList sequence );
+    void animateRobotMovement( const BotRace::Core::RobotAnimation_T &sequence );
 
     /**
      * @brief Emitted to tell the clients to animate some graphic element
     */
     void animateGraphicElements(BotRace::Core::AnimateElements animation, int phase);
 
+    /**
+     * @brief Emitted when an AnimationState starts to wait for the clients
+     *
+     * @param barrier the id the clients send back with the finish signal
+    */
+    void animationBarrierStarted( quint32 barrier );
+
     /**
      * @brief Emits what phase of the game (1-5) we are currently in at the start of each phase, before the robots move
      * @param newPhase the current phase @c 1-5
@@ -270,6 +332,12 @@ private slots:
     */
     void gameLost();
 
+    // runtime metrics of the state machine
+    void countStateTransition();
+    void startPhaseTimer();
+    void recordPhaseTime();
+    void recordRoundTime();
+
 private:
     /**
      * @brief Creates the actual game state machine for the current game
@@ -292,6 +360,11 @@ private:
 
     QStateMachine *m_gameRoundMachine;      /**< Pointer to the used State machine  */
     int m_currentPhase;                     /**< Saves the current phase of the game */
+
+    QHash<Participant *, AnimationLag_T> m_animationLag;    /**< Animation waiting time for each Participant */
+    quint32 m_animationBarrier;             /**< Id of the animation barrier the AnimationStates wait for at the moment */
+    QTime m_phaseTime;                      /**< Time since the current phase started */
+    QTime m_roundTime;                      /**< Time since the cards of the current round were dealt */
 };
 
 }
@@ -16,13 +16,29 @@
  */
 
 #include "gamelogandchat.h"
+#include "coreconst.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QMetaType>
+
+#include <QDebug>
 
 using namespace BotRace;
 using namespace Core;
 
 GameLogAndChat::GameLogAndChat( ) :
-    QObject( )
+    QObject( ),
+    m_lastSequence( 0 ),
+    m_archive( 0 )
 {
+    // entries are passed to the lobby from the game table threads
+    qRegisterMetaType<BotRace::Core::LogChatEntry_T> ( "Core::LogChatEntry_T" );
+}
+
+GameLogAndChat::~GameLogAndChat()
+{
+    delete m_archive;
 }
 
 void GameLogAndChat::addEntry( EntryType type, const QString &text )
@@ -32,27 +48,101 @@ void GameLogAndChat::addEntry( EntryType type, const QString &text )
     entry.timestamp = QTime::currentTime();
     entry.text = text;
 
-    m_history.append( entry );
+    {
+        QMutexLocker locker( &m_mutex );
+        entry.sequence = m_lastSequence + 1;
+        appendToHistory( entry );
+    }
 
     emit newEntry( entry );
 }
 
 void GameLogAndChat::addEntry( LogChatEntry_T entry )
 {
-    m_history.append( entry );
+    {
+        QMutexLocker locker( &m_mutex );
+        appendToHistory( entry );
+    }
     emit newEntry( entry );
 }
 
 QList<LogChatEntry_T> GameLogAndChat::getHistory() const
 {
+    QMutexLocker locker( &m_mutex );
     return m_history;
 }
 
+QList<LogChatEntry_T> GameLogAndChat::getHistorySince( quint32 sequence, int maxEntries ) const
+{
+    QList<LogChatEntry_T> entries;
+
+    QMutexLocker locker( &m_mutex );
+    if( m_history.isEmpty() || sequence >= m_lastSequence ) {
+        return entries;
+    }
+
+    // the sequence numbers are continuous, so the start can be calculated directly
+    int start = 0;
+    if( sequence >= m_history.first().sequence ) {
+        start = sequence - m_history.first().sequence + 1;
+    }
+
+    return m_history.mid( start, maxEntries );
+}
+
+quint32 GameLogAndChat::lastSequence() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_lastSequence;
+}
+
+bool GameLogAndChat::setArchiveFile( const QString &fileName )
+{
+    QMutexLocker locker( &m_mutex );
+    delete m_archive;
+    m_archive = 0;
+
+    if( fileName.isEmpty() ) {
+        return true;
+    }
+
+    m_archive = new QFile( fileName );
+    if( !m_archive->open( QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text ) ) {
+        qWarning() << "GameLogAndChat::setArchiveFile || could not open" << fileName << m_archive->errorString();
+        delete m_archive;
+        m_archive = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void GameLogAndChat::appendToHistory( const LogChatEntry_T &entry )
+{
+    m_history.enqueue( entry );
+    m_lastSequence = entry.sequence;
+
+    if( m_history.size() <= MAX_LOG_HISTORY ) {
+        return;
+    }
+
+    LogChatEntry_T oldEntry = m_history.dequeue();
+
+    if( m_archive ) {
+        QTextStream out( m_archive );
+        out << oldEntry.sequence << '\t'
+            << oldEntry.timestamp.toString( Qt::ISODate ) << '\t'
+            << ( int )oldEntry.type << '\t'
+            << QString( oldEntry.text ).replace( '\n', ' ' ) << '\n';
+    }
+}
+
 namespace BotRace {
 namespace Core {
 QDataStream &operator>>( QDataStream &s, BotRace::Core::LogChatEntry_T &p )
 {
     quint16 type;
+    s >> p.sequence;
     s >> type;
     p.type = ( EntryType )type;
     s >> p.timestamp;
@@ -63,6 +153,7 @@ QDataStream &operator>>( QDataStream &s, BotRace::Core::LogChatEntry_T &p )
 
 QDataStream &operator<<( QDataStream &s, const BotRace::Core::LogChatEntry_T &p )
 {
+    s << p.sequence;
     s << ( quint16 )p.type;
     s << p.timestamp;
     s << p.text;
@@ -23,7 +23,11 @@
 #include <QTime>
 #include <QString>
 #include <QList>
+#include <QQueue>
 #include <QDataStream>
+#include <QMutex>
+
+class QFile;
 
 namespace BotRace {
 namespace Core {
@@ -44,6 +48,7 @@ enum EntryType {
  * @brief Struct defining one entry in the log
 */
 struct LogChatEntry_T {
+    quint32 sequence;   /**< Running number of the entry, starts with 1 */
     EntryType type;     /**< Type of the entry */
     QTime timestamp;    /**< Timestamp of the entry */
     QString text;       /**< Content of the entry */
@@ -58,6 +63,13 @@ QDataStream &operator>>( QDataStream &s, BotRace::Core::LogChatEntry_T &p );
  * This class contains the database with all previous game log and chat entries
  * clients can use this object to show some game related information and to interact
  * with other players
+ *
+ * Only the last MAX_LOG_HISTORY entries are kept in memory. Each entry gets a running
+ * sequence number, so clients can ask for all entries they did not receive yet.
+ * If an archive file is set, the dropped entries are appended to it.
+ *
+ * The server shares one log between the lobby and the thread of each game table, so the
+ * history is guarded by a mutex. newEntry() is emitted in the thread that added the entry.
 */
 class GameLogAndChat : public QObject {
     Q_OBJECT
@@ -67,6 +79,11 @@ public:
     */
     GameLogAndChat( );
 
+    /**
+     * @brief destructor, closes the archive file
+    */
+    ~GameLogAndChat();
+
     /**
      * @brief Adds a new to the log
      *
@@ -74,15 +91,48 @@ public:
      * @param text the content
     */
     void addEntry( EntryType type, const QString &text );
+
+    /**
+     * @brief Adds an entry received from somewhere else to the log
+     *
+     * Used by the network client to mirror the server log. The sequence number of
+     * the entry is kept as it is.
+     *
+     * @param entry the new entry
+    */
     void addEntry( LogChatEntry_T entry );
 
     /**
-     * @brief Returns the full log history
+     * @brief Returns the log history kept in memory
      *
-     * @return full list of log entries
+     * @return list of the last MAX_LOG_HISTORY log entries
     */
     QList<LogChatEntry_T> getHistory() const;
 
+    /**
+     * @brief Returns the entries added after a specific entry
+     *
+     * @param sequence sequence number of the last known entry, 0 to start with the oldest one
+     * @param maxEntries max number of entries returned
+     * @return the next @p maxEntries entries in the order they were added
+    */
+    QList<LogChatEntry_T> getHistorySince( quint32 sequence, int maxEntries ) const;
+
+    /**
+     * @brief Returns the sequence number of the newest entry or 0 if the log is empty
+    */
+    quint32 lastSequence() const;
+
+    /**
+     * @brief Writes all entries dropped from the in memory history to @p fileName
+     *
+     * The entries are appended as tab separated text lines. An empty file name disables the archive.
+     *
+     * @param fileName the archive file
+     * @return @c false if the file could not be opened
+    */
+    bool setArchiveFile( const QString &fileName );
+
 signals:
     /**
      * @brief Emitted when a new entry is added t othe log
@@ -92,7 +142,15 @@ signals:
     void newEntry( Core::LogChatEntry_T );
 
 private:
-    QList<LogChatEntry_T> m_history; /**< Complete list of all entries */
+    /**
+     * @brief Appends the entry to the history and drops the oldest one if the history is full
+    */
+    void appendToHistory( const LogChatEntry_T &entry );
+
+    QQueue<LogChatEntry_T> m_history;  /**< The last MAX_LOG_HISTORY entries */
+    quint32 m_lastSequence;            /**< Sequence number of the newest entry */
+    QFile *m_archive;                  /**< Archive for entries dropped from the history or 0 */
+    mutable QMutex m_mutex;            /**< Guards the history, the sequence and the archive */
 };
 
 }
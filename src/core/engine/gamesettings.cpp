@@ -34,6 +34,8 @@ QDataStream &operator<<( QDataStream &s, const BotRace::Core::GameSettings_T &p
     s << p.pointsToWinKingOf;
     s << p.pushingDisabled;
     s << p.virtualRobotMode;
+    s << p.animationTimeout;
+    s << p.skipAnimations;
 
     return s;
 }
@@ -60,6 +62,8 @@ QDataStream &operator>>( QDataStream &s, BotRace::Core::GameSettings_T &p )
     s >> p.pointsToWinKingOf;
     s >> p.pushingDisabled;
     s >> p.virtualRobotMode;
+    s >> p.animationTimeout;
+    s >> p.skipAnimations;
 
     return s;
 }
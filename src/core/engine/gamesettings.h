@@ -69,6 +69,9 @@ struct GameSettings_T {
 
     bool pushingDisabled;       /**< Robots can't push each other away */
     bool virtualRobotMode;      /**< If @c true robots start as virtual robot after each death */
+
+    int animationTimeout;       /**< Seconds the server waits for slow clients to finish an animation, 0 waits forever */
+    bool skipAnimations;        /**< The server does not wait for any animation (bot only or speed games) */
 };
 
 }
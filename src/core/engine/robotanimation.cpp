@@ -0,0 +1,74 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "robotanimation.h"
+
+QDataStream &operator<<( QDataStream &s, const BotRace::Core::RobotMove_T &m )
+{
+    s << m.robot;
+    s << m.orientation;
+    s << m.x;
+    s << m.y;
+
+    return s;
+}
+
+QDataStream &operator>>( QDataStream &s, BotRace::Core::RobotMove_T &m )
+{
+    s >> m.robot;
+    s >> m.orientation;
+    s >> m.x;
+    s >> m.y;
+
+    return s;
+}
+
+QDataStream &operator<<( QDataStream &s, const BotRace::Core::RobotAnimation_T &a )
+{
+    // only the step sizes are send as list, the moves follow without
+    // an extra size field as their count is the sum of all steps
+    s << ( quint8 )a.stepSize.size();
+    foreach( quint8 size, a.stepSize ) {
+        s << size;
+    }
+
+    foreach( const BotRace::Core::RobotMove_T & move, a.moves ) {
+        s << move;
+    }
+
+    return s;
+}
+
+QDataStream &operator>>( QDataStream &s, BotRace::Core::RobotAnimation_T &a )
+{
+    quint8 steps;
+    s >> steps;
+
+    a.stepSize.resize( steps );
+    int moveCount = 0;
+    for( int i = 0; i < steps; i++ ) {
+        s >> a.stepSize[i];
+        moveCount += a.stepSize.at( i );
+    }
+
+    a.moves.resize( moveCount );
+    for( int i = 0; i < moveCount; i++ ) {
+        s >> a.moves[i];
+    }
+
+    return s;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ROBOTANIMATION_H
+#define ROBOTANIMATION_H
+
+#include <QDataStream>
+#include <QMetaType>
+#include <QVector>
+
+namespace BotRace {
+namespace Core {
+
+/**
+ * @brief One robot position/rotation change inside a sequentiel robot animation
+ *
+ * Holds only the values needed by the gui to move the robot, packed into 6 bytes
+ * so the complete phase can be send over the network without any string formatting
+ */
+struct RobotMove_T {
+    quint8 robot;        /**< The RobotType of the moved robot */
+    quint8 orientation;  /**< The Orientation of the robot after this move */
+    qint16 x;            /**< The board x position after this move (-1 if the robot fell down) */
+    qint16 y;            /**< The board y position after this move (-1 if the robot fell down) */
+};
+
+/**
+ * @brief The sequentiel robot movement of one phase
+ *
+ * Each played program card creates one step. A step holds the moves of the robot
+ * which played the card and of all robots that were pushed by it.
+ *
+ * All moves are stored in one flat list in the order they happend, @c stepSize tells
+ * how many of them belong to each step.
+ */
+struct RobotAnimation_T {
+    QVector<RobotMove_T> moves;  /**< All robot moves of the phase in playing order */
+    QVector<quint8> stepSize;    /**< Number of moves for each step, one entry per played card */
+};
+
+}
+}
+
+Q_DECLARE_METATYPE( BotRace::Core::RobotAnimation_T )
+
+QDataStream &operator<<( QDataStream &s, const BotRace::Core::RobotMove_T &m );
+QDataStream &operator>>( QDataStream &s, BotRace::Core::RobotMove_T &m );
+QDataStream &operator<<( QDataStream &s, const BotRace::Core::RobotAnimation_T &a );
+QDataStream &operator>>( QDataStream &s, BotRace::Core::RobotAnimation_T &a );
+
+#endif // ROBOTANIMATION_H
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "runtimemetrics.h"
+
+#include <QAtomicInt>
+#include <QTextStream>
+
+using namespace BotRace;
+using namespace Core;
+
+#define METRIC_HISTOGRAM_BUCKETS 22
+
+namespace {
+
+struct MetricInfo_T {
+    const char *name;
+    const char *type;
+};
+
+const MetricInfo_T counterInfo[METRIC_COUNTER_COUNT] = {
+    { "botrace_state_transitions_total", "counter" },
+    { "botrace_animation_barriers_total", "counter" },
+    { "botrace_animation_timeouts_total", "counter" },
+    { "botrace_bot_decisions_total", "counter" },
+    { "botrace_packets_sent_total", "counter" },
+    { "botrace_bytes_sent_total", "counter" },
+    { "botrace_packets_received_total", "counter" },
+    { "botrace_bytes_received_total", "counter" },
+    { "botrace_queued_packets", "gauge" },
+    { "botrace_queued_bytes", "gauge" }
+};
+
+const char *histogramNames[METRIC_HISTOGRAM_COUNT] = {
+    "botrace_programming_wait_ms",
+    "botrace_animation_barrier_ms",
+    "botrace_phase_duration_ms",
+    "botrace_round_duration_ms",
+    "botrace_bot_decision_ms",
+    "botrace_send_queue_depth_bytes"
+};
+
+/**
+ * @brief 64 bit value made of two QAtomicInt, Qt4 has no 64 bit atomics
+ *
+ * The low word is used as unsigned value, an addition that wraps it carries into the high word.
+ */
+struct Atomic64_T {
+    QAtomicInt low;
+    QAtomicInt high;
+};
+
+struct Histogram_T {
+    Atomic64_T buckets[METRIC_HISTOGRAM_BUCKETS];
+    Atomic64_T count;
+    Atomic64_T sum;
+};
+
+Atomic64_T counters[METRIC_COUNTER_COUNT];
+Histogram_T histograms[METRIC_HISTOGRAM_COUNT];
+
+void atomicAdd( Atomic64_T &atomic, int value )
+{
+    quint32 oldLow = ( quint32 )atomic.low.fetchAndAddRelaxed( value );
+    quint32 newLow = oldLow + ( quint32 )value;
+
+    if( value > 0 && newLow < oldLow ) {
+        atomic.high.fetchAndAddRelaxed( 1 );
+    }
+    else if( value < 0 && newLow > oldLow ) {
+        atomic.high.fetchAndAddRelaxed( -1 );
+    }
+}
+
+qint64 atomicValue( const Atomic64_T &atomic )
+{
+    // read again if a carry happened in between
+    int high;
+    quint32 low;
+    do {
+        high = atomic.high;
+        low = ( quint32 )( int )atomic.low;
+    } while( high != ( int )atomic.high );
+
+    return (( qint64 )high << 32 ) | low;
+}
+
+}
+
+void RuntimeMetrics::add( MetricCounter counter, int value )
+{
+    atomicAdd( counters[counter], value );
+}
+
+void RuntimeMetrics::record( MetricHistogram histogram, int value )
+{
+    value = qMax( value, 0 );
+
+    // smallest bucket with value <= 2^bucket, the last one takes everything else
+    int bucket = 0;
+    while( bucket < METRIC_HISTOGRAM_BUCKETS - 1 && ( 1 << bucket ) < value ) {
+        bucket++;
+    }
+
+    Histogram_T &h = histograms[histogram];
+    atomicAdd( h.buckets[bucket], 1 );
+    atomicAdd( h.count, 1 );
+    atomicAdd( h.sum, value );
+}
+
+qint64 RuntimeMetrics::value( MetricCounter counter )
+{
+    return atomicValue( counters[counter] );
+}
+
+QString RuntimeMetrics::dump()
+{
+    // each value is read on its own, a histogram may be one record() ahead in some of its values
+    QString text;
+    QTextStream out( &text );
+
+    for( int c = 0; c < METRIC_COUNTER_COUNT; c++ ) {
+        out << "# TYPE " << counterInfo[c].name << " " << counterInfo[c].type << "\n";
+        out << counterInfo[c].name << " " << atomicValue( counters[c] ) << "\n";
+    }
+
+    for( int h = 0; h < METRIC_HISTOGRAM_COUNT; h++ ) {
+        const char *name = histogramNames[h];
+        out << "# TYPE " << name << " histogram\n";
+
+        // the exposition format expects cumulative buckets
+        qint64 cumulative = 0;
+        for( int b = 0; b < METRIC_HISTOGRAM_BUCKETS; b++ ) {
+            cumulative += atomicValue( histograms[h].buckets[b] );
+
+            if( b < METRIC_HISTOGRAM_BUCKETS - 1 ) {
+                out << name << "_bucket{le=\"" << ( 1 << b ) << "\"} " << cumulative << "\n";
+            }
+            else {
+                out << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+            }
+        }
+
+        out << name << "_sum " << atomicValue( histograms[h].sum ) << "\n";
+        out << name << "_count " << atomicValue( histograms[h].count ) << "\n";
+    }
+
+    out.flush();
+    return text;
+}
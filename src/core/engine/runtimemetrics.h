@@ -0,0 +1,97 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNTIMEMETRICS_H
+#define RUNTIMEMETRICS_H
+
+#include <QString>
+#include <QtGlobal>
+
+namespace BotRace {
+namespace Core {
+
+/**
+ * @brief Counters of the server runtime
+ *
+ * Counters only grow, except the gauges for the send queues.
+ */
+enum MetricCounter {
+    METRIC_STATE_TRANSITIONS,       /**< States entered by all GameEngine state machines */
+    METRIC_ANIMATION_BARRIERS,      /**< AnimationStates finished */
+    METRIC_ANIMATION_TIMEOUTS,      /**< Participants that did not finish an animation in time */
+    METRIC_BOT_DECISIONS,           /**< Programs created by bots */
+    METRIC_PACKETS_SENT,            /**< Packets written to all sockets */
+    METRIC_BYTES_SENT,              /**< Bytes written to all sockets */
+    METRIC_PACKETS_RECEIVED,        /**< Packets read from all sockets */
+    METRIC_BYTES_RECEIVED,          /**< Bytes read from all sockets */
+    METRIC_QUEUED_PACKETS,          /**< Gauge: packets waiting in all send queues */
+    METRIC_QUEUED_BYTES,            /**< Gauge: bytes waiting in all send queues */
+    METRIC_COUNTER_COUNT
+};
+
+/**
+ * @brief Histograms of the server runtime
+ */
+enum MetricHistogram {
+    METRIC_PROGRAMMING_WAIT,        /**< ms from the start of the programming until all participants finished */
+    METRIC_ANIMATION_BARRIER,       /**< ms an AnimationState waited for all participants */
+    METRIC_PHASE_DURATION,          /**< ms of one of the five phases of a round */
+    METRIC_ROUND_DURATION,          /**< ms from dealing the cards until the next deal */
+    METRIC_BOT_DECISION,            /**< ms a bot needed for its program */
+    METRIC_SEND_QUEUE_DEPTH,        /**< bytes queued in a connection when a packet is added */
+    METRIC_HISTOGRAM_COUNT
+};
+
+/**
+ * @brief Thread-safe counters and histograms to see where the time of a game round goes
+ *
+ * All values are 64 bit integers updated without locks, so the send path of every thread can
+ * count its packets and the byte counters of a long running server do not wrap around. Qt4 has
+ * no 64 bit QAtomicInt, each value is a pair of QAtomicInt with a carry from the low into the
+ * high word. A value read while the carry is added may be 2^32 too small. Histograms use power of two
+ * buckets from 1 to 2^(METRIC_HISTOGRAM_BUCKETS - 2) plus one overflow bucket.
+ *
+ * dump() returns all values in the plain text exposition format used by most metric
+ * collectors.
+*/
+class RuntimeMetrics {
+public:
+    /**
+     * @brief Adds @p value to the counter
+    */
+    static void add( MetricCounter counter, int value = 1 );
+
+    /**
+     * @brief Adds @p value to the histogram, negative values are counted as 0
+    */
+    static void record( MetricHistogram histogram, int value );
+
+    /**
+     * @brief Returns the current value of the counter
+    */
+    static qint64 value( MetricCounter counter );
+
+    /**
+     * @brief Returns all counters and histograms as plain text, one value per line
+    */
+    static QString dump();
+};
+
+}
+}
+
+#endif // RUNTIMEMETRICS_H
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "scenariocache.h"
+#include "boardparser.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <QDebug>
+
+using namespace BotRace;
+using namespace Core;
+
+#define STRINGIFY(x) XSTRINGIFY(x)
+#define XSTRINGIFY(x) #x
+
+static QByteArray streamScenario( const BoardScenario_T &scenario )
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+    outstream.setVersion( QDataStream::Qt_4_6 );
+    outstream << scenario;
+
+    return data;
+}
+
+QByteArray ScenarioCache::scenarioHash( const BoardScenario_T &scenario )
+{
+    return QCryptographicHash::hash( streamScenario( scenario ), QCryptographicHash::Sha1 );
+}
+
+QByteArray ScenarioCache::encodeScenario( const BoardScenario_T &scenario )
+{
+    return qCompress( streamScenario( scenario ), 9 );
+}
+
+bool ScenarioCache::decodeScenario( const QByteArray &data, BoardScenario_T &scenario )
+{
+    QByteArray rawData = qUncompress( data );
+    if( rawData.isEmpty() ) {
+        return false;
+    }
+
+    QDataStream instream( &rawData, QIODevice::ReadOnly );
+    instream.setVersion( QDataStream::Qt_4_6 );
+    instream >> scenario;
+
+    return instream.status() == QDataStream::Ok;
+}
+
+bool ScenarioCache::loadLocalScenario( const QString &fileName, const QByteArray &hash, BoardScenario_T &scenario )
+{
+    if( fileName.isEmpty() ) {
+        return false;
+    }
+
+    BoardParser parser;
+    foreach( const QString & folder, boardFolders() ) {
+        QString path = QString( "%1/%2" ).arg( folder ).arg( fileName );
+        if( !QFile::exists( path ) ) {
+            continue;
+        }
+
+        BoardScenario_T localScenario;
+        if( parser.loadScenario( path, localScenario ) && scenarioHash( localScenario ) == hash ) {
+            scenario = localScenario;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ScenarioCache::loadCachedScenario( const QByteArray &hash, BoardScenario_T &scenario )
+{
+    QFile file( cacheFile( hash ) );
+    if( !file.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    BoardScenario_T cachedScenario;
+    if( !decodeScenario( file.readAll(), cachedScenario ) || scenarioHash( cachedScenario ) != hash ) {
+        qWarning() << "ScenarioCache::loadCachedScenario || broken cache file" << file.fileName();
+        file.remove();
+        return false;
+    }
+
+    scenario = cachedScenario;
+    return true;
+}
+
+void ScenarioCache::storeScenario( const QByteArray &hash, const QByteArray &data )
+{
+    QFileInfo info( cacheFile( hash ) );
+    QDir().mkpath( info.absolutePath() );
+
+    QFile file( info.absoluteFilePath() );
+    if( !file.open( QIODevice::WriteOnly ) ) {
+        qWarning() << "ScenarioCache::storeScenario || could not write" << file.fileName() << file.errorString();
+        return;
+    }
+
+    file.write( data );
+}
+
+QStringList ScenarioCache::boardFolders()
+{
+    // same order as in the ScenarioSelectionDialog
+    QStringList folders;
+    folders << QString( "%1/boards" ).arg( STRINGIFY( SHARE_DIR ) );
+    folders << QString( "%1/.%2/boards" ).arg( QDir::homePath() ).arg( QCoreApplication::applicationName() );
+    folders << QString( "%1/boards" ).arg( QCoreApplication::applicationDirPath() );
+
+    return folders;
+}
+
+QString ScenarioCache::cacheFile( const QByteArray &hash )
+{
+    return QString( "%1/.%2/cache/scenarios/%3.scenario" )
+           .arg( QDir::homePath() )
+           .arg( QCoreApplication::applicationName() )
+           .arg( QString::fromLatin1( hash.toHex() ) );
+}
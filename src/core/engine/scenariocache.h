@@ -0,0 +1,102 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SCENARIOCACHE_H
+#define SCENARIOCACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "board.h"
+
+namespace BotRace {
+namespace Core {
+
+/**
+ * @brief Identifies scenarios by their content and keeps received ones on disk
+ *
+ * The server only sends the hash of the used scenario. The client tries to find a scenario
+ * with the same hash in its own boards folders or in the cache. Only if both fail, the
+ * compressed scenario is requested from the server and stored in the cache afterwards.
+ *
+ * The cache is located in $HOME/.BotRace/cache/scenarios, one file per hash.
+*/
+class ScenarioCache {
+public:
+    /**
+     * @brief Calculates the content hash of a scenario
+     *
+     * The hash is the SHA1 sum of the network encoding, so two scenarios with the same
+     * boards and special points get the same hash, independent of their file location.
+     *
+     * @param scenario the scenario
+     * @return the binary hash
+    */
+    static QByteArray scenarioHash( const BoardScenario_T &scenario );
+
+    /**
+     * @brief Returns the compressed network encoding of the scenario
+    */
+    static QByteArray encodeScenario( const BoardScenario_T &scenario );
+
+    /**
+     * @brief Restores a scenario from the output of encodeScenario()
+     *
+     * @return @c false if the data could not be uncompressed
+    */
+    static bool decodeScenario( const QByteArray &data, BoardScenario_T &scenario );
+
+    /**
+     * @brief Searches the local boards folders for a scenario with the given hash
+     *
+     * Only the scenario file with the same name as the one used on the server is checked.
+     *
+     * @param fileName file name of the scenario on the server without path
+     * @param hash the expected content hash
+     * @param scenario the loaded scenario
+     * @return @c true if a matching scenario was found
+    */
+    static bool loadLocalScenario( const QString &fileName, const QByteArray &hash, BoardScenario_T &scenario );
+
+    /**
+     * @brief Loads a scenario received earlier from the cache
+     *
+     * @param hash the content hash
+     * @param scenario the loaded scenario
+     * @return @c true if the scenario was in the cache and matched the hash
+    */
+    static bool loadCachedScenario( const QByteArray &hash, BoardScenario_T &scenario );
+
+    /**
+     * @brief Stores the compressed encoding of a received scenario in the cache
+     *
+     * @param hash the content hash
+     * @param data the output of encodeScenario()
+    */
+    static void storeScenario( const QByteArray &hash, const QByteArray &data );
+
+private:
+    static QStringList boardFolders();
+    static QString cacheFile( const QByteArray &hash );
+};
+
+}
+}
+
+#endif // SCENARIOCACHE_H
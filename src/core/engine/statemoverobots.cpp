@@ -27,8 +27,7 @@
 #include "carddeck.h"
 #include "boardmanager.h"
 #include "engine/gamelogandchat.h"
-
-#include <QStringList>
+#include "robotanimation.h"
 
 #include <QVariant>
 #include <QDebug>
@@ -128,7 +127,7 @@ void StateMoveRobots::onEntry( QEvent *event )
     // generate a strip with allrobot positions/rotations after each played card
     // allows the reconstruct sequentiel robot movement with priority in
     // detail without just applying the end result to an animator
-    QStringList moveAnimationSteps;
+    RobotAnimation_T moveAnimationSteps;
 
     //temp save all robot rotations / positions
     QList<tempRobotPosition_T> oldRobotPos;
@@ -251,34 +250,31 @@ void StateMoveRobots::onEntry( QEvent *event )
             }
         }
 
-        QString animationStep;
+        quint8 movesInStep = 0;
 
         // creates the animation for this round
         // this way each robot moves exactly as it should do including the right pushing order
         // the gui can than simply use QProperty animataion and won't start to move robots sideways
-        foreach( Robot * r, m_engine->getRobots() ) {
-            for( int i = 0; i < oldRobotPos.size(); i++ ) {
-                tempRobotPosition_T oldR = oldRobotPos.at( i );
-                if( oldR.robot == r ) {
-                    if( oldR.oldRot != r->getRotation()
-                        || oldR.oldPos != r->getPosition() ) {
-                        animationStep.append( QString( "%1;%2;%3,%4|" )
-                                              .arg( r->getRobotType() )
-                                              .arg( r->getRotation() )
-                                              .arg( r->getPosition().x() )
-                                              .arg( r->getPosition().y() ) );
-
-                        oldR.oldRot = r->getRotation();
-                        oldR.oldPos = r->getPosition();
-                        oldRobotPos.replace( i, oldR );
-                        break;
-                    }
-                }
+        for( int i = 0; i < oldRobotPos.size(); i++ ) {
+            tempRobotPosition_T oldR = oldRobotPos.at( i );
+            Robot *r = oldR.robot;
+            if( oldR.oldRot != r->getRotation()
+                || oldR.oldPos != r->getPosition() ) {
+                RobotMove_T move;
+                move.robot = r->getRobotType();
+                move.orientation = r->getRotation();
+                move.x = r->getPosition().x();
+                move.y = r->getPosition().y();
+                moveAnimationSteps.moves.append( move );
+                movesInStep++;
+
+                oldR.oldRot = r->getRotation();
+                oldR.oldPos = r->getPosition();
+                oldRobotPos.replace( i, oldR );
             }
         }
 
-        animationStep.chop( 1 ); // remove last | from list
-        moveAnimationSteps.append( animationStep );
+        moveAnimationSteps.stepSize.append( movesInStep );
 
         //remove the first entry, up to now we did all we can do with it
         playerCardlist.pop_front();
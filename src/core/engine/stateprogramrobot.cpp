@@ -21,6 +21,7 @@
 #include "participant.h"
 #include "carddeck.h"
 #include "gamelogandchat.h"
+#include "runtimemetrics.h"
 
 #include <QVariant>
 #include <QList>
@@ -41,6 +42,7 @@ void StateProgramRobot::onEntry( QEvent *event )
 {
     Q_UNUSED( event );
     m_finishedPlayers.clear();
+    m_programmingTime.start();
 
     //notify all players that the programming phase is started
     foreach( Participant * p, m_engine->getParticipants() ) {
@@ -77,6 +79,7 @@ void StateProgramRobot::playerFinished()
     int notFinishedPlayers = m_engine->getParticipants().size() - m_finishedPlayers.size();
 
     if( notFinishedPlayers == 0 ) {
+        RuntimeMetrics::record( METRIC_PROGRAMMING_WAIT, m_programmingTime.elapsed() );
         emit finished();
     }
     else {
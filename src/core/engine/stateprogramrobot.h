@@ -20,6 +20,7 @@
 
 #include <QState>
 #include <QList>
+#include <QTime>
 
 namespace BotRace {
 namespace Core {
@@ -64,6 +65,7 @@ protected:
 private:
     GameEngine *m_engine;                   /**< Pointer to the GameEngine */
     QList<Participant *> m_finishedPlayers; /**< List of players who already finished programming */
+    QTime m_programmingTime;                /**< Time since the programming was started */
 };
 
 }
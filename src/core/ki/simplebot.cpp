@@ -20,6 +20,9 @@
 #include "engine/gameengine.h"
 #include "engine/carddeck.h"
 #include "engine/participant.h"
+#include "engine/runtimemetrics.h"
+
+#include <QTime>
 
 #include <QDebug>
 
@@ -47,9 +50,9 @@ SimpleBot::SimpleBot( GameEngine *ge ) :
     }
     setName( name );
 
-    connect( this, SIGNAL( animateRobotMovement( QStringList ) ), this, SLOT( animationFinished() ) );
-    connect( this, SIGNAL( animateRobotMovement() ), this, SLOT( animationFinished() ) );
-    connect( this, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ), this, SLOT( animationFinished() ) );
+    connect( this, SIGNAL( animateRobotMovement( BotRace::Core::RobotAnimation_T ) ), this, SLOT( acknowledgeAnimation() ) );
+    connect( this, SIGNAL( animateRobotMovement() ), this, SLOT( acknowledgeAnimation() ) );
+    connect( this, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ), this, SLOT( acknowledgeAnimation() ) );
 
     qDebug() << "new Simplebot created";
 }
@@ -76,12 +79,18 @@ GameLogAndChat *SimpleBot::getGameLogAndChat()
 
 void SimpleBot::startProgramming()
 {
+    QTime decisionTime;
+    decisionTime.start();
+
     getDeck()->moveCardToProgram( 1, 1 );
     getDeck()->moveCardToProgram( 2, 2 );
     getDeck()->moveCardToProgram( 3, 3 );
     getDeck()->moveCardToProgram( 4, 4 );
     getDeck()->moveCardToProgram( 5, 5 );
 
+    RuntimeMetrics::add( METRIC_BOT_DECISIONS );
+    RuntimeMetrics::record( METRIC_BOT_DECISION, decisionTime.elapsed() );
+
     programmingFinished();
 }
 
@@ -113,7 +122,13 @@ void SimpleBot::powerDownRobot()
     emit robotPoweredDown( powerDownPossible );
 }
 
-void SimpleBot::animationFinished()
+void SimpleBot::animationFinished( quint32 barrier )
+{
+    m_gameEngine->clientAnimationFinished( this, barrier );
+}
+
+void SimpleBot::acknowledgeAnimation()
 {
-    m_gameEngine->clientAnimationFinished( this );
+    // bots answer at once, so the current barrier is the one of the animation
+    animationFinished( getAnimationBarrier() );
 }
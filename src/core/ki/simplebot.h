@@ -40,12 +40,15 @@ public slots:
     void startProgramming();
     void programmingFinished();
     void powerDownRobot();
-    void animationFinished();
+    void animationFinished( quint32 barrier );
     void selectStartingPoint( QList<QPoint> allowedStartingPoints );
     void selectStartingOrientation( QList<Orientation> allowedOrientations );
 
     void gameOver( Participant *p );
 
+private slots:
+    void acknowledgeAnimation();
+
 private:
     GameEngine *m_gameEngine;
 
@@ -22,6 +22,7 @@
 #include "engine/participant.h"
 #include "engine/robot.h"
 #include "engine/coreconst.h"
+#include "engine/runtimemetrics.h"
 
 #include <QFuture>
 #include <QFutureWatcher>
@@ -63,9 +64,9 @@ TreeDecisionBot::TreeDecisionBot(GameEngine *ge ) :
 //    narf++;
     setName( name );
 
-    connect( this, SIGNAL( animateRobotMovement( QStringList ) ), this, SLOT( animationFinished() ) );
-    connect( this, SIGNAL( animateRobotMovement() ), this, SLOT( animationFinished() ) );
-    connect( this, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ), this, SLOT( animationFinished() ) );
+    connect( this, SIGNAL( animateRobotMovement( BotRace::Core::RobotAnimation_T ) ), this, SLOT( acknowledgeAnimation() ) );
+    connect( this, SIGNAL( animateRobotMovement() ), this, SLOT( acknowledgeAnimation() ) );
+    connect( this, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ), this, SLOT( acknowledgeAnimation() ) );
     connect(&m_futureWatcher, SIGNAL(finished()), this, SLOT(finishedCardSequenceCalculation()));
 
     qDebug() << "new TreeDecisionBot created";
@@ -101,6 +102,8 @@ GameLogAndChat *TreeDecisionBot::getGameLogAndChat()
 
 void TreeDecisionBot::startProgramming()
 {
+    m_decisionTime.start();
+
     if(getPlayer()->getDamageToken() > 7) {
         powerDownRobot();
     }
@@ -202,6 +205,9 @@ void TreeDecisionBot::finishedCardSequenceCalculation()
         }
     }
 
+    RuntimeMetrics::add( METRIC_BOT_DECISIONS );
+    RuntimeMetrics::record( METRIC_BOT_DECISION, m_decisionTime.elapsed() );
+
     programmingFinished();
     m_usefullSequences.clear();
 }
@@ -235,9 +241,15 @@ void TreeDecisionBot::powerDownRobot()
     emit robotPoweredDown( powerDownPossible );
 }
 
-void TreeDecisionBot::animationFinished()
+void TreeDecisionBot::animationFinished( quint32 barrier )
+{
+    m_gameEngine->clientAnimationFinished( this, barrier );
+}
+
+void TreeDecisionBot::acknowledgeAnimation()
 {
-    m_gameEngine->clientAnimationFinished( this );
+    // bots answer at once, so the current barrier is the one of the animation
+    animationFinished( getAnimationBarrier() );
 }
 
 bool TreeDecisionBot::checkNextCardInSequence(const QString &sequence, const QString &remainingCards, const RoboSimulator::RobotSimResult &lastSimResults)
@@ -23,6 +23,7 @@
 #include "robosimulator.h"
 
 #include <QFutureWatcher>
+#include <QTime>
 
 namespace BotRace {
 namespace Core {
@@ -71,7 +72,7 @@ public slots:
     void startProgramming();
     void programmingFinished();
     void powerDownRobot();
-    void animationFinished();
+    void animationFinished( quint32 barrier );
     void selectStartingPoint( QList<QPoint> allowedStartingPoints );
     void selectStartingOrientation( QList<Orientation> allowedOrientations );
 
@@ -92,12 +93,14 @@ private:
     int getDistanceToTarget( const QPoint &robotPosition );
 
 private slots:
+    void acknowledgeAnimation();
     void finishedCardSequenceCalculation();
 private:
     GameEngine *m_gameEngine;
     QList<CardSequenceDecision> m_usefullSequences;
     RoboSimulator *m_simulator;
     QFutureWatcher<void> m_futureWatcher;
+    QTime m_decisionTime;
 
     Participant *m_deathMatchTarget;
 
@@ -17,8 +17,11 @@
 
 #include "connection.h"
 
+#include "engine/runtimemetrics.h"
+
 #include <QTcpSocket>
 #include <QTime>
+#include <QThread>
 
 #include <QIODevice>
 #include <QDataStream>
@@ -29,13 +32,21 @@ using namespace Network;
 Connection::Connection( QTcpSocket *socket ) :
     QObject( 0 ),
     m_socket( socket ),
-    m_blockSize( 0 )
+    m_blockSize( 0 ),
+    m_readingPaused( false ),
+    m_queuedPackets( 0 ),
+    m_queuedBytes( 0 )
 {
     qsrand( QTime::currentTime().msec() );
     m_uid = QUuid::createUuid();
+
+    // the socket moves with the connection to the thread of its game table
+    m_socket->setParent( this );
+
     connect( m_socket, SIGNAL( readyRead() ), this, SLOT( onReadyRead() ) );
     connect( m_socket, SIGNAL( disconnected() ), this, SLOT( onDisconnected() ) );
     connect( m_socket, SIGNAL( disconnected() ), m_socket, SLOT( deleteLater() ) );
+    connect( m_socket, SIGNAL( bytesWritten( qint64 ) ), this, SLOT( flushSendQueue() ) );
 }
 
 void Connection::setUid( QUuid id )
@@ -48,35 +59,106 @@ QUuid Connection::getUuid()
     return m_uid;
 }
 
-bool Connection::sendData( DataType_T dataType, const QByteArray data )
+QByteArray Connection::createPacket( DataType_T dataType, const QByteArray &data )
 {
-    if( !m_socket ) {
-        return false;
-    }
-
-    QDataStream out( m_socket );
+    QByteArray packet;
+    QDataStream out( &packet, QIODevice::WriteOnly );
     out.setVersion( QDataStream::Qt_4_6 );
     out << quint16( data.size() + sizeof( quint16 ) );
     out << quint16( dataType );
     out << data;
 
-    return isOk();
+    return packet;
+}
+
+QByteArray Connection::createPacket( DataType_T dataType )
+{
+    QByteArray packet;
+    QDataStream out( &packet, QIODevice::WriteOnly );
+    out.setVersion( QDataStream::Qt_4_6 );
+    out << ( quint16 )sizeof( quint16 );
+    out << ( quint16 )( dataType );
+
+    return packet;
+}
+
+bool Connection::sendData( DataType_T dataType, const QByteArray data )
+{
+    return sendPacket( createPacket( dataType, data ) );
 }
 
 bool Connection::sendSignal( DataType_T dataType )
+{
+    return sendPacket( createPacket( dataType ) );
+}
+
+bool Connection::sendPacket( const QByteArray &packet )
+{
+    // counted at once, so other threads see the packet before the event loop enqueues it
+    m_queuedPackets.fetchAndAddOrdered( 1 );
+    int queuedBytes = m_queuedBytes.fetchAndAddOrdered( packet.size() ) + packet.size();
+
+    Core::RuntimeMetrics::add( Core::METRIC_QUEUED_PACKETS );
+    Core::RuntimeMetrics::add( Core::METRIC_QUEUED_BYTES, packet.size() );
+    Core::RuntimeMetrics::record( Core::METRIC_SEND_QUEUE_DEPTH, queuedBytes );
+
+    // the socket may only be used in its own thread
+    if( QThread::currentThread() != thread() ) {
+        QMetaObject::invokeMethod( this, "enqueuePacket", Qt::QueuedConnection, Q_ARG( QByteArray, packet ) );
+        return true;
+    }
+
+    return enqueuePacket( packet );
+}
+
+bool Connection::enqueuePacket( const QByteArray &packet )
 {
     if( !m_socket ) {
+        packetDequeued( packet.size() );
         return false;
     }
 
-    QDataStream out( m_socket );
-    out.setVersion( QDataStream::Qt_4_6 );
-    out << ( quint16 )sizeof( quint16 );
-    out << ( quint16 )( dataType );
+    m_sendQueue.enqueue( packet );
+    flushSendQueue();
 
     return isOk();
 }
 
+void Connection::packetDequeued( int size )
+{
+    m_queuedPackets.fetchAndAddOrdered( -1 );
+    m_queuedBytes.fetchAndAddOrdered( -size );
+
+    Core::RuntimeMetrics::add( Core::METRIC_QUEUED_PACKETS, -1 );
+    Core::RuntimeMetrics::add( Core::METRIC_QUEUED_BYTES, -size );
+}
+
+int Connection::queuedPackets() const
+{
+    return m_queuedPackets;
+}
+
+qint64 Connection::queuedBytes() const
+{
+    return m_queuedBytes;
+}
+
+void Connection::flushSendQueue()
+{
+    if( !m_socket ) {
+        return;
+    }
+
+    while( !m_sendQueue.isEmpty() && m_socket->bytesToWrite() < SOCKET_WRITE_LIMIT ) {
+        QByteArray packet = m_sendQueue.dequeue();
+        m_socket->write( packet );
+
+        packetDequeued( packet.size() );
+        Core::RuntimeMetrics::add( Core::METRIC_PACKETS_SENT );
+        Core::RuntimeMetrics::add( Core::METRIC_BYTES_SENT, packet.size() );
+    }
+}
+
 bool Connection::isOk()
 {
     if( !m_socket ) {
@@ -88,11 +170,32 @@ bool Connection::isOk()
 
 void Connection::disconnect()
 {
+    if( !m_socket ) {
+        return;
+    }
+
     m_socket->disconnectFromHost();
 }
 
+void Connection::pauseReading()
+{
+    m_readingPaused = true;
+}
+
+void Connection::resumeReading()
+{
+    m_readingPaused = false;
+
+    // the socket does not signal the bytes it already buffered again
+    QMetaObject::invokeMethod( this, "onReadyRead", Qt::QueuedConnection );
+}
+
 void Connection::onReadyRead()
 {
+    if( m_readingPaused || !m_socket ) {
+        return;
+    }
+
     QDataStream in( m_socket );
     in.setVersion( QDataStream::Qt_4_6 );
 
@@ -116,6 +219,9 @@ void Connection::onReadyRead()
 
     int dataSize = m_blockSize - sizeof( quint16 );
 
+    Core::RuntimeMetrics::add( Core::METRIC_PACKETS_RECEIVED );
+    Core::RuntimeMetrics::add( Core::METRIC_BYTES_RECEIVED, m_blockSize + ( int )sizeof( quint16 ) );
+
     m_blockSize = 0;
 
     if( dataSize != 0 ) {
@@ -127,13 +233,21 @@ void Connection::onReadyRead()
         emit dataReceived( dataType, QByteArray() );
     }
 
-
-    if( !in.atEnd() ) {
+    // a receiver of the packet may have paused the connection to move it to another thread
+    if( !m_readingPaused && m_socket && !in.atEnd() ) {
         onReadyRead();
     }
 }
 
 void Connection::onDisconnected()
 {
+    // the socket deletes itself, all further packets are dropped
+    m_socket = 0;
+
+    // packets still on the way from other threads are removed when they arrive
+    while( !m_sendQueue.isEmpty() ) {
+        packetDequeued( m_sendQueue.dequeue().size() );
+    }
+
     emit disconnected();
 }
@@ -20,7 +20,9 @@
 
 #include <QObject>
 #include <QByteArray>
+#include <QQueue>
 #include <QUuid>
+#include <QAtomicInt>
 
 class QTcpSocket;
 
@@ -63,6 +65,9 @@ enum DataType_T {
     DATA_SCENARIO_CHANGED,
     DATA_SELECT_STARTPOINT,
     DATA_SELECT_STARTORIENTATION,
+    DATA_SCENARIO_REQUEST,      // client does not know the scenario hash and asks for the scenario
+    DATA_SCENARIO_DATA,         // one chunk of the compressed scenario
+    DATA_GAME_SNAPSHOT,         // full game state for a client that rejoined a running game
     SIGNAL_START_PROGRAMMING = 110,
     SIGNAL_GAME_STARTED,
     SIGNAL_ANIMATE_ROBOTS,
@@ -71,17 +76,69 @@ enum DataType_T {
     DATA_ANIMATE_ELEMENTS, //graphic element in a specific phase
     DATA_PHASE_CHANGED,
     DATA_KINGOFFLAG_CHANGED,
-    SIGNAL_ANIMATION_FINISHED,
+    DATA_ANIMATION_FINISHED,    // client finished the animations of the barrier id it received last
+    SIGNAL_SKIP_ANIMATIONS, // server stopped waiting, finish all running animations at once
+    DATA_ANIMATION_BARRIER,     // id of the animation barrier the following animations belong to
 
     DATA_GAME_OVER = 150,
 
     //general
     DATA_LOG_AND_CHAT_ENTRY = 200,
-    DATA_LOG_AND_CHAT_HISTORY,
+    DATA_LOG_AND_CHAT_HISTORY,          // one page of log entries after a requested sequence number
+    DATA_LOG_AND_CHAT_HISTORY_REQUEST,  // client asks for the entries after a sequence number
+    DATA_PROTOCOL_MISMATCH,             // server refuses the handshake, carries the protocol version of the server
 
     INVALID
 };
 
+/**
+ * @brief Max number of bytes handed to the socket before further packets are kept in the send queue
+ */
+const qint64 SOCKET_WRITE_LIMIT = 64 * 1024;
+
+/**
+ * @brief Max number of bytes of the compressed scenario send with one DATA_SCENARIO_DATA message
+ */
+const int SCENARIO_CHUNK_SIZE = 32 * 1024;
+
+/**
+ * @brief Time in ms the client waits for the next DATA_SCENARIO_DATA before it gives up the download
+ */
+const int SCENARIO_REQUEST_TIMEOUT = 15000;
+
+/**
+ * @brief Time in ms between two attempts of the client to reconnect to a running game
+ */
+const int RECONNECT_INTERVAL = 2000;
+
+/**
+ * @brief Number of reconnect attempts before the client gives up
+ */
+const int RECONNECT_ATTEMPTS = 15;
+
+/**
+ * @brief Queued bytes of a spectator connection before it only receives snapshots instead of each event
+ */
+const qint64 SPECTATOR_QUEUE_LIMIT = 256 * 1024;
+
+/**
+ * @brief Time in ms between two snapshots for spectators which could not keep up with the game
+ */
+const int SPECTATOR_SNAPSHOT_INTERVAL = 1000;
+
+/**
+ * @brief Version of the message format, send by both sides with the HANDSHAKE
+ *
+ * Raise it with every change of a message, peers with another version are refused.
+ */
+const quint32 PROTOCOL_VERSION = 2;
+
+/**
+ * @brief Framed message connection on top of a QTcpSocket
+ *
+ * The connection takes ownership of the socket, so both can be moved to another thread together.
+ * Packets enqueued from any other thread are passed to the thread of the connection.
+ */
 class Connection : public QObject {
     Q_OBJECT
 public:
@@ -91,11 +148,73 @@ public:
     void setUid( QUuid id );
     QUuid getUuid();
 
+    /**
+     * @brief Creates the complete network packet for a data message
+     *
+     * The packet can be send to any number of connections via sendPacket()
+     * without encoding the same data again for each of them.
+     *
+     * @param dataType the type of the message
+     * @param data the already serialized content of the message
+     * @return the framed packet as it is written to the socket
+     */
+    static QByteArray createPacket( DataType_T dataType, const QByteArray &data );
+
+    /**
+     * @brief Creates the complete network packet for a signal without any content
+     *
+     * @param dataType the type of the signal
+     * @return the framed packet as it is written to the socket
+     */
+    static QByteArray createPacket( DataType_T dataType );
+
     bool sendData( DataType_T dataType, const QByteArray data );
     bool sendSignal( DataType_T dataType );
+
+    /**
+     * @brief Enqueues a packet created by createPacket()
+     *
+     * The packet data is implicitly shared, so the same event enqueued to several
+     * connections is only stored once in memory.
+     *
+     * When called from another thread the packet is enqueued later by the event loop of the
+     * connection and @c true is returned. It is counted by queuedPackets() and queuedBytes() at once.
+     *
+     * @param packet the framed packet
+     */
+    bool sendPacket( const QByteArray &packet );
+
+    /**
+     * @brief Returns the number of packets waiting in the send queue
+     *
+     * Can be called from any thread, packets sent from other threads are counted before
+     * they reach the queue.
+     */
+    int queuedPackets() const;
+
+    /**
+     * @brief Returns the number of bytes waiting in the send queue
+     *
+     * Can be called from any thread, see queuedPackets().
+     */
+    qint64 queuedBytes() const;
+
     bool isOk();
     void disconnect();
 
+    /**
+     * @brief Keeps all further packets in the socket until resumeReading() is called
+     *
+     * Used before the connection is moved to another thread, so no packet is read
+     * while the new owner is not connected yet.
+     */
+    void pauseReading();
+
+    /**
+     * @brief Handles the packets kept since pauseReading(), call in the thread of the connection
+     */
+    void resumeReading();
+
 signals:
     void dataReceived( BotRace::Network::DataType_T dataType, QByteArray data );
     void disconnected();
@@ -104,10 +223,30 @@ private slots:
     void onReadyRead();
     void onDisconnected();
 
+    /**
+     * @brief Moves queued packets to the socket until SOCKET_WRITE_LIMIT is reached
+     */
+    void flushSendQueue();
+
 private:
+    /**
+     * @brief Adds a packet counted by sendPacket() to the send queue, only called in the thread of the connection
+     */
+    Q_INVOKABLE bool enqueuePacket( const QByteArray &packet );
+
+    /**
+     * @brief Removes a packet that left the send queue from queuedPackets() and queuedBytes()
+     */
+    void packetDequeued( int size );
+
     QTcpSocket *m_socket;
     QUuid m_uid;
     quint16 m_blockSize;
+    bool m_readingPaused;            /**< Received packets stay in the socket, see pauseReading() */
+
+    QQueue<QByteArray> m_sendQueue;  /**< Packets not yet handed to the socket */
+    QAtomicInt m_queuedPackets;      /**< Number of packets in m_sendQueue or on the way to it, read by other threads */
+    QAtomicInt m_queuedBytes;        /**< Number of bytes in m_sendQueue or on the way to it, read by other threads */
 };
 
 }
@@ -18,23 +18,93 @@
 #include "boardrenderer.h"
 
 #include "tiletheme.h"
+#include "paintprofiler.h"
 
 #include "../engine/boardmanager.h"
 
 #include <QPainter>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QVector>
+#include <qmath.h>
 
 #include <QDebug>
 
 using namespace BotRace;
 using namespace Renderer;
 
+namespace BotRace {
+namespace Renderer {
+
+/**
+ * @brief Draws one chunk of the basic board in the board render pool
+ */
+class BoardChunkJob : public QRunnable {
+public:
+    BoardChunkJob( BoardRenderer *renderer, const QRect &chunkRect, int detailLevel, quint64 key, quint32 generation ) :
+        m_renderer( renderer ), m_chunkRect( chunkRect ), m_detailLevel( detailLevel ), m_key( key ), m_generation( generation )
+    {
+    }
+
+    void run()
+    {
+        QImage chunkImage = m_renderer->drawBoardChunk( m_chunkRect, m_detailLevel );
+
+        // queued to the BoardTheme in the gui thread
+        emit m_renderer->boardChunkReady( m_key, m_generation, chunkImage );
+    }
+
+private:
+    BoardRenderer *m_renderer;
+    QRect m_chunkRect;
+    int m_detailLevel;
+    quint64 m_key;
+    quint32 m_generation;
+};
+
+/**
+ * @brief Draws one strip of the phase layer in the board render pool
+ */
+class PhaseLayerStripJob : public QRunnable {
+public:
+    PhaseLayerStripJob( BoardRenderer *renderer, const QRect &stripRect, QImage *stripImage, QSemaphore *done ) :
+        m_renderer( renderer ), m_stripRect( stripRect ), m_stripImage( stripImage ), m_done( done )
+    {
+    }
+
+    void run()
+    {
+        *m_stripImage = m_renderer->drawPhaseLayerStrip( m_stripRect );
+        m_done->release();
+    }
+
+private:
+    BoardRenderer *m_renderer;
+    QRect m_stripRect;
+    QImage *m_stripImage;       /**< Owned by the waiting BoardRenderer thread */
+    QSemaphore *m_done;
+};
+
+}
+}
+
 BoardRenderer::BoardRenderer( TileTheme *tileTheme ) :
     QThread(),
     m_tileTheme( tileTheme ),
-    m_scenario( 0 )
+    m_scenario( 0 ),
+    m_abortRendering( false )
 {
-    qRegisterMetaType<BoardCache> ( "BoardCache" );
     qRegisterMetaType<BotRace::Renderer::AnimationType> ( "BotRace::Renderer::AnimationType" );
+    qRegisterMetaType<quint64> ( "quint64" );
+    qRegisterMetaType<quint32> ( "quint32" );
+}
+
+BoardRenderer::~BoardRenderer()
+{
+    // the chunk jobs and strips use this object until they are done
+    abort();
+    wait();
+    m_renderPool.waitForDone();
 }
 
 void BoardRenderer::setBoardScenario( Core::BoardManager *scenario )
@@ -44,7 +114,11 @@ void BoardRenderer::setBoardScenario( Core::BoardManager *scenario )
 
 void BoardRenderer::run()
 {
+    ProfileTimer profileTimer( PROFILE_BOARD_RENDERER );
+
+    m_mutex.lock();
     m_abortRendering = false;
+    m_mutex.unlock();
 
     if( !m_scenario ) {
         qDebug() << "BoardRenderer::run() :: no scenario available";
@@ -63,50 +137,77 @@ void BoardRenderer::run()
     }
     m_mutex.unlock();
 
-    bool abort = false;
+    drawPhaseActiveLayer();
+}
 
-    for(int i=0;i<5;i++) {
-        abort = drawBaseBoard(i);
-        if( abort ) { return; }
-    }
+QSize BoardRenderer::tileSize() const
+{
+    // get the size of 1 tile
+    return m_tileTheme->spriteSize( m_tileTheme->tileId( Core::FLOOR_NORMAL ), Core::NORTH );
+}
 
-    abort = drawPhaseActiveLayer();
-    if( abort ) {
-        return;
+QSize BoardRenderer::boardSize() const
+{
+    if( !m_scenario ) {
+        return QSize();
     }
 
-    QSettings settings;
-    bool useAnimations = settings.value( "game/use_animation", false ).toBool();
-    if( !useAnimations ) {
-        return;
-    }
+    QSize tile = tileSize();
 
-    for(int a=0; a < MAX_ANIMATIONS; a++) {
-        abort = drawAnimatedFloorBoard( (AnimationType)a );
-        if( abort ) {
-            return;
-        }
+    QSize boardSize;
+    boardSize.rwidth() = m_scenario->getBoardSize().width() * tile.width();
+    boardSize.rheight() = m_scenario->getBoardSize().height() * tile.height();
+
+    return boardSize;
+}
+
+QRect BoardRenderer::tilesInChunk( const QRect &chunkRect ) const
+{
+    QSize tile = tileSize();
+    if( tile.isEmpty() || !m_scenario ) {
+        return QRect();
     }
+
+    // each tile is drawn 1 pixel bigger, so the tiles left/above reach into the chunk
+    int left = qMax( 0, ( chunkRect.left() - 1 ) / tile.width() );
+    int top = qMax( 0, ( chunkRect.top() - 1 ) / tile.height() );
+    int right = qMin( m_scenario->getBoardSize().width() - 1, chunkRect.right() / tile.width() );
+    int bottom = qMin( m_scenario->getBoardSize().height() - 1, chunkRect.bottom() / tile.height() );
+
+    return QRect( QPoint( left, top ), QPoint( right, bottom ) );
 }
 
-bool BoardRenderer::drawBaseBoard(int phase)
+bool BoardRenderer::isFlat( int detailLevel ) const
 {
-    // get the size of 1 tile
-    QImage tileForSize = m_tileTheme->getTile( Core::FLOOR_NORMAL, Core::NORTH );
-    QSize tileSize = tileForSize.size();
+    return ( tileSize().width() >> detailLevel ) < BOARD_FLAT_TILE_SIZE;
+}
 
-    QSize boardSize;
-    boardSize.rwidth() = m_scenario->getBoardSize().width() * tileSize.width();
-    boardSize.rheight() = m_scenario->getBoardSize().height() * tileSize.height();
+QImage BoardRenderer::drawBoardChunk( const QRect &chunkRect, int detailLevel ) const
+{
+    ProfileTimer profileTimer( PROFILE_BOARD_RENDERER );
 
-    QImage boardImage( boardSize, QImage::Format_ARGB32_Premultiplied );
+    // all other phases are drawn as phaseSprites() on top
+    const int phase = 0;
+
+    QSize tileSize = this->tileSize();
+    QRect tiles = tilesInChunk( chunkRect );
+
+    detailLevel = qBound( 0, detailLevel, MAX_BOARD_DETAIL_LEVEL );
+    qreal scale = 1.0 / ( 1 << detailLevel );
+    bool flat = isFlat( detailLevel );
+
+    QSize imageSize( qMax( 1, qCeil( chunkRect.width() * scale ) ), qMax( 1, qCeil( chunkRect.height() * scale ) ) );
+    QImage boardImage( imageSize, QImage::Format_ARGB32_Premultiplied );
     boardImage.fill( Qt::transparent );
 
     QPainter boardPainter;
     boardPainter.begin( &boardImage );
+    boardPainter.setRenderHint( QPainter::SmoothPixmapTransform, detailLevel > 0 );
+    boardPainter.scale( scale, scale );
+    boardPainter.translate( -chunkRect.topLeft() );
 
-    for( int x = 0; x < m_scenario->getBoardSize().width(); x++ ) {
-        for( int y = 0; y < m_scenario->getBoardSize().height(); y++ ) {
+    for( int x = tiles.left(); x <= tiles.right(); x++ ) {
+        for( int y = tiles.top(); y <= tiles.bottom(); y++ ) {
             Core::BoardTile_T tile = m_scenario->getBoardTile( QPoint( x, y ) );
 
             if( tile.type == Core::FLOOR_ERROR ) {
@@ -114,114 +215,141 @@ bool BoardRenderer::drawBaseBoard(int phase)
                 continue;
             }
 
-            QImage drawTile = m_tileTheme->getTile( tile.type, tile.alignment, 0, tile.floorActiveInPhase.at(phase) );
+            if( flat ) {
+                drawFlatTile( &boardPainter, QRectF( x * tileSize.width(), y * tileSize.height(), tileSize.width(), tileSize.height() ), tile, phase );
+                continue;
+            }
+
             QRectF drawRect;
             drawRect.setX( x * tileSize.width() );
             drawRect.setY( y * tileSize.height() );
             drawRect.setWidth( tileSize.width() + 1 );
             drawRect.setHeight( tileSize.height() + 1 );
 
-            boardPainter.drawImage( drawRect, drawTile );
+            m_tileTheme->drawSprite( &boardPainter, drawRect, m_tileTheme->tileId( tile.type, tile.floorActiveInPhase.at( phase ) ), tile.alignment );
 
             if( tile.northWall != Core::WALL_NONE || tile.northWall != Core::WALL_ERROR ) {
-                QImage drawTile = m_tileTheme->getTile( tile.northWall, Core::NORTH, 0, tile.northWallActiveInPhase.at(phase) );
-                boardPainter.drawImage( drawRect, drawTile );
+                m_tileTheme->drawSprite( &boardPainter, drawRect, m_tileTheme->tileId( tile.northWall, tile.northWallActiveInPhase.at( phase ) ), Core::NORTH );
             }
             if( tile.eastWall != Core::WALL_NONE || tile.eastWall != Core::WALL_ERROR ) {
-                QImage drawTile = m_tileTheme->getTile( tile.eastWall, Core::EAST, 0, tile.eastWallActiveInPhase.at(phase) );
-                boardPainter.drawImage( drawRect, drawTile );
+                m_tileTheme->drawSprite( &boardPainter, drawRect, m_tileTheme->tileId( tile.eastWall, tile.eastWallActiveInPhase.at( phase ) ), Core::EAST );
             }
             if( tile.southWall != Core::WALL_NONE || tile.southWall != Core::WALL_ERROR ) {
-                QImage drawTile = m_tileTheme->getTile( tile.southWall, Core::SOUTH, 0, tile.southWallActiveInPhase.at(phase) );
-                boardPainter.drawImage( drawRect, drawTile );
+                m_tileTheme->drawSprite( &boardPainter, drawRect, m_tileTheme->tileId( tile.southWall, tile.southWallActiveInPhase.at( phase ) ), Core::SOUTH );
             }
             if( tile.westWall != Core::WALL_NONE || tile.westWall != Core::WALL_ERROR ) {
-                QImage drawTile = m_tileTheme->getTile( tile.westWall, Core::WEST, 0, tile.westWallActiveInPhase.at(phase) );
-                boardPainter.drawImage( drawRect, drawTile );
-            }
-
-            m_mutex.lock();
-            if( m_abortRendering ) {
-                m_mutex.unlock();
-                return true;
+                m_tileTheme->drawSprite( &boardPainter, drawRect, m_tileTheme->tileId( tile.westWall, tile.westWallActiveInPhase.at( phase ) ), Core::WEST );
             }
-            m_mutex.unlock();
         }
     }
 
     boardPainter.end();
 
-    emit boardUpdateReady( boardImage, phase );
-
-    return false;
+    return boardImage;
 }
 
-bool BoardRenderer::drawAnimatedFloorBoard(BotRace::Renderer::AnimationType type)
+void BoardRenderer::drawFlatTile( QPainter *painter, const QRectF &drawRect, const Core::BoardTile_T &tile, int phase ) const
 {
-    QList<QImage> animationCache;
+    painter->fillRect( drawRect, m_tileTheme->spriteColor( m_tileTheme->tileId( tile.type, tile.floorActiveInPhase.at( phase ) ), tile.alignment ) );
 
-    for(int phase=0; phase<5;phase++) {
-        if(type >= WALL_ANIM_PUSHER) {
-            animationCache.append( drawAnimatedWallBoard(type, phase));
-        }
-        else {
-            animationCache.append( drawAnimatedFloorBoard(type, phase));
-        }
-
-        m_mutex.lock();
-        if( m_abortRendering ) {
-            m_mutex.unlock();
-            return true;
-        }
-        m_mutex.unlock();
+    // the average color of a wall covers the whole tile, like a wall sprite scaled down to 1 pixel
+    if( tile.northWall != Core::WALL_NONE && tile.northWall != Core::WALL_ERROR ) {
+        painter->fillRect( drawRect, m_tileTheme->spriteColor( m_tileTheme->tileId( tile.northWall, tile.northWallActiveInPhase.at( phase ) ), Core::NORTH ) );
+    }
+    if( tile.eastWall != Core::WALL_NONE && tile.eastWall != Core::WALL_ERROR ) {
+        painter->fillRect( drawRect, m_tileTheme->spriteColor( m_tileTheme->tileId( tile.eastWall, tile.eastWallActiveInPhase.at( phase ) ), Core::EAST ) );
+    }
+    if( tile.southWall != Core::WALL_NONE && tile.southWall != Core::WALL_ERROR ) {
+        painter->fillRect( drawRect, m_tileTheme->spriteColor( m_tileTheme->tileId( tile.southWall, tile.southWallActiveInPhase.at( phase ) ), Core::SOUTH ) );
+    }
+    if( tile.westWall != Core::WALL_NONE && tile.westWall != Core::WALL_ERROR ) {
+        painter->fillRect( drawRect, m_tileTheme->spriteColor( m_tileTheme->tileId( tile.westWall, tile.westWallActiveInPhase.at( phase ) ), Core::WEST ) );
     }
-
-
-    emit animationUpdateReady( type, animationCache );
-
-    return false;
 }
 
-BoardCache BoardRenderer::drawAnimatedFloorBoard( BotRace::Renderer::AnimationType type, int phase )
+BoardSprites BoardRenderer::phaseSprites( int phase ) const
 {
-    // get the size of 1 tile
-    QImage tileForSize = m_tileTheme->getTile( Core::FLOOR_NORMAL, Core::NORTH );
-    QSize tileSize = tileForSize.size();
-
-    QSize boardSize;
-    boardSize.rwidth() = m_scenario->getBoardSize().width() * tileSize.width();
-    boardSize.rheight() = m_scenario->getBoardSize().height() * tileSize.height();
+    BoardSprites sprites;
+    if( !m_scenario || phase <= 0 || phase >= 5 ) {
+        return sprites;
+    }
 
-    QImage boardFrame0( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame0.fill( Qt::transparent );
+    for( int x = 0; x < m_scenario->getBoardSize().width(); x++ ) {
+        for( int y = 0; y < m_scenario->getBoardSize().height(); y++ ) {
+            Core::BoardTile_T tile = m_scenario->getBoardTile( QPoint( x, y ) );
 
-    QPainter boardPainterFrame0;
-    boardPainterFrame0.begin( &boardFrame0 );
+            // only some tiles have a different sprite when they are not active
+            bool changed = m_tileTheme->tileId( tile.type, tile.floorActiveInPhase.at( phase ) )
+                           != m_tileTheme->tileId( tile.type, tile.floorActiveInPhase.at( 0 ) )
+                           || m_tileTheme->tileId( tile.northWall, tile.northWallActiveInPhase.at( phase ) )
+                           != m_tileTheme->tileId( tile.northWall, tile.northWallActiveInPhase.at( 0 ) )
+                           || m_tileTheme->tileId( tile.eastWall, tile.eastWallActiveInPhase.at( phase ) )
+                           != m_tileTheme->tileId( tile.eastWall, tile.eastWallActiveInPhase.at( 0 ) )
+                           || m_tileTheme->tileId( tile.southWall, tile.southWallActiveInPhase.at( phase ) )
+                           != m_tileTheme->tileId( tile.southWall, tile.southWallActiveInPhase.at( 0 ) )
+                           || m_tileTheme->tileId( tile.westWall, tile.westWallActiveInPhase.at( phase ) )
+                           != m_tileTheme->tileId( tile.westWall, tile.westWallActiveInPhase.at( 0 ) );
+
+            if( changed ) {
+                appendTileSprites( sprites, QPoint( x, y ), tile, phase );
+            }
+        }
+    }
 
-    QImage boardFrame1( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame1.fill( Qt::transparent );
+    return sprites;
+}
 
-    QPainter boardPainterFrame1;
-    boardPainterFrame1.begin( &boardFrame1 );
+void BoardRenderer::appendTileSprites( BoardSprites &sprites, const QPoint &position, const Core::BoardTile_T &tile, int phase ) const
+{
+    // the whole tile is drawn again, the walls have to stay on top of the floor
+    appendSprite( sprites, position, m_tileTheme->tileId( tile.type, tile.floorActiveInPhase.at( phase ) ), tile.alignment, false );
 
-    QImage boardFrame2( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame2.fill( Qt::transparent );
+    if( tile.northWall != Core::WALL_NONE || tile.northWall != Core::WALL_ERROR ) {
+        appendSprite( sprites, position, m_tileTheme->tileId( tile.northWall, tile.northWallActiveInPhase.at( phase ) ), Core::NORTH, false );
+    }
+    if( tile.eastWall != Core::WALL_NONE || tile.eastWall != Core::WALL_ERROR ) {
+        appendSprite( sprites, position, m_tileTheme->tileId( tile.eastWall, tile.eastWallActiveInPhase.at( phase ) ), Core::EAST, false );
+    }
+    if( tile.southWall != Core::WALL_NONE || tile.southWall != Core::WALL_ERROR ) {
+        appendSprite( sprites, position, m_tileTheme->tileId( tile.southWall, tile.southWallActiveInPhase.at( phase ) ), Core::SOUTH, false );
+    }
+    if( tile.westWall != Core::WALL_NONE || tile.westWall != Core::WALL_ERROR ) {
+        appendSprite( sprites, position, m_tileTheme->tileId( tile.westWall, tile.westWallActiveInPhase.at( phase ) ), Core::WEST, false );
+    }
+}
 
-    QPainter boardPainterFrame2;
-    boardPainterFrame2.begin( &boardFrame2 );
+BoardSprites BoardRenderer::animationSprites( BotRace::Renderer::AnimationType type, int phase ) const
+{
+    if( !m_scenario || phase < 0 || phase >= 5 ) {
+        return BoardSprites();
+    }
 
-    QImage boardFrame3( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame3.fill( Qt::transparent );
+    if( type >= WALL_ANIM_PUSHER ) {
+        return animatedWallSprites( type, phase );
+    }
+    else {
+        return animatedFloorSprites( type, phase );
+    }
+}
 
-    QPainter boardPainterFrame3;
-    boardPainterFrame3.begin( &boardFrame3 );
+void BoardRenderer::appendSprite( BoardSprites &sprites, const QPoint &position, int spriteId, int rotation, bool animated ) const
+{
+    if( spriteId < 0 ) {
+        return;
+    }
 
-    QImage boardFrame4( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame4.fill( Qt::transparent );
+    BoardSprite_T sprite;
+    sprite.position = position;
+    sprite.spriteId = spriteId;
+    sprite.rotation = rotation;
+    sprite.animated = animated;
 
-    QPainter boardPainterFrame4;
-    boardPainterFrame4.begin( &boardFrame4 );
+    sprites.append( sprite );
+}
 
+BoardSprites BoardRenderer::animatedFloorSprites( BotRace::Renderer::AnimationType type, int phase ) const
+{
+    BoardSprites sprites;
 
     for( int x = 0; x < m_scenario->getBoardSize().width(); x++ ) {
         for( int y = 0; y < m_scenario->getBoardSize().height(); y++ ) {
@@ -280,123 +408,49 @@ BoardCache BoardRenderer::drawAnimatedFloorBoard( BotRace::Renderer::AnimationTy
             }
             //expand for more cases
 
-            QImage drawTileFrame0 = m_tileTheme->getTile( tile.type, tile.alignment, 0 );
-            QImage drawTileFrame1 = m_tileTheme->getTile( tile.type, tile.alignment, 1 );
-            QImage drawTileFrame2 = m_tileTheme->getTile( tile.type, tile.alignment, 2 );
-            QImage drawTileFrame3 = m_tileTheme->getTile( tile.type, tile.alignment, 3 );
-            QImage drawTileFrame4 = m_tileTheme->getTile( tile.type, tile.alignment, 4 );
-
-            QRectF drawRect;
-            drawRect.setX( x * tileSize.width() );
-            drawRect.setY( y * tileSize.height() );
-            drawRect.setWidth( tileSize.width() + 1 );
-            drawRect.setHeight( tileSize.height() + 1 );
-
-            boardPainterFrame0.drawImage( drawRect, drawTileFrame0 );
-            boardPainterFrame1.drawImage( drawRect, drawTileFrame1 );
-            boardPainterFrame2.drawImage( drawRect, drawTileFrame2 );
-            boardPainterFrame3.drawImage( drawRect, drawTileFrame3 );
-            boardPainterFrame4.drawImage( drawRect, drawTileFrame4 );
+            // the walls are drawn again on top of the animated floor
+            QPoint position( x, y );
+            appendSprite( sprites, position, m_tileTheme->tileId( tile.type ), tile.alignment, true );
 
             if( tile.northWall != Core::WALL_NONE || tile.northWall != Core::WALL_ERROR ) {
-                QImage drawWall = m_tileTheme->getTile( tile.northWall, Core::NORTH );
-                boardPainterFrame0.drawImage( drawRect, drawWall );
-                boardPainterFrame1.drawImage( drawRect, drawWall );
-                boardPainterFrame2.drawImage( drawRect, drawWall );
-                boardPainterFrame3.drawImage( drawRect, drawWall );
-                boardPainterFrame4.drawImage( drawRect, drawWall );
+                appendSprite( sprites, position, m_tileTheme->tileId( tile.northWall ), Core::NORTH, false );
             }
             if( tile.eastWall != Core::WALL_NONE || tile.eastWall != Core::WALL_ERROR ) {
-                QImage drawWall = m_tileTheme->getTile( tile.eastWall, Core::EAST );
-                boardPainterFrame0.drawImage( drawRect, drawWall );
-                boardPainterFrame1.drawImage( drawRect, drawWall );
-                boardPainterFrame2.drawImage( drawRect, drawWall );
-                boardPainterFrame3.drawImage( drawRect, drawWall );
-                boardPainterFrame4.drawImage( drawRect, drawWall );
+                appendSprite( sprites, position, m_tileTheme->tileId( tile.eastWall ), Core::EAST, false );
             }
             if( tile.southWall != Core::WALL_NONE || tile.southWall != Core::WALL_ERROR ) {
-                QImage drawWall = m_tileTheme->getTile( tile.southWall, Core::SOUTH );
-                boardPainterFrame0.drawImage( drawRect, drawWall );
-                boardPainterFrame1.drawImage( drawRect, drawWall );
-                boardPainterFrame2.drawImage( drawRect, drawWall );
-                boardPainterFrame3.drawImage( drawRect, drawWall );
-                boardPainterFrame4.drawImage( drawRect, drawWall );
+                appendSprite( sprites, position, m_tileTheme->tileId( tile.southWall ), Core::SOUTH, false );
             }
             if( tile.westWall != Core::WALL_NONE || tile.westWall != Core::WALL_ERROR ) {
-                QImage drawWall = m_tileTheme->getTile( tile.westWall, Core::WEST );
-                boardPainterFrame0.drawImage( drawRect, drawWall );
-                boardPainterFrame1.drawImage( drawRect, drawWall );
-                boardPainterFrame2.drawImage( drawRect, drawWall );
-                boardPainterFrame3.drawImage( drawRect, drawWall );
-                boardPainterFrame4.drawImage( drawRect, drawWall );
+                appendSprite( sprites, position, m_tileTheme->tileId( tile.westWall ), Core::WEST, false );
             }
-
-            m_mutex.lock();
-            if( m_abortRendering ) {
-                m_mutex.unlock();
-                return QList<QImage>();
-            }
-            m_mutex.unlock();
         }
     }
 
-    boardPainterFrame0.end();
-    boardPainterFrame1.end();
-    boardPainterFrame2.end();
-    boardPainterFrame3.end();
-    boardPainterFrame4.end();
-
-    QList<QImage> animationCache;
-    animationCache.append( boardFrame0 );
-    animationCache.append( boardFrame1 );
-    animationCache.append( boardFrame2 );
-    animationCache.append( boardFrame3 );
-    animationCache.append( boardFrame4 );
-
-    return animationCache;
+    return sprites;
 }
 
-BoardCache BoardRenderer::drawAnimatedWallBoard( BotRace::Renderer::AnimationType type, int phase )
+BoardSprites BoardRenderer::animatedWallSprites( BotRace::Renderer::AnimationType type, int phase ) const
 {
-    // get the size of 1 tile
-    QImage tileForSize = m_tileTheme->getTile( Core::FLOOR_NORMAL, Core::NORTH );
-    QSize tileSize = tileForSize.size();
-
-    QSize boardSize;
-    boardSize.rwidth() = m_scenario->getBoardSize().width() * tileSize.width();
-    boardSize.rheight() = m_scenario->getBoardSize().height() * tileSize.height();
-
-    QImage boardFrame0( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame0.fill( Qt::transparent );
-
-    QPainter boardPainterFrame0;
-    boardPainterFrame0.begin( &boardFrame0 );
-
-    QImage boardFrame1( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame1.fill( Qt::transparent );
-
-    QPainter boardPainterFrame1;
-    boardPainterFrame1.begin( &boardFrame1 );
+    BoardSprites sprites;
 
-    QImage boardFrame2( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame2.fill( Qt::transparent );
-
-    QPainter boardPainterFrame2;
-    boardPainterFrame2.begin( &boardFrame2 );
-
-    QImage boardFrame3( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame3.fill( Qt::transparent );
-
-    QPainter boardPainterFrame3;
-    boardPainterFrame3.begin( &boardFrame3 );
-
-    QImage boardFrame4( boardSize, QImage::Format_ARGB32_Premultiplied );
-    boardFrame4.fill( Qt::transparent );
-
-    QPainter boardPainterFrame4;
-    boardPainterFrame4.begin( &boardFrame4 );
+    BotRace::Core::WallTileType animatedWallType = Core::WALL_NONE;
+    switch(type) {
+    case WALL_ANIM_PUSHER: {
+        animatedWallType = Core::WALL_PUSHER;
+        break;
+    }
+    case WALL_ANIM_CRUSHER: {
+        animatedWallType = Core::WALL_CRUSHER;
+        break;
+    }
+    case FLOOR_ANIM_GEARS:
+    case FLOOR_ANIM_BELT2:
+    case FLOOR_ANIM_BELT1AND2:
+    case MAX_ANIMATIONS:
+        return sprites;
+    }
 
-    BotRace::Core::WallTileType animatedWallType;
     for( int x = 0; x < m_scenario->getBoardSize().width(); x++ ) {
         for( int y = 0; y < m_scenario->getBoardSize().height(); y++ ) {
             Core::BoardTile_T tile = m_scenario->getBoardTile( QPoint( x, y ) );
@@ -409,23 +463,6 @@ BoardCache BoardRenderer::drawAnimatedWallBoard( BotRace::Renderer::AnimationTyp
                 continue;
             }
 
-            switch(type) {
-            case WALL_ANIM_PUSHER: {
-                animatedWallType = Core::WALL_PUSHER;
-                break;
-            }
-            case WALL_ANIM_CRUSHER: {
-                animatedWallType = Core::WALL_CRUSHER;
-                break;
-            }
-            case FLOOR_ANIM_GEARS:
-            case FLOOR_ANIM_BELT2:
-            case FLOOR_ANIM_BELT1AND2:
-            case MAX_ANIMATIONS:
-                break;
-
-            }
-
             if( !(tile.northWall == animatedWallType ||
                   tile.eastWall == animatedWallType  ||
                   tile.southWall == animatedWallType  ||
@@ -434,127 +471,55 @@ BoardCache BoardRenderer::drawAnimatedWallBoard( BotRace::Renderer::AnimationTyp
             }
 
             // first draw the used floor again
-            QImage drawTileFrame0 = m_tileTheme->getTile( tile.type, tile.alignment );
-            QImage drawTileFrame1 = m_tileTheme->getTile( tile.type, tile.alignment );
-            QImage drawTileFrame2 = m_tileTheme->getTile( tile.type, tile.alignment );
-            QImage drawTileFrame3 = m_tileTheme->getTile( tile.type, tile.alignment );
-            QImage drawTileFrame4 = m_tileTheme->getTile( tile.type, tile.alignment );
-
-            QRectF drawRect;
-            drawRect.setX( x * tileSize.width() );
-            drawRect.setY( y * tileSize.height() );
-            drawRect.setWidth( tileSize.width() + 1 );
-            drawRect.setHeight( tileSize.height() + 1 );
-
-            boardPainterFrame0.drawImage( drawRect, drawTileFrame0 );
-            boardPainterFrame1.drawImage( drawRect, drawTileFrame1 );
-            boardPainterFrame2.drawImage( drawRect, drawTileFrame2 );
-            boardPainterFrame3.drawImage( drawRect, drawTileFrame3 );
-            boardPainterFrame4.drawImage( drawRect, drawTileFrame4 );
+            QPoint position( x, y );
+            appendSprite( sprites, position, m_tileTheme->tileId( tile.type ), tile.alignment, false );
 
             if( tile.northWall != Core::WALL_NONE || tile.northWall != Core::WALL_ERROR ) {
-                if(tile.northWall == animatedWallType && tile.northWallActiveInPhase.at(phase)) {
-                    boardPainterFrame0.drawImage( drawRect, m_tileTheme->getTile( tile.northWall, Core::NORTH, 0 ));
-                    boardPainterFrame1.drawImage( drawRect, m_tileTheme->getTile( tile.northWall, Core::NORTH, 1 ));
-                    boardPainterFrame2.drawImage( drawRect, m_tileTheme->getTile( tile.northWall, Core::NORTH, 2 ));
-                    boardPainterFrame3.drawImage( drawRect, m_tileTheme->getTile( tile.northWall, Core::NORTH, 3 ));
-                    boardPainterFrame4.drawImage( drawRect, m_tileTheme->getTile( tile.northWall, Core::NORTH, 4 ));
-                }
-                else {
-                    QImage drawWall = m_tileTheme->getTile( tile.northWall, Core::NORTH );
-                    boardPainterFrame0.drawImage( drawRect, drawWall );
-                    boardPainterFrame1.drawImage( drawRect, drawWall );
-                    boardPainterFrame2.drawImage( drawRect, drawWall );
-                    boardPainterFrame3.drawImage( drawRect, drawWall );
-                    boardPainterFrame4.drawImage( drawRect, drawWall );
-                }
+                bool animated = tile.northWall == animatedWallType && tile.northWallActiveInPhase.at(phase);
+                appendSprite( sprites, position, m_tileTheme->tileId( tile.northWall ), Core::NORTH, animated );
             }
             if( tile.eastWall != Core::WALL_NONE || tile.eastWall != Core::WALL_ERROR ) {
-                if(tile.eastWall == animatedWallType && tile.eastWallActiveInPhase.at(phase)) {
-                    boardPainterFrame0.drawImage( drawRect, m_tileTheme->getTile( tile.eastWall, Core::EAST, 0 ));
-                    boardPainterFrame1.drawImage( drawRect, m_tileTheme->getTile( tile.eastWall, Core::EAST, 1 ));
-                    boardPainterFrame2.drawImage( drawRect, m_tileTheme->getTile( tile.eastWall, Core::EAST, 2 ));
-                    boardPainterFrame3.drawImage( drawRect, m_tileTheme->getTile( tile.eastWall, Core::EAST, 3 ));
-                    boardPainterFrame4.drawImage( drawRect, m_tileTheme->getTile( tile.eastWall, Core::EAST, 4 ));
-                }
-                else {
-                    QImage drawWall = m_tileTheme->getTile( tile.eastWall, Core::EAST );
-                    boardPainterFrame0.drawImage( drawRect, drawWall );
-                    boardPainterFrame1.drawImage( drawRect, drawWall );
-                    boardPainterFrame2.drawImage( drawRect, drawWall );
-                    boardPainterFrame3.drawImage( drawRect, drawWall );
-                    boardPainterFrame4.drawImage( drawRect, drawWall );
-                }
+                bool animated = tile.eastWall == animatedWallType && tile.eastWallActiveInPhase.at(phase);
+                appendSprite( sprites, position, m_tileTheme->tileId( tile.eastWall ), Core::EAST, animated );
             }
             if( tile.southWall != Core::WALL_NONE || tile.southWall != Core::WALL_ERROR ) {
-                if(tile.southWall == animatedWallType && tile.southWallActiveInPhase.at(phase)) {
-                    boardPainterFrame0.drawImage( drawRect, m_tileTheme->getTile( tile.southWall, Core::SOUTH, 0 ));
-                    boardPainterFrame1.drawImage( drawRect, m_tileTheme->getTile( tile.southWall, Core::SOUTH, 1 ));
-                    boardPainterFrame2.drawImage( drawRect, m_tileTheme->getTile( tile.southWall, Core::SOUTH, 2 ));
-                    boardPainterFrame3.drawImage( drawRect, m_tileTheme->getTile( tile.southWall, Core::SOUTH, 3 ));
-                    boardPainterFrame4.drawImage( drawRect, m_tileTheme->getTile( tile.southWall, Core::SOUTH, 4 ));
-                }
-                else {
-                    QImage drawWall = m_tileTheme->getTile( tile.southWall, Core::SOUTH );
-                    boardPainterFrame0.drawImage( drawRect, drawWall );
-                    boardPainterFrame1.drawImage( drawRect, drawWall );
-                    boardPainterFrame2.drawImage( drawRect, drawWall );
-                    boardPainterFrame3.drawImage( drawRect, drawWall );
-                    boardPainterFrame4.drawImage( drawRect, drawWall );
-                }
+                bool animated = tile.southWall == animatedWallType && tile.southWallActiveInPhase.at(phase);
+                appendSprite( sprites, position, m_tileTheme->tileId( tile.southWall ), Core::SOUTH, animated );
             }
             if( tile.westWall != Core::WALL_NONE || tile.westWall != Core::WALL_ERROR ) {
-                if(tile.westWall == animatedWallType && tile.westWallActiveInPhase.at(phase)) {
-                    boardPainterFrame0.drawImage( drawRect, m_tileTheme->getTile( tile.westWall, Core::WEST, 0 ));
-                    boardPainterFrame1.drawImage( drawRect, m_tileTheme->getTile( tile.westWall, Core::WEST, 1 ));
-                    boardPainterFrame2.drawImage( drawRect, m_tileTheme->getTile( tile.westWall, Core::WEST, 2 ));
-                    boardPainterFrame3.drawImage( drawRect, m_tileTheme->getTile( tile.westWall, Core::WEST, 3 ));
-                    boardPainterFrame4.drawImage( drawRect, m_tileTheme->getTile( tile.westWall, Core::WEST, 4 ));
-                }
-                else {
-                    QImage drawWall = m_tileTheme->getTile( tile.westWall, Core::WEST );
-                    boardPainterFrame0.drawImage( drawRect, drawWall );
-                    boardPainterFrame1.drawImage( drawRect, drawWall );
-                    boardPainterFrame2.drawImage( drawRect, drawWall );
-                    boardPainterFrame3.drawImage( drawRect, drawWall );
-                    boardPainterFrame4.drawImage( drawRect, drawWall );
-                }
-            }
-
-            m_mutex.lock();
-            if( m_abortRendering ) {
-                m_mutex.unlock();
-                return QList<QImage>();
+                bool animated = tile.westWall == animatedWallType && tile.westWallActiveInPhase.at(phase);
+                appendSprite( sprites, position, m_tileTheme->tileId( tile.westWall ), Core::WEST, animated );
             }
-            m_mutex.unlock();
         }
     }
 
-    boardPainterFrame0.end();
-    boardPainterFrame1.end();
-    boardPainterFrame2.end();
-    boardPainterFrame3.end();
-    boardPainterFrame4.end();
-
-    QList<QImage> animationCache;
-    animationCache.append( boardFrame0 );
-    animationCache.append( boardFrame1 );
-    animationCache.append( boardFrame2 );
-    animationCache.append( boardFrame3 );
-    animationCache.append( boardFrame4 );
-
-    return animationCache;
+    return sprites;
 }
 
 bool BoardRenderer::drawPhaseActiveLayer()
 {
-    // get the size of 1 tile
-    QImage tileForSize = m_tileTheme->getTile( Core::FLOOR_NORMAL, Core::NORTH );
-    QSize tileSize = tileForSize.size();
+    QSize boardSize = this->boardSize();
+    int rows = m_scenario->getBoardSize().height();
+    if( boardSize.isEmpty() ) {
+        return false;
+    }
 
-    QSize boardSize;
-    boardSize.rwidth() = m_scenario->getBoardSize().width() * tileSize.width();
-    boardSize.rheight() = m_scenario->getBoardSize().height() * tileSize.height();
+    // one strip of whole tile rows for each core, each strip is drawn into its own image
+    int stripCount = qBound( 1, QThread::idealThreadCount(), rows );
+    int rowsPerStrip = ( rows + stripCount - 1 ) / stripCount;
+    int tileHeight = tileSize().height();
+
+    QList<QRect> strips;
+    for( int row = 0; row < rows; row += rowsPerStrip ) {
+        strips.append( QRect( 0, row * tileHeight, boardSize.width(), qMin( rowsPerStrip, rows - row ) * tileHeight ) );
+    }
+
+    // the vector is not resized anymore, so each job can write into its own image
+    QVector<QImage> stripImages( strips.size() );
+    QSemaphore stripsDone;
+    for( int i = 0; i < strips.size(); i++ ) {
+        m_renderPool.start( new PhaseLayerStripJob( this, strips.at( i ), &stripImages[i], &stripsDone ) );
+    }
 
     QImage boardImage( boardSize, QImage::Format_ARGB32_Premultiplied );
     boardImage.fill( Qt::transparent );
@@ -562,8 +527,37 @@ bool BoardRenderer::drawPhaseActiveLayer()
     QPainter boardPainter;
     boardPainter.begin( &boardImage );
 
-    for( int x = 0; x < m_scenario->getBoardSize().width(); x++ ) {
-        for( int y = 0; y < m_scenario->getBoardSize().height(); y++ ) {
+    // wait for all strips even when aborted, they still use this object and the images
+    stripsDone.acquire( strips.size() );
+    for( int i = 0; i < strips.size(); i++ ) {
+        boardPainter.drawImage( strips.at( i ).topLeft(), stripImages.at( i ) );
+    }
+
+    boardPainter.end();
+
+    if( isAborted() ) {
+        return true;
+    }
+
+    emit phaseLayerUpdateReady( boardImage );
+
+    return false;
+}
+
+QImage BoardRenderer::drawPhaseLayerStrip( const QRect &stripRect )
+{
+    QSize tileSize = this->tileSize();
+    QRect tiles = tilesInChunk( stripRect );
+
+    QImage stripImage( stripRect.size(), QImage::Format_ARGB32_Premultiplied );
+    stripImage.fill( Qt::transparent );
+
+    QPainter stripPainter;
+    stripPainter.begin( &stripImage );
+    stripPainter.translate( -stripRect.topLeft() );
+
+    for( int x = tiles.left(); x <= tiles.right(); x++ ) {
+        for( int y = tiles.top(); y <= tiles.bottom(); y++ ) {
             Core::BoardTile_T tile = m_scenario->getBoardTile( QPoint( x, y ) );
 
             QRectF drawRect;
@@ -584,8 +578,7 @@ bool BoardRenderer::drawPhaseActiveLayer()
             if( drawFloorPhases ) {
                 for(int p=0;p<5;p++) {
                     if( tile.floorActiveInPhase.at(p) ) {
-                        QImage drawPhase = m_tileTheme->getTile( QString("Phase_F_%1").arg(p+1), 0, 0 );
-                        boardPainter.drawImage( drawRect, drawPhase );
+                        m_tileTheme->drawSprite( &stripPainter, drawRect, m_tileTheme->phaseMarkerId( PHASE_FLOOR, p ) );
                     }
                 }
             }
@@ -604,8 +597,7 @@ bool BoardRenderer::drawPhaseActiveLayer()
                 if( drawPhases ) {
                     for(int p=0;p<5;p++) {
                         if( tile.northWallActiveInPhase.at(p) ) {
-                            QImage drawPhase = m_tileTheme->getTile( QString("Phase_WN_%1").arg(p+1), 0, 0 );
-                            boardPainter.drawImage( drawRect, drawPhase );
+                            m_tileTheme->drawSprite( &stripPainter, drawRect, m_tileTheme->phaseMarkerId( PHASE_WALL_NORTH, p ) );
                         }
                     }
                 }
@@ -623,8 +615,7 @@ bool BoardRenderer::drawPhaseActiveLayer()
                 if( drawPhases ) {
                     for(int p=0;p<5;p++) {
                         if( tile.eastWallActiveInPhase.at(p) ) {
-                            QImage drawPhase = m_tileTheme->getTile( QString("Phase_WE_%1").arg(p+1), 0, 0 );
-                            boardPainter.drawImage( drawRect, drawPhase );
+                            m_tileTheme->drawSprite( &stripPainter, drawRect, m_tileTheme->phaseMarkerId( PHASE_WALL_EAST, p ) );
                         }
                     }
                 }
@@ -642,8 +633,7 @@ bool BoardRenderer::drawPhaseActiveLayer()
                 if( drawPhases ) {
                     for(int p=0;p<5;p++) {
                         if( tile.southWallActiveInPhase.at(p) ) {
-                            QImage drawPhase = m_tileTheme->getTile( QString("Phase_WS_%1").arg(p+1), 0, 0 );
-                            boardPainter.drawImage( drawRect, drawPhase );
+                            m_tileTheme->drawSprite( &stripPainter, drawRect, m_tileTheme->phaseMarkerId( PHASE_WALL_SOUTH, p ) );
                         }
                     }
                 }
@@ -661,27 +651,33 @@ bool BoardRenderer::drawPhaseActiveLayer()
                 if( drawPhases ) {
                     for(int p=0;p<5;p++) {
                         if( tile.westWallActiveInPhase.at(p) ) {
-                            QImage drawPhase = m_tileTheme->getTile( QString("Phase_WW_%1").arg(p+1), 0, 0 );
-                            boardPainter.drawImage( drawRect, drawPhase );
+                            m_tileTheme->drawSprite( &stripPainter, drawRect, m_tileTheme->phaseMarkerId( PHASE_WALL_WEST, p ) );
                         }
                     }
                 }
             }
 
-            m_mutex.lock();
-            if( m_abortRendering ) {
-                m_mutex.unlock();
-                return true;
+            if( isAborted() ) {
+                stripPainter.end();
+                return QImage();
             }
-            m_mutex.unlock();
         }
     }
 
-    boardPainter.end();
+    stripPainter.end();
 
-    emit phaseLayerUpdateReady( boardImage );
+    return stripImage;
+}
 
-    return false;
+void BoardRenderer::renderBoardChunk( const QRect &chunkRect, int detailLevel, quint64 key, quint32 generation )
+{
+    m_renderPool.start( new BoardChunkJob( this, chunkRect, detailLevel, key, generation ) );
+}
+
+bool BoardRenderer::isAborted()
+{
+    QMutexLocker locker( &m_mutex );
+    return m_abortRendering;
 }
 
 void BoardRenderer::abort()
@@ -20,24 +20,25 @@
 
 #include <QThread>
 #include <QImage>
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
 
 #include <QMutex>
+#include <QThreadPool>
+
+class QPainter;
 
 namespace BotRace {
 namespace Core {
 class BoardManager;
+struct BoardTile_T;
 }
 
 namespace Renderer {
 class TileTheme;
 
-/**
- * @brief To connect the list of animated boards via signal/slot
- *
- * The list is filled with frame 0 - 4 of the connected animation
-*/
-typedef QList<QImage> BoardCache;
-
 enum AnimationType {
     FLOOR_ANIM_GEARS,
     FLOOR_ANIM_BELT2,
@@ -48,28 +49,62 @@ enum AnimationType {
     MAX_ANIMATIONS
 };
 
+/**
+ * @brief Number of detail levels below the full board, each level halves the resolution of the chunks
+ */
+const int MAX_BOARD_DETAIL_LEVEL = 3;
+
+/**
+ * @brief Tiles smaller than this (in pixel) are drawn as flat colors instead of sprites
+ */
+const int BOARD_FLAT_TILE_SIZE = 12;
+
+/**
+ * @brief One sprite drawn on top of the base board
+ *
+ * Instead of full board images, animations and the differences of a phase to the base
+ * board are lists of the sprites that are drawn on top of it.
+ */
+struct BoardSprite_T {
+    QPoint position;    /**< the board tile the sprite is drawn on */
+    int spriteId;       /**< sprite id in the TileTheme */
+    int rotation;       /**< rotation of the sprite */
+    bool animated;      /**< @c true if the current animation frame is drawn, @c false for the static frame 0 */
+};
+
+/**
+ * @brief All sprites of one animation or phase, in drawing order
+ */
+typedef QList<BoardSprite_T> BoardSprites;
+
 /**
  * @brief Renders the board scene from a set of tiles
  *
  * When the themerenderer rendered the single tiles in all directions
- * this class renders the full board scenario from this tiles.
+ * this class renders the board scenario from this tiles.
  *
  * No SVG Rendering needed anymore, simply stich the prerendered tiles together.
- * This is done in several steps.
- * @li draw base board and emit the QImage
- * @li draw overlay with all gears in all 5 animated frames
- * @li draw overlay with all conveyor 2 belts in all 5 animated frames
- * @li draw overlay with all conveyor 1 and 2 belts in all 5 animated frames
+ * The board is never rendered as one big image. Instead the BoardTheme asks for
+ * rectangular chunks of the board when they become visible via drawBoardChunk().
  *
- * The animated boards are used to animate the board elements with all 5 frames.
- * Instead of animating all elements on its own, the whole board image is switched
- * All non interresting parts are transparent though.
+ * Only the base board of phase 1 is drawn that way. Most tiles look the same in all phases,
+ * phaseSprites() collects the few tiles that differ in another phase (auto pits, fire walls),
+ * which are drawn on top of the base board.
  *
- * What will be animated is defined by the game phases.
+ * The animations are not rendered at all. animationSprites() collects the few tiles
+ * that take part in an animation, which are drawn with the current frame directly
+ * from the TileTheme while the animation runs.
  *
- * This class runns in a thread in the background, controlled by the BordTheme class.
- * It emits the basic board which can than directly displayed while it continue with
- * the other board parts.
+ * Chunks can be drawn in several detail levels, each with half the resolution of the level
+ * before. Zoomed out views use them like mipmaps, they need a fraction of the memory and
+ * paint time of the full board. Once the tiles get smaller than BOARD_FLAT_TILE_SIZE each
+ * sprite is replaced by its average color, as the details could not be seen anyway.
+ *
+ * The chunk functions only read the scenario and the TileTheme, so they can be called from
+ * any thread. The thread itself renders the phase layer in the background, controlled by the BordTheme class.
+ * The phase layer is split into horizontal strips which are rendered in an own QThreadPool,
+ * the same pool renderBoardChunk() uses for the chunks missing on screen. The global pool is
+ * left to the other themes, so a board rendering never waits for them or the other way round.
  *
  * The size of the endresult is determined by the size of the previous rendered
  * tiles and the board size of the scenario from the BoardManager
@@ -84,6 +119,13 @@ public:
     */
     explicit BoardRenderer( TileTheme *tileTheme );
 
+    /**
+     * @brief destructor
+     *
+     * Waits for the thread and all chunks still rendered in the pool.
+    */
+    ~BoardRenderer();
+
     /**
      * @brief Sets the BoardManager to retrive the scenario
      *
@@ -99,65 +141,145 @@ public:
     */
     void abort();
 
-protected:
     /**
-     * @brief Implemented run function from QThread
+     * @brief Size of one board tile with the current tile scale
      *
-     * Starts the rendering of the board images
+     * @return size in pixel or an empty size if the tiles are not rendered yet
     */
-    void run();
+    QSize tileSize() const;
+
+    /**
+     * @brief Size of the full board with the current tile scale
+     *
+     * @return size in pixel or an empty size if no scenario or tiles are available
+    */
+    QSize boardSize() const;
+
+    /**
+     * @brief Returns if the tiles are drawn as flat colors in @p detailLevel
+     *
+     * @param detailLevel the detail level (0 - MAX_BOARD_DETAIL_LEVEL)
+     * @return @c true if the tiles are smaller than BOARD_FLAT_TILE_SIZE in this level
+    */
+    bool isFlat( int detailLevel ) const;
+
+    /**
+     * @brief draws a part of the basic board elements from single tiles
+     *
+     * @param chunkRect the part of the board in board pixel
+     * @param detailLevel the resolution of the image is reduced by 2^detailLevel
+     * @return the image of the part for the first phase, with the size of @p chunkRect reduced by the detail level
+    */
+    QImage drawBoardChunk( const QRect &chunkRect, int detailLevel = 0 ) const;
+
+    /**
+     * @brief draws a chunk of the basic board in the board render pool
+     *
+     * Returns at once, the image is delivered with boardChunkReady().
+     *
+     * @param chunkRect the part of the board in board pixel
+     * @param detailLevel the resolution of the image is reduced by 2^detailLevel
+     * @param key identifies the chunk in boardChunkReady()
+     * @param generation the cache generation of the caller, passed on to boardChunkReady()
+    */
+    void renderBoardChunk( const QRect &chunkRect, int detailLevel, quint64 key, quint32 generation );
 
-signals:
     /**
-     * @brief emitted when the basic board is finished
+     * @brief Collects the tiles that look different in @p phase than on the base board
      *
-     * @param newCache QImage of the basic board
+     * @param phase the phase (0-4)
+     * @return the floor and wall sprites of all differing tiles, empty for phase 0
     */
-    void boardUpdateReady( QImage newCache, int );
+    BoardSprites phaseSprites( int phase ) const;
 
     /**
-     * @brief emitted when the animation board for @p type is finished
+     * @brief Collects the sprites of the animation of type @p type
      *
      * @param type the animation type
-     * @param newCache list of all animation frames of the type
+     * @param phase the phase the animation is shown in, only active elements are animated
+     * @return all sprites of the animation
     */
-    void animationUpdateReady( BotRace::Renderer::AnimationType type, BoardCache newCache );
+    BoardSprites animationSprites( BotRace::Renderer::AnimationType type, int phase ) const;
+
+protected:
+    /**
+     * @brief Implemented run function from QThread
+     *
+     * Starts the rendering of the phase layer
+    */
+    void run();
 
+signals:
     void phaseLayerUpdateReady( QImage newCache );
 
+    /**
+     * @brief emitted from a thread of the pool when a chunk of renderBoardChunk() is drawn
+    */
+    void boardChunkReady( quint64 key, quint32 generation, QImage chunkImage );
+
 private:
     /**
-     * @brief draws the basic board elements from single tiles
+     * @brief Returns the range of board tiles that cover @p chunkRect
      *
-     * @p the phase the board is drawn for (as some elements have different appereance if active or passive in
-     *    on phase, we draw the baseboard for each individual phase.
-     *    @c phase start with 0 and ends with 4
+     * The range includes the tiles left and above which overlap the chunk by 1 pixel.
+    */
+    QRect tilesInChunk( const QRect &chunkRect ) const;
+
+    /**
+     * @brief Draws @p tile with the average colors of its sprites
+    */
+    void drawFlatTile( QPainter *painter, const QRectF &drawRect, const Core::BoardTile_T &tile, int phase ) const;
+
+    /**
+     * @brief Collects the sprites of the animated floor elements
+    */
+    BoardSprites animatedFloorSprites( BotRace::Renderer::AnimationType type, int phase ) const;
+
+    /**
+     * @brief Collects the sprites of the animated wall elements
+    */
+    BoardSprites animatedWallSprites( BotRace::Renderer::AnimationType type, int phase ) const;
+
+    /**
+     * @brief Adds a sprite to @p sprites if the theme has it
+    */
+    void appendSprite( BoardSprites &sprites, const QPoint &position, int spriteId, int rotation, bool animated ) const;
+
+    /**
+     * @brief Adds the floor and all walls of @p tile in @p phase to @p sprites
+    */
+    void appendTileSprites( BoardSprites &sprites, const QPoint &position, const Core::BoardTile_T &tile, int phase ) const;
+
+    /**
+     * @brief draws the phase layer in horizontal strips, one for each core
      *
      * @return @c true if abort() was called,
      *         @c false if the thread can continiue to run
     */
-    bool drawBaseBoard(int phase);
+    bool drawPhaseActiveLayer();
 
     /**
-     * @brief draws the animation elements from single tiles of type @p type
+     * @brief draws one strip of the phase layer, called in a thread of the board render pool
      *
-     * Only animates Floor types!
-     *
-     * @param type the animation type we want to render
-     * @return @c true if abort() was called,
-     *         @c false if the thread can continiue to run
+     * @param stripRect the part of the board in board pixel
+     * @return the image of the strip or an empty image if the rendering was aborted
     */
-    bool drawAnimatedFloorBoard( BotRace::Renderer::AnimationType type );
-    BoardCache drawAnimatedFloorBoard( BotRace::Renderer::AnimationType type, int phase );
-    BoardCache drawAnimatedWallBoard( BotRace::Renderer::AnimationType type, int phase );
+    QImage drawPhaseLayerStrip( const QRect &stripRect );
 
-    bool drawPhaseActiveLayer();
+    /**
+     * @brief Returns if abort() was called since the last start
+    */
+    bool isAborted();
 
     TileTheme *m_tileTheme;           /**< Theme to get the tiles from */
     Core::BoardManager *m_scenario;   /**< Reference to get the scenario for the board from */
 
     bool m_abortRendering;            /**< Saves if the thread should be canceled */
     QMutex m_mutex;                   /**< Mutex to block several threads changing the abort value */
+    QThreadPool m_renderPool;         /**< Threads for the chunks and the phase layer strips */
+
+    friend class BoardChunkJob;
+    friend class PhaseLayerStripJob;
 };
 
 }
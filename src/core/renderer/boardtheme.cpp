@@ -18,27 +18,40 @@
 #include "boardtheme.h"
 
 #include "tiletheme.h"
+#include "paintprofiler.h"
 #include "../engine/boardmanager.h"
+#include "../engine/clientsettings.h"
 
 #include <QDebug>
 
 using namespace BotRace;
 using namespace Renderer;
 
-BoardTheme::BoardTheme( TileTheme *tileTheme )
+static quint64 chunkKey( const QPoint &chunk, int detailLevel )
 {
-    //m_boardImage.reserve(5);
+    return (( quint64 )detailLevel << 32 ) | (( quint64 )( chunk.x() & 0xffff ) << 16 ) | ( quint64 )( chunk.y() & 0xffff );
+}
+
+static QPoint chunkFromKey( quint64 key )
+{
+    return QPoint(( key >> 16 ) & 0xffff, key & 0xffff );
+}
+
+BoardTheme::BoardTheme( TileTheme *tileTheme ) :
+    m_cacheGeneration( 0 ),
+    m_restartRenderer( false ),
+    m_tileTheme( tileTheme )
+{
+    m_chunkCache.setMaxCost( Core::DEFAULT_BOARD_CACHE_SIZE * 1024 );
 
     m_renderer = new BoardRenderer( tileTheme );
 
     connect( tileTheme, SIGNAL( updateAvailable() ),
              this, SLOT( generateBoardCache() ) );
 
-    connect( m_renderer, SIGNAL( boardUpdateReady( QImage, int ) ),
-             this, SLOT( updateBoardCache( QImage, int ) ) );
-    connect( m_renderer, SIGNAL( animationUpdateReady(BotRace::Renderer::AnimationType,BoardCache) ),
-             this, SLOT( updateAnimationCache(BotRace::Renderer::AnimationType,BoardCache) ) );
     connect(m_renderer, SIGNAL(phaseLayerUpdateReady(QImage)), this, SLOT(updatePhaseLayerCache(QImage)) );
+    connect( m_renderer, SIGNAL( boardChunkReady( quint64, quint32, QImage ) ), this, SLOT( insertBoardChunk( quint64, quint32, QImage ) ) );
+    connect( m_renderer, SIGNAL( finished() ), this, SLOT( rendererFinished() ) );
 }
 
 BoardTheme::~BoardTheme()
@@ -53,20 +66,104 @@ void BoardTheme::setBoardScenario( Core::BoardManager *scenario )
     connect( scenario, SIGNAL( boardChanged() ), this, SLOT( generateBoardCache() ) );
 }
 
-QImage BoardTheme::getBoard(int phase)
+QSize BoardTheme::boardSize() const
+{
+    return m_renderer->boardSize();
+}
+
+QRect BoardTheme::chunkRect( const QPoint &chunk ) const
 {
-    if( m_boardImage.size() >= phase + 1 ) {
-        return m_boardImage.at(phase);
+    QRect rect( chunk.x() * BOARD_CHUNK_SIZE, chunk.y() * BOARD_CHUNK_SIZE, BOARD_CHUNK_SIZE, BOARD_CHUNK_SIZE );
+    return rect.intersected( QRect( QPoint( 0, 0 ), boardSize() ) );
+}
+
+int BoardTheme::detailLevel( qreal scale ) const
+{
+    // the next level is used once the view does not need more than half of the resolution
+    int level = 0;
+    while( level < MAX_BOARD_DETAIL_LEVEL && scale > 0 && scale <= 0.5 ) {
+        scale *= 2;
+        level++;
     }
-    else {
-        qWarning() << "BoardTheme::getBoard :: basic board for phase" << phase + 1 << "not available at the moment";
-        return QImage();
+
+    return level;
+}
+
+bool BoardTheme::isFlat( int detailLevel ) const
+{
+    return m_renderer->isFlat( detailLevel );
+}
+
+QList<QImage> BoardTheme::getBoardChunks( const QList<QPoint> &chunks, int detailLevel )
+{
+    QList<QImage> chunkImages;
+
+    foreach( const QPoint & chunk, chunks ) {
+        quint64 key = chunkKey( chunk, detailLevel );
+
+        QImage *cachedImage = m_chunkCache.object( key );
+        if( cachedImage ) {
+            chunkImages.append( *cachedImage );
+            continue;
+        }
+
+        QRect rect = chunkRect( chunk );
+        if( !rect.isEmpty() && !m_pendingChunks.contains( key ) ) {
+            PaintProfiler::add( PROFILE_CHUNK_MISSES, 1 );
+
+            m_pendingChunks.insert( key );
+            m_renderer->renderBoardChunk( rect, detailLevel, key, m_cacheGeneration );
+        }
+
+        chunkImages.append( placeholderChunk( chunk, detailLevel ) );
     }
+
+    return chunkImages;
+}
+
+QImage BoardTheme::placeholderChunk( const QPoint &chunk, int detailLevel )
+{
+    // a coarser chunk is cheaper to scale up, a finer one is still better than nothing
+    for( int level = detailLevel + 1; level <= MAX_BOARD_DETAIL_LEVEL; level++ ) {
+        QImage *cachedImage = m_chunkCache.object( chunkKey( chunk, level ) );
+        if( cachedImage ) {
+            return *cachedImage;
+        }
+    }
+
+    for( int level = detailLevel - 1; level >= 0; level-- ) {
+        QImage *cachedImage = m_chunkCache.object( chunkKey( chunk, level ) );
+        if( cachedImage ) {
+            return *cachedImage;
+        }
+    }
+
+    return QImage();
 }
 
-QList<QImage> BoardTheme::getAnimation(AnimationType type)
+BoardSprites BoardTheme::getPhaseSprites( int phase )
 {
-    return m_animationCache.at(type);
+    return m_phaseSprites.value( phase );
+}
+
+BoardSprites BoardTheme::getAnimationSprites( AnimationType type, int phase )
+{
+    return m_animationSprites.value( type * 5 + phase );
+}
+
+QImage BoardTheme::getBoardSprite( const BoardSprite_T &sprite, int frame )
+{
+    return m_tileTheme->getSprite( sprite.spriteId, sprite.rotation, sprite.animated ? frame : 0 );
+}
+
+void BoardTheme::drawBoardSprite( QPainter *painter, const QRectF &target, const BoardSprite_T &sprite, int frame )
+{
+    m_tileTheme->drawSprite( painter, target, sprite.spriteId, sprite.rotation, sprite.animated ? frame : 0 );
+}
+
+QColor BoardTheme::getBoardSpriteColor( const BoardSprite_T &sprite, int frame )
+{
+    return m_tileTheme->spriteColor( sprite.spriteId, sprite.rotation, sprite.animated ? frame : 0 );
 }
 
 QImage BoardTheme::getPhaseLayer()
@@ -76,33 +173,62 @@ QImage BoardTheme::getPhaseLayer()
 
 void BoardTheme::generateBoardCache()
 {
-    if( m_renderer->isRunning() ) {
-        m_renderer->abort();
-        m_renderer->wait();
+    // chunks still rendered for the old board are dropped when they arrive
+    m_cacheGeneration++;
+    m_pendingChunks.clear();
+    m_chunkCache.clear();
+    m_chunkCache.setMaxCost( Core::ClientSettings::values().boardCacheSize * 1024 );
+
+    m_phaseSprites.clear();
+    for( int phase = 0; phase < 5; phase++ ) {
+        m_phaseSprites.append( m_renderer->phaseSprites( phase ) );
     }
 
-    m_boardImage.clear();
-    m_animationCache.clear();
+    m_animationSprites.clear();
+    m_animationSprites.resize( MAX_ANIMATIONS * 5 );
+
+    if( Core::ClientSettings::values().useAnimation ) {
+        for( int a = 0; a < MAX_ANIMATIONS; a++ ) {
+            for( int phase = 0; phase < 5; phase++ ) {
+                m_animationSprites[a * 5 + phase] = m_renderer->animationSprites(( AnimationType )a, phase );
+            }
+        }
+    }
 
-    m_renderer->start();
+    // the chunks are rendered again the next time they are painted
+    emit boardUpdateAvailable();
+    for( int a = 0; a < MAX_ANIMATIONS; a++ ) {
+        emit animationUpdateAvailable(( AnimationType )a );
+    }
+
+    // the running thread is not waited for, rendererFinished() starts it again
+    if( m_renderer->isRunning() ) {
+        m_renderer->abort();
+        m_restartRenderer = true;
+    }
+    else {
+        m_renderer->start();
+    }
 }
 
-void BoardTheme::updateBoardCache( QImage newCache, int phase )
+void BoardTheme::rendererFinished()
 {
-    m_mutex.lock();
-    m_boardImage.insert(phase, newCache);
-    m_mutex.unlock();
-
-    emit boardUpdateAvailable();
+    if( m_restartRenderer ) {
+        m_restartRenderer = false;
+        m_renderer->start();
+    }
 }
 
-void BoardTheme::updateAnimationCache( AnimationType type, BoardCache newCache )
+void BoardTheme::insertBoardChunk( quint64 key, quint32 generation, QImage chunkImage )
 {
-    m_mutex.lock();
-    m_animationCache.insert(type, newCache);
-    m_mutex.unlock();
+    if( generation != m_cacheGeneration ) {
+        return;
+    }
+
+    m_pendingChunks.remove( key );
+    m_chunkCache.insert( key, new QImage( chunkImage ), qMax( 1, chunkImage.byteCount() / 1024 ) );
 
-    emit animationUpdateAvailable(type);
+    emit boardChunkAvailable( chunkRect( chunkFromKey( key ) ) );
 }
 
 void BoardTheme::updatePhaseLayerCache(QImage newCache)
@@ -21,11 +21,18 @@
 #include <QObject>
 
 #include <QImage>
-#include <QList>
+#include <QCache>
+#include <QSet>
+#include <QVector>
+#include <QPoint>
+#include <QRect>
 #include <QMutex>
+#include <QColor>
 
 #include "boardrenderer.h"
 
+class QPainter;
+
 namespace BotRace {
 namespace Core {
 class BoardManager;
@@ -34,6 +41,11 @@ class BoardManager;
 namespace Renderer {
 class TileTheme;
 
+/**
+ * @brief Edge length of one board chunk in pixel
+ */
+const int BOARD_CHUNK_SIZE = 256;
+
 /**
  * @brief theme for the board scenario
  *
@@ -41,8 +53,21 @@ class TileTheme;
  * rendererd from Svg files. Instead it stitch the tiles from the TileTheme together
  * in the right manner.
  *
- * This class holds the BoardRenderer thread, the Image cache for the board and all
- * animations and some getter functions to get the right board image
+ * The board is split into chunks of BOARD_CHUNK_SIZE pixel. A chunk is rendered by the
+ * BoardRenderer the first time it is requested, so only the visible parts of the board
+ * are ever rendered. The rendering runs in the pool of the BoardRenderer and never blocks
+ * the caller, boardChunkAvailable() is emitted once the chunk is in the cache. All chunks share one cache which drops the least recently used chunks
+ * when the memory budget from the @c Game/board_cache_size setting (in MB) is exceeded.
+ *
+ * Zoomed out views request the chunks in a lower detail level, see detailLevel(). Each level
+ * has its own chunks in the cache, so the full resolution chunks are not needed for them.
+ *
+ * Only the base board of the first phase is kept as chunks. The tiles that look different
+ * in the other phases and the animations are kept as lists of sprites for each phase, the
+ * sprite images come from the TileTheme when they are painted.
+ *
+ * This class holds the BoardRenderer thread, the chunk cache for the board, the sprite
+ * lists of all animations and some getter functions to get the right board chunk
  *
 */
 class BoardTheme : public QObject {
@@ -68,25 +93,99 @@ public:
     void setBoardScenario( Core::BoardManager *scenario );
 
     /**
-     * @brief Returns the basic board image
+     * @brief Size of the full board in pixel with the current tile scale
+     *
+     * @return size of the board or an empty size if it can't be rendered yet
+    */
+    QSize boardSize() const;
+
+    /**
+     * @brief Returns the part of the board covered by a chunk
+     *
+     * @param chunk column and row of the chunk
+     * @return the chunk rect in board pixel, clipped to the board
+    */
+    QRect chunkRect( const QPoint &chunk ) const;
+
+    /**
+     * @brief Picks the detail level for a view that shows the board with @p scale
      *
-     * @return full board image
+     * @param scale device pixel per board pixel of the view
+     * @return the lowest detail level that has at least the resolution of the view
     */
-    QImage getBoard(int phase);
+    int detailLevel( qreal scale ) const;
 
     /**
-     * @brief returns the images for the animation of all frames
+     * @brief Returns if the tiles are drawn as flat colors in @p detailLevel
+     *
+     * Sprites on top of the board should be drawn with getBoardSpriteColor() then.
+    */
+    bool isFlat( int detailLevel ) const;
+
+    /**
+     * @brief Returns chunks of the basic board
+     *
+     * The chunks show the board of the first phase, use getPhaseSprites() for all others.
+     * All chunks that are not in the cache are rendered in the background. Until then the
+     * chunk of another detail level is returned, or a null image if none is cached.
+     *
+     * @param chunks column and row of each chunk
+     * @param detailLevel the detail level from detailLevel()
+     * @return images of the chunks in the order of @p chunks
+    */
+    QList<QImage> getBoardChunks( const QList<QPoint> &chunks, int detailLevel = 0 );
+
+    /**
+     * @brief returns the tiles that look different in @p phase than on the basic board
+     *
+     * @param phase the phase the board is shown for (0-4)
+     * @return all sprites that have to be drawn on top of the basic board
+     */
+    BoardSprites getPhaseSprites( int phase );
+
+    /**
+     * @brief returns the sprites of an animation
      *
      * @param type the type of the used animation
-     * @return all QImages that make up the animation
+     * @param phase the phase the animation runs in (0-4)
+     * @return all sprites that make up the animation
+     */
+    BoardSprites getAnimationSprites( AnimationType type, int phase );
+
+    /**
+     * @brief returns the image of a board sprite
+     *
+     * @param sprite the sprite from getAnimationSprites() or getPhaseSprites()
+     * @param frame the current animation frame (0-4)
+     * @return image from the TileTheme, frame 0 for sprites that are not animated
+     */
+    QImage getBoardSprite( const BoardSprite_T &sprite, int frame );
+
+    /**
+     * @brief draws a board sprite directly from the sprite atlas
+     *
+     * @param painter the painter to draw with
+     * @param target the area the sprite is scaled into
+     * @param sprite the sprite from getAnimationSprites() or getPhaseSprites()
+     * @param frame the current animation frame (0-4)
      */
-    QList<QImage> getAnimation(AnimationType type);
+    void drawBoardSprite( QPainter *painter, const QRectF &target, const BoardSprite_T &sprite, int frame );
+
+    /**
+     * @brief returns the average color of a board sprite for flat detail levels
+     *
+     * @param sprite the sprite from getAnimationSprites() or getPhaseSprites()
+     * @param frame the current animation frame (0-4)
+     */
+    QColor getBoardSpriteColor( const BoardSprite_T &sprite, int frame );
 
     QImage getPhaseLayer();
 
 public slots:
     /**
-     * @brief starts the BoardRenderThread
+     * @brief Drops all cached chunks and starts the BoardRenderThread
+     *
+     * A running BoardRenderThread is aborted and started again once it finished.
     */
     void generateBoardCache();
 
@@ -102,6 +201,13 @@ signals:
     */
     void animationUpdateAvailable(BotRace::Renderer::AnimationType type);
 
+    /**
+     * @brief emitted when a chunk requested with getBoardChunks() is in the cache
+     *
+     * @param rect the part of the board covered by the chunk in board pixel
+    */
+    void boardChunkAvailable( const QRect &rect );
+
     /**
      * @brief emitted when the phase layer is ready
      */
@@ -109,30 +215,39 @@ signals:
 
 private slots:
     /**
-     * @brief updates the internal cache
-     *
-     * @param newCache new cache
-    */
-    void updateBoardCache( QImage newCache, int phase );
+     * @brief updates the internal phase layer cahce
+     * @param newCache the new cache
+     */
+    void updatePhaseLayerCache(QImage newCache);
+
     /**
-     * @brief updates the internal animation cache
+     * @brief Adds a chunk rendered in the background to the cache
      *
-     * @param newCache new cache
-    */
-    void updateAnimationCache( BotRace::Renderer::AnimationType type, BoardCache newCache );
+     * Chunks of a generation before the last generateBoardCache() are dropped.
+     */
+    void insertBoardChunk( quint64 key, quint32 generation, QImage chunkImage );
 
     /**
-     * @brief updates the internal phase layer cahce
-     * @param newCache the new cache
+     * @brief Starts the BoardRenderThread again if it was aborted by generateBoardCache()
      */
-    void updatePhaseLayerCache(QImage newCache);
+    void rendererFinished();
 
 private:
-    QList<QImage> m_boardImage;               /**< Board image cache 1 image for each phase (1-5) as some elements change its appearance (flame thrower)*/
-    QList< QList<QImage> > m_animationCache;  /**< animation cache */
+    /**
+     * @brief Returns a cached chunk of another detail level to show until the requested one is rendered
+     */
+    QImage placeholderChunk( const QPoint &chunk, int detailLevel );
+
+    QCache<quint64, QImage> m_chunkCache;     /**< Rendered board chunks, the cost is the size in kB */
+    QSet<quint64> m_pendingChunks;            /**< Chunks requested from the BoardRenderer but not received yet */
+    quint32 m_cacheGeneration;                /**< Counts the generateBoardCache() calls, to drop outdated chunks */
+    bool m_restartRenderer;                   /**< The aborted BoardRenderThread has to run again */
+    QVector<BoardSprites> m_phaseSprites;     /**< Tiles of each phase that differ from the basic board */
+    QVector<BoardSprites> m_animationSprites; /**< Sprites of each animation type and phase */
     QImage m_phaseLayer;                      /**< Cache for the phase active icons */
     QMutex m_mutex;                           /**< Locks the cache so only 1 thread can change it */
 
+    TileTheme *m_tileTheme;                   /**< Theme to get the animation sprites from */
     BoardRenderer *m_renderer;                /**< Render thread */
 };
 
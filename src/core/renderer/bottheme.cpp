@@ -23,6 +23,12 @@ using namespace Renderer;
 BotTheme::BotTheme( QStringList spriteList, qreal scale ) :
     SvgTheme( spriteList, scale )
 {
+    m_botIds.fill( -1, Core::MAX_ROBOTS );
+    m_virtualBotIds.fill( -1, Core::MAX_ROBOTS );
+    for( int i = Core::ROBOT_1; i < Core::MAX_ROBOTS; i++ ) {
+        m_botIds[i] = spriteId( QString( "Robot_%1" ).arg( i ) );
+        m_virtualBotIds[i] = spriteId( QString( "Robot_%1_Virtual" ).arg( i ) );
+    }
 }
 
 BotTheme::~BotTheme()
@@ -37,14 +43,19 @@ QImage BotTheme::getBot( const QString &name, int frame )
 
 QImage BotTheme::getBot( Core::RobotType type, int frame )
 {
-    QString elementID = QString( "Robot_%1" ).arg( type );
-
-    return getImage( elementID, 0, frame );
+    return getSprite( m_botIds.value( type, -1 ), 0, frame );
 }
 
 QImage BotTheme::getVirtualBot( Core::RobotType type, int frame )
 {
-    QString elementID = QString( "Robot_%1_Virtual" ).arg( type );
+    return getSprite( m_virtualBotIds.value( type, -1 ), 0, frame );
+}
+
+int BotTheme::botId( Core::RobotType type, bool virtualBot ) const
+{
+    if( virtualBot ) {
+        return m_virtualBotIds.value( type, -1 );
+    }
 
-    return getImage( elementID, 0, frame );
+    return m_botIds.value( type, -1 );
 }
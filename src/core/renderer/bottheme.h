@@ -29,7 +29,7 @@ namespace Renderer {
  * @brief Sprites for the robots and robot damage animation
  *
  * Basically just a normal SvgTheme with some additional methods to get
- * the sprite from the Core::RobotType
+ * the sprite from the Core::RobotType via the sprite table
  *
 */
 class BotTheme : public SvgTheme {
@@ -81,6 +81,19 @@ public:
      * @return QImage image from the cache
     */
     QImage getVirtualBot( Core::RobotType type, int frame = 0 );
+
+    /**
+     * @brief Returns the sprite id of a robot for the use with drawSprite()
+     *
+     * @param type of the robot
+     * @param virtualBot true for the sprite of the virtual robot
+     * @return the sprite id or -1 if the robot is not part of the theme
+    */
+    int botId( Core::RobotType type, bool virtualBot = false ) const;
+
+private:
+    QVector<int> m_botIds;          /**< Sprite id for each RobotType */
+    QVector<int> m_virtualBotIds;   /**< Sprite id of the virtual robot for each RobotType */
 };
 
 }
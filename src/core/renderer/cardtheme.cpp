@@ -25,6 +25,15 @@ using namespace Renderer;
 CardTheme::CardTheme( QStringList spriteList, qreal scale ) :
     SvgTheme( spriteList, scale )
 {
+    m_cardIds.fill( -1, Core::MAX_CARDS );
+    for( int i = Core::CARD_BACK; i < Core::MAX_CARDS; i++ ) {
+        m_cardIds[i] = spriteId( cardToSvg(( Core::CardType )i ) );
+    }
+
+    m_numberIds.fill( -1, 10 );
+    for( int i = 0; i < 10; i++ ) {
+        m_numberIds[i] = spriteId( QString( "Number_%1" ).arg( i ) );
+    }
 }
 
 CardTheme::~CardTheme()
@@ -42,32 +51,29 @@ QImage CardTheme::getCard( Core::GameCard_T card )
     qreal pX = getScale() * m_themeDetails.priorityPos.x();
     qreal pY = getScale() * m_themeDetails.priorityPos.y();
 
-    QString priorityString;
-    if( card.priority > 99 ) {
-        priorityString = QString( "%1" ).arg( card.priority );
-    }
-    else if( card.priority > 9 ) {
-        priorityString = QString( "0%1" ).arg( card.priority );
-    }
-    else {
-        priorityString = QString( "00%1" ).arg( card.priority );
+    // priorities are printed with 3 digits
+    int priority = qBound( 0, ( int )card.priority, 999 );
+
+    // the card background is painted on, so it needs its own copy
+    QImage cardImage = getSprite( m_cardIds.value( card.type, -1 ) );
+    if( cardImage.isNull() ) {
+        return cardImage;
     }
 
-    // Get the Card Images
-    QImage cardImage = getImage( cardToSvg( card.type ) );
-    QImage number1   = getImage( QString( "Number_%1" ).arg( priorityString.at( 0 ) ) );
-    QImage number2   = getImage( QString( "Number_%1" ).arg( priorityString.at( 1 ) ) );
-    QImage number3   = getImage( QString( "Number_%1" ).arg( priorityString.at( 2 ) ) );
+    int number1 = m_numberIds.at( priority / 100 );
+    int number2 = m_numberIds.at(( priority / 10 ) % 10 );
+    int number3 = m_numberIds.at( priority % 10 );
 
-    qreal pW = number1.width();
+    QSize numberSize = spriteSize( number1 );
+    qreal pW = numberSize.width();
 
     QPainter cardPainter;
     cardPainter.begin( &cardImage );
 
-    //draw numbers at desired position
-    cardPainter.drawImage( pX, pY,        number1 );
-    cardPainter.drawImage( pX + pW, pY,     number2 );
-    cardPainter.drawImage( pX + ( 2 * pW ), pY, number3 );
+    //draw numbers at desired position straight from the atlas
+    drawSprite( &cardPainter, QRectF( QPointF( pX, pY ), numberSize ), number1 );
+    drawSprite( &cardPainter, QRectF( QPointF( pX + pW, pY ), numberSize ), number2 );
+    drawSprite( &cardPainter, QRectF( QPointF( pX + ( 2 * pW ), pY ), numberSize ), number3 );
 
     cardPainter.end();
 
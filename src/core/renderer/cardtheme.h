@@ -91,6 +91,8 @@ protected:
 
 private:
     CardThemeDetails_T m_themeDetails; /**< Holds the additional theme details */
+    QVector<int> m_cardIds;            /**< Sprite id for each CardType */
+    QVector<int> m_numberIds;          /**< Sprite id for the priority digits 0-9 */
 
 };
 
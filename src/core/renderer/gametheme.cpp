@@ -24,9 +24,9 @@
 #include "tiletheme.h"
 
 #include "../engine/boardmanager.h"
+#include "../engine/clientsettings.h"
 
 #include <QStringList>
-#include <QSettings>
 
 #include <QDebug>
 
@@ -238,9 +238,7 @@ void GameTheme::createRenderer()
 
     //##################
     // Add animated sprites here
-    QSettings settings;
-    bool useAnimations = settings.value( "Game/use_animation", false ).toBool();
-    if( useAnimations ) {
+    if( Core::ClientSettings::values().useAnimation ) {
         for( int f = 1; f < 5; f++ ) {
             tileSprites.append( QString( "Floor_Conv_1_Straight_%1" ).arg( f ) );
             tileSprites.append( QString( "Floor_Conv_1_Curved_Right_%1" ).arg( f ) );
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "paintprofiler.h"
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QList>
+#include <QTextStream>
+
+#include <QDebug>
+
+using namespace BotRace;
+using namespace Renderer;
+
+#define PROFILER_HISTORY 600
+
+namespace {
+
+const char *sectionNames[PROFILE_SECTION_COUNT] = {
+    "gameboard",
+    "board_animation",
+    "robot",
+    "laser",
+    "flag",
+    "theme_renderer",
+    "board_renderer"
+};
+
+const char *counterNames[PROFILE_COUNTER_COUNT] = {
+    "image_cache_misses",
+    "sprite_misses",
+    "chunk_misses"
+};
+
+struct ProfilerFrame_T {
+    int interval;                           /**< usecs since the begin of the frame before */
+    int paintTime;                          /**< usecs from beginFrame() to endFrame() */
+    int sections[PROFILE_SECTION_COUNT];    /**< usecs of each section */
+    int counters[PROFILE_COUNTER_COUNT];    /**< events of each counter */
+};
+
+QAtomicInt enabled;
+QAtomicInt sectionTimes[PROFILE_SECTION_COUNT];
+QAtomicInt counters[PROFILE_COUNTER_COUNT];
+
+// only used from the gui thread
+QList<ProfilerFrame_T> history;
+QElapsedTimer clock;
+qint64 frameStart = -1;
+qint64 lastFrameStart = -1;
+
+qint64 now()
+{
+    return clock.nsecsElapsed() / 1000;
+}
+
+QString milliseconds( qint64 usecs )
+{
+    return QString::number( usecs / 1000.0, 'f', 2 );
+}
+
+}
+
+void PaintProfiler::setEnabled( bool enable )
+{
+    if( enable && !isEnabled() ) {
+        history.clear();
+        for( int s = 0; s < PROFILE_SECTION_COUNT; s++ ) {
+            sectionTimes[s].fetchAndStoreRelaxed( 0 );
+        }
+        for( int c = 0; c < PROFILE_COUNTER_COUNT; c++ ) {
+            counters[c].fetchAndStoreRelaxed( 0 );
+        }
+
+        clock.start();
+        frameStart = -1;
+        lastFrameStart = -1;
+    }
+
+    enabled.fetchAndStoreRelaxed( enable ? 1 : 0 );
+}
+
+bool PaintProfiler::isEnabled()
+{
+    return ( int )enabled != 0;
+}
+
+void PaintProfiler::addTime( ProfilerSection section, int usecs )
+{
+    if( isEnabled() ) {
+        sectionTimes[section].fetchAndAddRelaxed( usecs );
+    }
+}
+
+void PaintProfiler::add( ProfilerCounter counter, int value )
+{
+    if( isEnabled() ) {
+        counters[counter].fetchAndAddRelaxed( value );
+    }
+}
+
+void PaintProfiler::beginFrame()
+{
+    if( !isEnabled() ) {
+        return;
+    }
+
+    frameStart = now();
+}
+
+void PaintProfiler::endFrame()
+{
+    if( !isEnabled() || frameStart < 0 ) {
+        return;
+    }
+
+    ProfilerFrame_T frame;
+    frame.interval = lastFrameStart < 0 ? 0 : ( int )( frameStart - lastFrameStart );
+    frame.paintTime = ( int )( now() - frameStart );
+
+    // time and events of the render threads count for the frame they finished in
+    for( int s = 0; s < PROFILE_SECTION_COUNT; s++ ) {
+        frame.sections[s] = sectionTimes[s].fetchAndStoreRelaxed( 0 );
+    }
+    for( int c = 0; c < PROFILE_COUNTER_COUNT; c++ ) {
+        frame.counters[c] = counters[c].fetchAndStoreRelaxed( 0 );
+    }
+
+    history.append( frame );
+    while( history.size() > PROFILER_HISTORY ) {
+        history.removeFirst();
+    }
+
+    lastFrameStart = frameStart;
+    frameStart = -1;
+}
+
+QString PaintProfiler::overlayText()
+{
+    QString text;
+    QTextStream out( &text );
+
+    out << "frames: " << history.size();
+    if( history.isEmpty() ) {
+        out.flush();
+        return text;
+    }
+
+    qint64 intervalSum = 0;
+    int intervals = 0;
+    qint64 paintSum = 0;
+    int paintMax = 0;
+    qint64 sectionSum[PROFILE_SECTION_COUNT] = {0};
+    int sectionMax[PROFILE_SECTION_COUNT] = {0};
+    qint64 counterSum[PROFILE_COUNTER_COUNT] = {0};
+
+    foreach( const ProfilerFrame_T & frame, history ) {
+        if( frame.interval > 0 ) {
+            intervalSum += frame.interval;
+            intervals++;
+        }
+        paintSum += frame.paintTime;
+        paintMax = qMax( paintMax, frame.paintTime );
+
+        for( int s = 0; s < PROFILE_SECTION_COUNT; s++ ) {
+            sectionSum[s] += frame.sections[s];
+            sectionMax[s] = qMax( sectionMax[s], frame.sections[s] );
+        }
+        for( int c = 0; c < PROFILE_COUNTER_COUNT; c++ ) {
+            counterSum[c] += frame.counters[c];
+        }
+    }
+
+    int frames = history.size();
+
+    if( intervals > 0 && intervalSum > 0 ) {
+        out << "  fps: " << QString::number( 1000000.0 * intervals / intervalSum, 'f', 1 );
+    }
+    out << "\n";
+
+    // times are averages per frame, the maximum in brackets
+    out << "paint: " << milliseconds( paintSum / frames ) << " ms (" << milliseconds( paintMax ) << ")\n";
+    for( int s = 0; s < PROFILE_SECTION_COUNT; s++ ) {
+        out << sectionNames[s] << ": " << milliseconds( sectionSum[s] / frames )
+            << " ms (" << milliseconds( sectionMax[s] ) << ")\n";
+    }
+
+    for( int c = 0; c < PROFILE_COUNTER_COUNT; c++ ) {
+        out << counterNames[c] << ": " << counterSum[c] << "\n";
+    }
+
+    out.flush();
+    return text.trimmed();
+}
+
+bool PaintProfiler::exportCsv( const QString &fileName )
+{
+    QDir().mkpath( QFileInfo( fileName ).absolutePath() );
+
+    QFile file( fileName );
+    if( !file.open( QIODevice::WriteOnly | QIODevice::Text ) ) {
+        qWarning() << "PaintProfiler::exportCsv || could not write" << fileName << file.errorString();
+        return false;
+    }
+
+    QTextStream out( &file );
+
+    out << "frame,interval_us,paint_us";
+    for( int s = 0; s < PROFILE_SECTION_COUNT; s++ ) {
+        out << "," << sectionNames[s] << "_us";
+    }
+    for( int c = 0; c < PROFILE_COUNTER_COUNT; c++ ) {
+        out << "," << counterNames[c];
+    }
+    out << "\n";
+
+    for( int i = 0; i < history.size(); i++ ) {
+        const ProfilerFrame_T &frame = history.at( i );
+
+        out << i << "," << frame.interval << "," << frame.paintTime;
+        for( int s = 0; s < PROFILE_SECTION_COUNT; s++ ) {
+            out << "," << frame.sections[s];
+        }
+        for( int c = 0; c < PROFILE_COUNTER_COUNT; c++ ) {
+            out << "," << frame.counters[c];
+        }
+        out << "\n";
+    }
+
+    out.flush();
+    return true;
+}
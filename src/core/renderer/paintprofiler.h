@@ -0,0 +1,147 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAINTPROFILER_H
+#define PAINTPROFILER_H
+
+#include <QString>
+#include <QElapsedTimer>
+
+namespace BotRace {
+namespace Renderer {
+
+/**
+ * @brief Parts of the client whose time is measured by the PaintProfiler
+ */
+enum ProfilerSection {
+    PROFILE_GAMEBOARD,          /**< GameBoard::paint() */
+    PROFILE_BOARD_ANIMATION,    /**< GameBoardAnimation::paint() */
+    PROFILE_ROBOT,              /**< RobotItem::paint() */
+    PROFILE_LASER,              /**< LaserItem::paint() */
+    PROFILE_FLAG,               /**< FlagItem::paint() */
+    PROFILE_THEME_RENDERER,     /**< ThemeRenderer thread rendering svg sprites */
+    PROFILE_BOARD_RENDERER,     /**< BoardRenderer drawing board chunks and the phase layer, in all threads */
+    PROFILE_SECTION_COUNT
+};
+
+/**
+ * @brief Events counted by the PaintProfiler
+ */
+enum ProfilerCounter {
+    PROFILE_IMAGE_CACHE_MISSES, /**< SvgTheme::getImage() calls without a cached sprite */
+    PROFILE_SPRITE_MISSES,      /**< sprite id lookups without a cached sprite */
+    PROFILE_CHUNK_MISSES,       /**< board chunks that had to be rendered */
+    PROFILE_COUNTER_COUNT
+};
+
+/**
+ * @brief Frame time and paint time profiler for the GameScene
+ *
+ * The GameScene marks the begin and end of each painted frame. In between the paint functions
+ * of the items and the render threads add their time to the current frame with a ProfileTimer,
+ * the themes count their cache misses. Each finished frame is kept in a history of the last
+ * PROFILER_HISTORY frames.
+ *
+ * The profiler is disabled by default. All functions return at once then, a ProfileTimer only
+ * checks one flag. The values are atomic integers, so the render threads add their time without locking.
+ *
+ * overlayText() sums up the history for the overlay of the GameView, exportCsv() writes one line
+ * for each frame of the history.
+*/
+class PaintProfiler {
+public:
+    /**
+     * @brief Starts or stops the profiling, the history is cleared on start
+    */
+    static void setEnabled( bool enable );
+
+    /**
+     * @brief Returns if the profiler records frames
+    */
+    static bool isEnabled();
+
+    /**
+     * @brief Adds @p usecs microseconds to @p section of the current frame
+    */
+    static void addTime( ProfilerSection section, int usecs );
+
+    /**
+     * @brief Adds @p value to the counter of the current frame
+    */
+    static void add( ProfilerCounter counter, int value = 1 );
+
+    /**
+     * @brief Marks the begin of a frame, called before the scene is painted
+    */
+    static void beginFrame();
+
+    /**
+     * @brief Finishes the current frame and adds it to the history, called after the scene is painted
+    */
+    static void endFrame();
+
+    /**
+     * @brief Returns the averages and maximum values of the frame history, one value per line
+    */
+    static QString overlayText();
+
+    /**
+     * @brief Writes the frame history as CSV file
+     *
+     * @param fileName the file to write, the directory is created if necessary
+     * @return @c false if the file could not be written
+    */
+    static bool exportCsv( const QString &fileName );
+};
+
+/**
+ * @brief Measures the time of its own scope for a section of the PaintProfiler
+ *
+ * Does nothing besides checking PaintProfiler::isEnabled() if the profiler is disabled.
+ */
+class ProfileTimer {
+public:
+    /**
+     * @brief Starts measuring if the profiler is enabled
+    */
+    explicit ProfileTimer( ProfilerSection section ) :
+        m_section( section ),
+        m_running( PaintProfiler::isEnabled() ) {
+        if( m_running ) {
+            m_timer.start();
+        }
+    }
+
+    /**
+     * @brief Adds the time since the constructor to the section
+    */
+    ~ProfileTimer() {
+        if( m_running ) {
+            PaintProfiler::addTime( m_section, ( int )( m_timer.nsecsElapsed() / 1000 ) );
+        }
+    }
+
+private:
+    ProfilerSection m_section;  /**< the measured section */
+    bool m_running;             /**< @c true if the profiler was enabled at the start */
+    QElapsedTimer m_timer;      /**< measures the scope */
+};
+
+}
+}
+
+#endif // PAINTPROFILER_H
@@ -13,7 +13,9 @@ HEADERS += \
     renderer/boardrenderer.h \
     renderer/boardtheme.h \
     renderer/tiletheme.h \
-    renderer/bottheme.h
+    renderer/bottheme.h \
+    renderer/spritecache.h \
+    renderer/paintprofiler.h
 
 SOURCES += \
     renderer/svgtheme.cpp \
@@ -24,4 +26,6 @@ SOURCES += \
     renderer/boardrenderer.cpp \
     renderer/boardtheme.cpp \
     renderer/tiletheme.cpp \
-    renderer/bottheme.cpp
+    renderer/bottheme.cpp \
+    renderer/spritecache.cpp \
+    renderer/paintprofiler.cpp
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spritecache.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <QDebug>
+
+using namespace BotRace;
+using namespace Renderer;
+
+static const quint32 ATLAS_MAGIC = 0x42525341; // "BRSA"
+static const quint32 ATLAS_VERSION = 2;
+
+QByteArray SpriteCache::themeHash( const QString &svgFile )
+{
+    QFile file( svgFile );
+    if( !file.open( QIODevice::ReadOnly ) ) {
+        return QByteArray();
+    }
+
+    return QCryptographicHash::hash( file.readAll(), QCryptographicHash::Sha1 );
+}
+
+QString SpriteCache::atlasFile( const QByteArray &themeHash, const QStringList &spriteList, qreal scale, bool rotateSprites )
+{
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    hash.addData( themeHash );
+    hash.addData( spriteList.join( "," ).toUtf8() );
+    hash.addData( QByteArray::number( scale, 'g', 10 ) );
+    hash.addData( rotateSprites ? "1" : "0" );
+
+    return QString( "%1/.%2/cache/sprites/%3.atlas" )
+           .arg( QDir::homePath() )
+           .arg( QCoreApplication::applicationName() )
+           .arg( QString::fromLatin1( hash.result().toHex() ) );
+}
+
+bool SpriteCache::loadAtlas( const QString &fileName, SpriteAtlas_T &atlas )
+{
+    QFile file( fileName );
+    if( !file.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    QDataStream instream( &file );
+    instream.setVersion( QDataStream::Qt_4_6 );
+
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    instream >> magic >> version >> count;
+
+    QMap<QString, QRect> rects;
+    qint32 width = 0;
+    qint32 height = 0;
+    qint32 bytesPerLine = 0;
+
+    if( magic == ATLAS_MAGIC && version == ATLAS_VERSION ) {
+        for( quint32 i = 0; i < count && instream.status() == QDataStream::Ok; i++ ) {
+            QString name;
+            QRect rect;
+            instream >> name >> rect;
+            rects.insert( name, rect );
+        }
+
+        instream >> width >> height >> bytesPerLine;
+    }
+
+    // the pixel data starts directly behind the header
+    qint64 dataStart = file.pos();
+    qint64 length = ( qint64 )height * bytesPerLine;
+    QRect imageRect( 0, 0, width, height );
+
+    bool valid = instream.status() == QDataStream::Ok && rects.size() == ( int )count && count > 0
+                 && width > 0 && height > 0 && bytesPerLine >= width * 4
+                 && dataStart + length <= file.size();
+
+    foreach( const QRect & rect, rects ) {
+        if( !imageRect.contains( rect ) ) {
+            valid = false;
+        }
+    }
+
+    // the pixels are read line by line straight into the image, the stored lines may be padded differently
+    QImage image;
+    if( valid ) {
+        image = QImage( width, height, QImage::Format_ARGB32_Premultiplied );
+        valid = !image.isNull();
+    }
+
+    for( int y = 0; valid && y < height; y++ ) {
+        valid = file.seek( dataStart + ( qint64 )y * bytesPerLine )
+                && file.read( reinterpret_cast<char *>( image.scanLine( y ) ), width * 4 ) == width * 4;
+    }
+
+    if( !valid ) {
+        qWarning() << "SpriteCache::loadAtlas || broken cache file" << file.fileName();
+        file.remove();
+        return false;
+    }
+
+    atlas.image = image;
+    atlas.rects = rects;
+
+    file.close();
+
+    touchAtlas( fileName );
+
+    return true;
+}
+
+void SpriteCache::storeAtlas( const QString &fileName, const SpriteAtlas_T &atlas )
+{
+    if( atlas.rects.isEmpty() ) {
+        return;
+    }
+
+    QFileInfo info( fileName );
+    QDir().mkpath( info.absolutePath() );
+
+    QFile file( QString( "%1.tmp" ).arg( info.absoluteFilePath() ) );
+    if( !file.open( QIODevice::WriteOnly ) ) {
+        qWarning() << "SpriteCache::storeAtlas || could not write" << file.fileName() << file.errorString();
+        return;
+    }
+
+    QImage image = atlas.image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+
+    QDataStream outstream( &file );
+    outstream.setVersion( QDataStream::Qt_4_6 );
+    outstream << ATLAS_MAGIC << ATLAS_VERSION << ( quint32 )atlas.rects.size();
+
+    QMap<QString, QRect>::const_iterator it = atlas.rects.constBegin();
+    for( ; it != atlas.rects.constEnd(); ++it ) {
+        outstream << it.key() << it.value();
+    }
+
+    outstream << ( qint32 )image.width() << ( qint32 )image.height() << ( qint32 )image.bytesPerLine();
+    file.write( reinterpret_cast<const char *>( image.bits() ), ( qint64 )image.height() * image.bytesPerLine() );
+
+    if( outstream.status() != QDataStream::Ok || file.error() != QFile::NoError ) {
+        qWarning() << "SpriteCache::storeAtlas || could not write" << file.fileName() << file.errorString();
+        file.remove();
+        return;
+    }
+
+    file.close();
+
+    QFile::remove( info.absoluteFilePath() );
+    if( !file.rename( info.absoluteFilePath() ) ) {
+        qWarning() << "SpriteCache::storeAtlas || could not rename" << file.fileName() << file.errorString();
+        file.remove();
+        return;
+    }
+
+    removeOldAtlases( info.absolutePath() );
+}
+
+void SpriteCache::removeOldAtlases( const QString &path )
+{
+    QFileInfoList atlases = QDir( path ).entryInfoList( QStringList() << "*.atlas", QDir::Files, QDir::Time );
+
+    // sorted by time, the most recently used first
+    for( int i = MAX_SPRITE_ATLASES; i < atlases.size(); i++ ) {
+        QFile::remove( atlases.at( i ).absoluteFilePath() );
+    }
+}
+
+void SpriteCache::touchAtlas( const QString &fileName )
+{
+    // Qt4 can not set the modification time, writing the unchanged magic number updates it as well
+    QFile file( fileName );
+    if( !file.open( QIODevice::ReadWrite ) ) {
+        return;
+    }
+
+    QByteArray magic = file.read( sizeof( ATLAS_MAGIC ) );
+    if( magic.size() == ( int )sizeof( ATLAS_MAGIC ) && file.seek( 0 ) ) {
+        file.write( magic );
+    }
+}
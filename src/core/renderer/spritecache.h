@@ -0,0 +1,111 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPRITECACHE_H
+#define SPRITECACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "themerenderer.h"
+
+namespace BotRace {
+namespace Renderer {
+
+/**
+ * @brief Max number of sprite atlas files kept on disk, the oldest ones are removed first
+ */
+const int MAX_SPRITE_ATLASES = 16;
+
+/**
+ * @brief Keeps rendered theme sprites on disk, so they are not rasterized again on the next start
+ *
+ * The SpriteAtlas_T of one theme at one scale is stored as one atlas file. The file name is the hash of
+ * the svg file content, the sprite list, the scale and if rotated sprites are used, so a changed theme
+ * file never hits an old atlas.
+ *
+ * <b> Atlas file layout: </b>
+ * @li @c header magic, version and number of sprites
+ * @li @c index name and rect of each sprite, as in the SpriteAtlas_T
+ * @li @c image width, height and bytes per line of the atlas image
+ * @li @c data the raw ARGB32 premultiplied pixels of the atlas image
+ *
+ * The pixels are read directly into the atlas image when it is loaded, so the file is closed again
+ * at once and the atlas never depends on the file. The whole atlas is kept in memory.
+ *
+ * The atlas files are located in $HOME/.BotRace/cache/sprites.
+*/
+class SpriteCache {
+public:
+    /**
+     * @brief Calculates the content hash of a svg theme file
+     *
+     * @param svgFile the svg file with path
+     * @return the binary hash or an empty array if the file could not be read
+    */
+    static QByteArray themeHash( const QString &svgFile );
+
+    /**
+     * @brief Returns the atlas file for the sprites of a theme
+     *
+     * @param themeHash content hash of the svg file from themeHash()
+     * @param spriteList all rendered sprites
+     * @param scale the scale of the sprites
+     * @param rotateSprites if all rotations of the sprites are rendered
+     * @return the atlas file with path
+    */
+    static QString atlasFile( const QByteArray &themeHash, const QStringList &spriteList, qreal scale, bool rotateSprites );
+
+    /**
+     * @brief Loads the sprite atlas of an atlas file
+     *
+     * Broken atlas files are removed.
+     *
+     * @param fileName the atlas file
+     * @param atlas the loaded sprite atlas
+     * @return @c true if the atlas was found and could be read
+    */
+    static bool loadAtlas( const QString &fileName, SpriteAtlas_T &atlas );
+
+    /**
+     * @brief Stores the sprite atlas as atlas file
+     *
+     * The file is written under a temporary name and renamed afterwards, so a reader
+     * never sees a half written atlas.
+     *
+     * @param fileName the atlas file
+     * @param atlas the packed sprites
+    */
+    static void storeAtlas( const QString &fileName, const SpriteAtlas_T &atlas );
+
+private:
+    /**
+     * @brief Removes the least recently used atlas files if more than MAX_SPRITE_ATLASES exist
+    */
+    static void removeOldAtlases( const QString &path );
+
+    /**
+     * @brief Updates the modification time of a loaded atlas file, so removeOldAtlases() keeps it
+    */
+    static void touchAtlas( const QString &fileName );
+};
+
+}
+}
+
+#endif // SPRITECACHE_H
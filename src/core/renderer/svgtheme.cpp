@@ -16,8 +16,11 @@
  */
 
 #include "svgtheme.h"
+#include "spritecache.h"
+#include "paintprofiler.h"
 
 #include <QFileInfo>
+#include <QPainter>
 #include <QSettings>
 
 #include <QDebug>
@@ -27,16 +30,26 @@ using namespace Renderer;
 
 SvgTheme::SvgTheme( QStringList spriteList, qreal scale, bool rotateSprites ) :
     m_spriteList( spriteList ),
-    m_scale( scale )
+    m_scale( scale ),
+    m_rotateSprites( rotateSprites )
 
 {
+    // the ids are fixed by the sprite list, only the images change with theme and scale
+    for( int i = 0; i < m_spriteList.size(); i++ ) {
+        if( !m_spriteIds.contains( m_spriteList.at( i ) ) ) {
+            m_spriteIds.insert( m_spriteList.at( i ), i );
+        }
+    }
+
     m_renderer = new ThemeRenderer();
     m_renderer->createRotationSprites( rotateSprites );
     m_renderer->setSpriteList( m_spriteList );
     m_renderer->setScale( m_scale );
 
-    connect( m_renderer, SIGNAL( cacheUpdateReady( ImageCache ) ),
-             this, SLOT( updateCache( ImageCache ) ) );
+    connect( m_renderer, SIGNAL( atlasReady( SpriteAtlas_T ) ),
+             this, SLOT( updateAtlas( SpriteAtlas_T ) ) );
+    connect( m_renderer, SIGNAL( spritesReady( ImageCache ) ),
+             this, SLOT( addSprites( ImageCache ) ) );
 }
 
 SvgTheme::~SvgTheme()
@@ -56,9 +69,12 @@ void SvgTheme::changeThemeFile( const QString &themeName )
 
     readThemeFile();
 
-    m_renderer->setSvgThemeFile( QString( "%1/%2" ).arg( m_path ).arg( m_svgFile ) );
+    QString svgFile = QString( "%1/%2" ).arg( m_path ).arg( m_svgFile );
+    m_svgHash = SpriteCache::themeHash( svgFile );
 
-    m_renderer->start();
+    m_renderer->setSvgThemeFile( svgFile );
+
+    loadSprites();
 }
 
 QString SvgTheme::name()
@@ -88,7 +104,7 @@ QString SvgTheme::theme()
 
 bool SvgTheme::isValid()
 {
-    if( m_imageCache.isEmpty() ) {
+    if( m_imageCache.isEmpty() && m_atlas.rects.isEmpty() ) {
         return false;
     }
     else {
@@ -108,9 +124,133 @@ QImage SvgTheme::getImage( const QString &identifier, unsigned int orientation,
         cacheName = QString( "%1_%2" ).arg( identifier ).arg( orientation );
     }
 
+    QImage image = m_imageCache.value( cacheName );
+    if( image.isNull() && m_atlas.rects.contains( cacheName ) ) {
+        image = m_atlas.image.copy( m_atlas.rects.value( cacheName ) );
+    }
+
     m_mutex.unlock();
-    return m_imageCache.value( cacheName );
 
+    if( image.isNull() ) {
+        PaintProfiler::add( PROFILE_IMAGE_CACHE_MISSES );
+    }
+
+    return image;
+}
+
+int SvgTheme::spriteId( const QString &identifier ) const
+{
+    return m_spriteIds.value( identifier, -1 );
+}
+
+QImage SvgTheme::getSprite( int spriteId, unsigned int orientation, unsigned int frame )
+{
+    QImage image;
+    QRect source;
+    if( !findSprite( spriteId, orientation, frame, image, source ) ) {
+        return QImage();
+    }
+
+    if( source == image.rect() ) {
+        return image;
+    }
+
+    return image.copy( source );
+}
+
+void SvgTheme::drawSprite( QPainter *painter, const QRectF &target, int spriteId, unsigned int orientation, unsigned int frame )
+{
+    QImage image;
+    QRect source;
+    if( findSprite( spriteId, orientation, frame, image, source ) ) {
+        painter->drawImage( target, image, source );
+    }
+}
+
+QSize SvgTheme::spriteSize( int spriteId, unsigned int orientation, unsigned int frame )
+{
+    QImage image;
+    QRect source;
+    if( !findSprite( spriteId, orientation, frame, image, source ) ) {
+        return QSize();
+    }
+
+    return source.size();
+}
+
+QColor SvgTheme::spriteColor( int spriteId, unsigned int orientation, unsigned int frame )
+{
+    QImage image;
+    QRect source;
+    if( !findSprite( spriteId, orientation, frame, image, source ) ) {
+        return QColor();
+    }
+
+    int index = ( spriteId * SPRITE_FRAMES + frame ) * SPRITE_ROTATIONS + orientation;
+
+    m_mutex.lock();
+    QHash<int, QRgb>::const_iterator it = m_spriteColors.constFind( index );
+    if( it != m_spriteColors.constEnd() ) {
+        QRgb color = it.value();
+        m_mutex.unlock();
+        return QColor::fromRgba( color );
+    }
+    m_mutex.unlock();
+
+    // average of all premultiplied pixels, the same as a mipmap of 1 pixel
+    QImage sprite = image.copy( source ).convertToFormat( QImage::Format_ARGB32_Premultiplied );
+
+    qint64 red = 0;
+    qint64 green = 0;
+    qint64 blue = 0;
+    qint64 alpha = 0;
+    for( int y = 0; y < sprite.height(); y++ ) {
+        const QRgb *line = reinterpret_cast<const QRgb *>( sprite.scanLine( y ) );
+        for( int x = 0; x < sprite.width(); x++ ) {
+            red += qRed( line[x] );
+            green += qGreen( line[x] );
+            blue += qBlue( line[x] );
+            alpha += qAlpha( line[x] );
+        }
+    }
+
+    QColor color( Qt::transparent );
+    qint64 pixels = ( qint64 )sprite.width() * sprite.height();
+    if( alpha > 0 && pixels > 0 ) {
+        color = QColor( red * 255 / alpha, green * 255 / alpha, blue * 255 / alpha, alpha / pixels );
+    }
+
+    m_mutex.lock();
+    m_spriteColors.insert( index, color.rgba() );
+    m_mutex.unlock();
+
+    return color;
+}
+
+bool SvgTheme::findSprite( int spriteId, unsigned int orientation, unsigned int frame, QImage &image, QRect &source )
+{
+    if( spriteId < 0 || orientation >= ( unsigned int )SPRITE_ROTATIONS || frame >= ( unsigned int )SPRITE_FRAMES ) {
+        return false;
+    }
+
+    int index = ( spriteId * SPRITE_FRAMES + frame ) * SPRITE_ROTATIONS + orientation;
+
+    // only the shared image is copied under the lock, drawing happens without it
+    QMutexLocker locker( &m_mutex );
+    image = m_spriteTable.value( index );
+    if( !image.isNull() ) {
+        source = image.rect();
+        return true;
+    }
+
+    source = m_spriteRects.value( index );
+    if( source.isEmpty() ) {
+        PaintProfiler::add( PROFILE_SPRITE_MISSES );
+        return false;
+    }
+
+    image = m_atlas.image;
+    return true;
 }
 
 void SvgTheme::changeScale( qreal newScale )
@@ -121,11 +261,17 @@ void SvgTheme::changeScale( qreal newScale )
     }
 
     m_scale = newScale;
+    m_mutex.lock();
+    m_atlas = SpriteAtlas_T();
     m_imageCache.clear();
+    m_spriteTable.clear();
+    m_spriteRects.clear();
+    m_spriteColors.clear();
+    m_mutex.unlock();
 
     m_renderer->setScale( m_scale );
 
-    m_renderer->start();
+    loadSprites();
 }
 
 qreal SvgTheme::getScale()
@@ -188,12 +334,84 @@ void SvgTheme::readDefaultThemeInfos( const QSettings &themeSettings )
     }
 }
 
-void SvgTheme::updateCache( ImageCache newCache )
+void SvgTheme::updateAtlas( SpriteAtlas_T atlas )
 {
     m_mutex.lock();
+    m_atlas = atlas;
     m_imageCache.clear();
-    m_imageCache = newCache;
+    buildSpriteTable();
+    m_mutex.unlock();
+
+    emit updateAvailable();
+}
+
+void SvgTheme::addSprites( ImageCache sprites )
+{
+    m_mutex.lock();
+    ImageCache::const_iterator it = sprites.constBegin();
+    for( ; it != sprites.constEnd(); ++it ) {
+        m_imageCache.insert( it.key(), it.value() );
+    }
+    buildSpriteTable();
     m_mutex.unlock();
 
     emit updateAvailable();
 }
+
+void SvgTheme::loadSprites()
+{
+    if( m_svgHash.isEmpty() ) {
+        m_renderer->setAtlasFile( QString() );
+        m_renderer->start();
+        return;
+    }
+
+    QString atlasFile = SpriteCache::atlasFile( m_svgHash, m_spriteList, m_scale, m_rotateSprites );
+
+    SpriteAtlas_T atlas;
+    if( SpriteCache::loadAtlas( atlasFile, atlas ) ) {
+        updateAtlas( atlas );
+        return;
+    }
+
+    m_renderer->setAtlasFile( atlasFile );
+    m_renderer->start();
+}
+
+void SvgTheme::buildSpriteTable()
+{
+    m_spriteTable.clear();
+    m_spriteTable.resize( m_spriteList.size() * SPRITE_FRAMES * SPRITE_ROTATIONS );
+    m_spriteRects.clear();
+    m_spriteRects.resize( m_spriteTable.size() );
+    m_spriteColors.clear();
+
+    // same naming as getImage(), missing sprites stay empty images
+    for( int id = 0; id < m_spriteList.size(); id++ ) {
+        const QString &identifier = m_spriteList.at( id );
+
+        for( int frame = 0; frame < SPRITE_FRAMES; frame++ ) {
+            for( int rot = 0; rot < SPRITE_ROTATIONS; rot++ ) {
+                QString cacheName;
+                if( frame != 0 ) {
+                    cacheName = QString( "%1_%2_%3" ).arg( identifier ).arg( frame ).arg( rot );
+                }
+                else {
+                    cacheName = QString( "%1_%2" ).arg( identifier ).arg( rot );
+                }
+
+                int index = ( id * SPRITE_FRAMES + frame ) * SPRITE_ROTATIONS + rot;
+
+                QMap<QString, QImage>::const_iterator it = m_imageCache.constFind( cacheName );
+                if( it != m_imageCache.constEnd() ) {
+                    m_spriteTable[index] = it.value();
+                }
+
+                QMap<QString, QRect>::const_iterator rect = m_atlas.rects.constFind( cacheName );
+                if( rect != m_atlas.rects.constEnd() ) {
+                    m_spriteRects[index] = rect.value();
+                }
+            }
+        }
+    }
+}
@@ -25,13 +25,31 @@
 #include <QSettings>
 #include <QImage>
 #include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QRect>
+#include <QSize>
+#include <QColor>
 #include <QMutex>
+#include <QByteArray>
 
 #include "themerenderer.h"
 
+class QPainter;
+
 namespace BotRace {
 namespace Renderer {
 
+/**
+ * @brief Number of rotations kept for each sprite in the sprite table
+ */
+const int SPRITE_ROTATIONS = 4;
+
+/**
+ * @brief Number of frames kept for each sprite in the sprite table, frame 0 is the static sprite
+ */
+const int SPRITE_FRAMES = 5;
+
 /**
  * @brief Base class to define a SVG them
  *
@@ -44,9 +62,23 @@ namespace Renderer {
  * will be updated when it is finished.
  *
  * At all time the sprites can be retrived from the cache via the getImage function.
- * When the renderer finished creating a new cache, a the updateAvailable() signal is emitted
+ * When the renderer finished a batch of sprites or the new cache, a the updateAvailable() signal is emitted
  * connected class can react on this signal and update their grafics.
  *
+ * The finished sprites are kept in one SpriteAtlas_T. Only the sprites of a running render batch
+ * are kept as single images until the atlas is ready.
+ *
+ * The position of each sprite is copied into a dense sprite table indexed by sprite id, frame
+ * and rotation. The id of a sprite is its position in the sprite list and never changes, so
+ * subclasses look up the ids of their sprites once with spriteId() and use drawSprite() afterwards.
+ * This avoids building a string and searching the map for each drawn sprite, and draws directly
+ * from the atlas without copying the sprite. getSprite() and getImage() return a copy of the sprite
+ * for callers that need an image of their own.
+ *
+ * Before the renderer is started, the SpriteCache is asked for an atlas of the same svg file
+ * and scale. On a hit the cache is filled from the atlas at once and nothing is rendered,
+ * on a miss the renderer stores its result as new atlas.
+ *
  * <b> Theme file description: </b>
  *
  * each theme consists of 2 files
@@ -165,6 +197,61 @@ public:
     */
     QImage getImage( const QString &identifier, unsigned int orientation = 0,  unsigned int frame = 0 );
 
+    /**
+     * @brief Returns the id of a sprite for the fast lookup via getSprite()
+     *
+     * @param identifier name of the sprite as given in the sprite list
+     * @return the sprite id or -1 if the sprite is not part of the theme
+    */
+    int spriteId( const QString &identifier ) const;
+
+    /**
+     * @brief Retrieve a image from the sprite table
+     *
+     * @param spriteId id of the sprite from spriteId()
+     * @param orientation used rotation
+     * @param frame used frame
+     * @return QImage the corresponding image or an empty image for an unknown id
+    */
+    QImage getSprite( int spriteId, unsigned int orientation = 0, unsigned int frame = 0 );
+
+    /**
+     * @brief Draws a sprite from the sprite table
+     *
+     * Can be called from any thread.
+     *
+     * @param painter the painter to draw with
+     * @param target the area the sprite is scaled into
+     * @param spriteId id of the sprite from spriteId()
+     * @param orientation used rotation
+     * @param frame used frame
+    */
+    void drawSprite( QPainter *painter, const QRectF &target, int spriteId, unsigned int orientation = 0, unsigned int frame = 0 );
+
+    /**
+     * @brief Returns the size of a sprite from the sprite table
+     *
+     * @param spriteId id of the sprite from spriteId()
+     * @param orientation used rotation
+     * @param frame used frame
+     * @return the size of the sprite or an empty size for an unknown id
+    */
+    QSize spriteSize( int spriteId, unsigned int orientation = 0, unsigned int frame = 0 );
+
+    /**
+     * @brief Returns the average color of a sprite
+     *
+     * This is the sprite scaled down to a single pixel. It is used instead of the
+     * sprite if it is drawn so small that no details are visible anymore.
+     * The color is calculated on the first call and kept until the sprites change.
+     *
+     * @param spriteId id of the sprite from spriteId()
+     * @param orientation used rotation
+     * @param frame used frame
+     * @return the average color including the average alpha or an invalid color for an unknown id
+    */
+    QColor spriteColor( int spriteId, unsigned int orientation = 0, unsigned int frame = 0 );
+
 signals:
     /**
      * @brief emitted if a cache update is available
@@ -196,16 +283,52 @@ private slots:
     /**
      * @brief Connected to the threaded renderer to update the internal cache
      *
-     * @param newCache the new image cache
+     * The sprites of the render batches are dropped, all sprites are taken from the atlas.
+     *
+     * @param atlas the new sprite atlas
+    */
+    void updateAtlas( SpriteAtlas_T atlas );
+
+    /**
+     * @brief Connected to the threaded renderer to add the first rendered sprites to the cache
+     *
+     * Sprites of the previous theme or scale stay in the cache until they are replaced,
+     * so the graphics are refined step by step.
+     *
+     * @param sprites the rendered sprites
     */
-    void updateCache( ImageCache newCache );
+    void addSprites( ImageCache sprites );
 
 private:
+    /**
+     * @brief Fills the sprite table from the atlas and the image cache
+     */
+    void buildSpriteTable();
+
+    /**
+     * @brief Returns the image and source rect of a sprite, images of a render batch win over the atlas
+     *
+     * @return @c false if the sprite is not available
+     */
+    bool findSprite( int spriteId, unsigned int orientation, unsigned int frame, QImage &image, QRect &source );
+
+    /**
+     * @brief Fills the cache from the sprite atlas or starts the renderer if no atlas exists
+     */
+    void loadSprites();
+
     QStringList m_spriteList;           /**< The list of all used sprites */
     qreal m_scale;                      /**< The currently used sprite scale */
+    bool m_rotateSprites;               /**< If rotated sprites are rendered */
+    QByteArray m_svgHash;               /**< Content hash of the svg file for the SpriteCache */
 
     ThemeRenderer *m_renderer;          /**< The used renderthread */
-    QMap<QString, QImage> m_imageCache; /**< The used image cache */
+    SpriteAtlas_T m_atlas;              /**< All finished sprites */
+    QMap<QString, QImage> m_imageCache; /**< Sprites of the render batches until the atlas is ready */
+    QHash<QString, int> m_spriteIds;    /**< Sprite id for each sprite name */
+    QVector<QRect> m_spriteRects;       /**< Atlas rect indexed by sprite id, frame and rotation */
+    QVector<QImage> m_spriteTable;      /**< The image cache indexed by sprite id, frame and rotation */
+    QHash<int, QRgb> m_spriteColors;    /**< Average color of the sprites from spriteColor(), indexed like the sprite table */
     QMutex m_mutex;                     /**< Mutex to block several threads to access the image cache */
 
     QString m_theme;        /**< The name of the theme file */
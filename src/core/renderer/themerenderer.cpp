@@ -16,9 +16,17 @@
  */
 
 #include "themerenderer.h"
+#include "spritecache.h"
+#include "paintprofiler.h"
 
 #include <QSvgRenderer>
 #include <QPainter>
+#include <QTransform>
+#include <QtConcurrentRun>
+#include <QFuture>
+#include <QPair>
+#include <QtAlgorithms>
+#include <qmath.h>
 
 #include <QDebug>
 
@@ -32,6 +40,7 @@ ThemeRenderer::ThemeRenderer() :
     m_renderer = 0;
 
     qRegisterMetaType<ImageCache> ( "ImageCache" );
+    qRegisterMetaType<SpriteAtlas_T> ( "SpriteAtlas_T" );
 }
 
 ThemeRenderer::~ThemeRenderer()
@@ -80,9 +89,20 @@ void ThemeRenderer::setScale( qreal scale )
     m_mutex.unlock();
 }
 
+void ThemeRenderer::setAtlasFile( const QString &atlasFile )
+{
+    m_mutex.lock();
+    m_atlasFile = atlasFile;
+    m_mutex.unlock();
+}
+
 void ThemeRenderer::run()
 {
+    ProfileTimer profileTimer( PROFILE_THEME_RENDERER );
+
+    m_mutex.lock();
     m_abortRendering = false;
+    m_mutex.unlock();
 
     if( !m_renderer || m_svgThemeFile.isEmpty() ) {
         qWarning() << "ThemeRenderer :: No svg theme file available";
@@ -94,53 +114,177 @@ void ThemeRenderer::run()
         return;
     }
 
-    m_mutex.lock();
-    if( m_abortRendering ) {
-        m_mutex.unlock();
+    // one batch for each core, the batches are published in the order of the sprite list
+    int batchCount = qBound( 1, QThread::idealThreadCount(), m_spriteList.size() );
+    int batchSize = ( m_spriteList.size() + batchCount - 1 ) / batchCount;
+
+    QList<QFuture<ImageCache> > batches;
+    for( int i = 0; i < m_spriteList.size(); i += batchSize ) {
+        batches.append( QtConcurrent::run( this, &ThemeRenderer::renderSprites, m_spriteList.mid( i, batchSize ) ) );
+    }
+
+    ImageCache renderCache;
+
+    foreach( QFuture<ImageCache> batch, batches ) {
+        // wait for all batches even when aborted, they still use this object
+        ImageCache sprites = batch.result();
+
+        if( isAborted() ) {
+            continue;
+        }
+
+        emit spritesReady( sprites );
+
+        ImageCache::const_iterator it = sprites.constBegin();
+        for( ; it != sprites.constEnd(); ++it ) {
+            renderCache.insert( it.key(), it.value() );
+        }
+    }
+
+    if( isAborted() ) {
         return;
     }
-    m_mutex.unlock();
 
+    SpriteAtlas_T atlas = packAtlas( renderCache );
+
+    if( !m_atlasFile.isEmpty() ) {
+        SpriteCache::storeAtlas( m_atlasFile, atlas );
+    }
+
+    emit atlasReady( atlas );
+}
+
+static bool higherSprite( const QPair<QString, QSize> &a, const QPair<QString, QSize> &b )
+{
+    return a.second.height() > b.second.height();
+}
+
+SpriteAtlas_T ThemeRenderer::packAtlas( const ImageCache &cache )
+{
+    SpriteAtlas_T atlas;
+    if( cache.isEmpty() ) {
+        return atlas;
+    }
+
+    // 1 pixel space around each sprite
+    const int padding = 1;
+
+    QList<QPair<QString, QSize> > sprites;
+    qint64 area = 0;
+    int maxWidth = 0;
+
+    ImageCache::const_iterator it = cache.constBegin();
+    for( ; it != cache.constEnd(); ++it ) {
+        QSize size = it.value().size() + QSize( padding, padding );
+        sprites.append( qMakePair( it.key(), size ) );
+        area += ( qint64 )size.width() * size.height();
+        maxWidth = qMax( maxWidth, size.width() );
+    }
+
+    qStableSort( sprites.begin(), sprites.end(), higherSprite );
+
+    // aim for a roughly square atlas
+    int atlasWidth = qMax( maxWidth, ( int )( qSqrt( ( qreal )area ) * 1.1 ) );
+
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+
+    for( int i = 0; i < sprites.size(); i++ ) {
+        const QSize &size = sprites.at( i ).second;
+
+        // start a new shelf below the highest sprite of the current one
+        if( x + size.width() > atlasWidth ) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+
+        atlas.rects.insert( sprites.at( i ).first, QRect( QPoint( x, y ), size - QSize( padding, padding ) ) );
+
+        x += size.width();
+        shelfHeight = qMax( shelfHeight, size.height() );
+    }
+
+    atlas.image = QImage( atlasWidth, y + shelfHeight, QImage::Format_ARGB32_Premultiplied );
+    atlas.image.fill( Qt::transparent );
+
+    QPainter atlasPainter;
+    atlasPainter.begin( &atlas.image );
+    atlasPainter.setCompositionMode( QPainter::CompositionMode_Source );
+
+    QMap<QString, QRect>::const_iterator rect = atlas.rects.constBegin();
+    for( ; rect != atlas.rects.constEnd(); ++rect ) {
+        atlasPainter.drawImage( rect.value().topLeft(), cache.value( rect.key() ) );
+    }
+
+    atlasPainter.end();
+
+    return atlas;
+}
+
+ImageCache ThemeRenderer::renderSprites( const QStringList &sprites )
+{
     ImageCache renderCache;
 
-    foreach( const QString & sprite, m_spriteList ) {
+    QSvgRenderer renderer( m_svgThemeFile );
+    if( !renderer.isValid() ) {
+        return renderCache;
+    }
+
+    int maxRotation = 1;
+    if( m_rotateSprites ) {
+        maxRotation = 4;
+    }
 
-        QRectF bounds = m_renderer->boundsOnElement( sprite );
+    foreach( const QString & sprite, sprites ) {
+
+        QRectF bounds = renderer.boundsOnElement( sprite );
         QSize size = QSize( m_scale * bounds.width() , m_scale * bounds.height() );
 
         qreal dx = size.width() / 2;
         qreal dy = size.height() / 2;
 
-        int maxRotation = 1;
-        if( m_rotateSprites ) {
-            maxRotation = 4;
-        }
+        QImage baseImage;
 
         for( int rot = 0; rot < maxRotation; rot++ ) {
-            QImage cachedImage( size, QImage::Format_ARGB32_Premultiplied );
-            cachedImage.fill( Qt::transparent );
-            QPainter cachePainter;
+            QImage cachedImage;
 
-            cachePainter.begin( &cachedImage );
+            if( rot > 0 && size.width() == size.height() ) {
+                cachedImage = baseImage.transformed( QTransform().rotate( rot * 90.0 ) );
+            }
+            else {
+                cachedImage = QImage( size, QImage::Format_ARGB32_Premultiplied );
+                cachedImage.fill( Qt::transparent );
+                QPainter cachePainter;
 
-            drawSprite( &cachePainter, rot, dx, dy, sprite );
-            cachePainter.end();
+                cachePainter.begin( &cachedImage );
+
+                drawSprite( &renderer, &cachePainter, rot, dx, dy, sprite );
+                cachePainter.end();
+            }
+
+            if( rot == 0 ) {
+                baseImage = cachedImage;
+            }
 
             QString elementId = QString( "%1_%2" ).arg( sprite ).arg( rot );
 
             renderCache.insert( elementId, cachedImage );
+        }
 
-            m_mutex.lock();
-            if( m_abortRendering ) {
-                renderCache.clear();
-                m_mutex.unlock();
-                return;
-            }
-            m_mutex.unlock();
+        if( isAborted() ) {
+            return ImageCache();
         }
     }
 
-    emit cacheUpdateReady( renderCache );
+    return renderCache;
+}
+
+bool ThemeRenderer::isAborted()
+{
+    QMutexLocker locker( &m_mutex );
+    return m_abortRendering;
 }
 
 void ThemeRenderer::abort()
@@ -150,7 +294,7 @@ void ThemeRenderer::abort()
     m_mutex.unlock();
 }
 
-void ThemeRenderer::drawSprite( QPainter *painter, int rotation, qreal dx, qreal dy, QString svg )
+void ThemeRenderer::drawSprite( QSvgRenderer *renderer, QPainter *painter, int rotation, qreal dx, qreal dy, QString svg )
 {
     qreal angle = 0;
 
@@ -178,6 +322,6 @@ void ThemeRenderer::drawSprite( QPainter *painter, int rotation, qreal dx, qreal
     painter->rotate( angle );
     painter->translate( -dx, -dy );
 
-    m_renderer->render( painter, svg );
+    renderer->render( painter, svg );
     painter->restore();
 }
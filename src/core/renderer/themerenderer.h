@@ -25,6 +25,7 @@
 
 #include <QMap>
 #include <QImage>
+#include <QRect>
 
 #include <QMutex>
 
@@ -43,6 +44,17 @@ namespace Renderer {
 */
 typedef QMap<QString, QImage> ImageCache;
 
+/**
+ * @brief All sprites of a theme packed into one image
+ *
+ * The sprites are placed on shelves sorted by their height, with 1 pixel space
+ * between them so scaled sprites do not bleed into each other.
+ */
+struct SpriteAtlas_T {
+    QImage image;               /**< all sprites, ARGB32 premultiplied */
+    QMap<QString, QRect> rects; /**< position of each sprite in @c image, named as in the ImageCache */
+};
+
 /**
  * @brief Renders a SVG Theme into a lookup cache
  *
@@ -52,11 +64,20 @@ typedef QMap<QString, QImage> ImageCache;
  * Which sprites are used from the svg theme is determined by the @c spritelist.
  * Each sprite is rendered sclaed by a factor and added to the QMap cache.
  *
- * At the end the complete cache is send via a signal from this render thread
- * to the connected ThemeClass that holds the actual cache for the game.
+ * At the end the complete cache is packed into one SpriteAtlas_T and send via a signal
+ * from this render thread to the connected ThemeClass that holds the actual cache for the game.
+ *
+ * The sprite list is split into one batch for each core and the batches are rendered
+ * in the global QThreadPool. QSvgRenderer is not thread safe, so each batch loads its own
+ * instance of the svg file. Each finished batch is published with spritesReady(), so the
+ * theme can show the first sprites before all others are done.
  *
  * In the case of the tile theme it is necessary to create also each sprite
- * in a rotations.
+ * in a rotations. Square sprites are rendered once and rotated as image, which is lossless
+ * for multiples of 90°. All other sprites are rendered again for each rotation.
+ *
+ * When an atlas file is set, the sprite atlas is written to it via the SpriteCache before
+ * atlasReady() is emitted, so the next start does not need to render the theme again.
  *
  * @b Cache description:\n
  * To find a sprite in the QMap cache, they are ordered in a special way.\n
@@ -123,6 +144,13 @@ public:
     */
     void setScale( qreal scale );
 
+    /**
+     * @brief Sets the atlas file the complete cache is stored in
+     *
+     * @param atlasFile the file for the SpriteCache or an empty string to not store the cache
+    */
+    void setAtlasFile( const QString &atlasFile );
+
     /**
      * @brief Stops the render thread
      *
@@ -131,6 +159,14 @@ public:
     */
     void abort();
 
+    /**
+     * @brief Packs all sprites of @p cache into one image
+     *
+     * @param cache the rendered sprites
+     * @return the atlas with the position of each sprite
+    */
+    static SpriteAtlas_T packAtlas( const ImageCache &cache );
+
 protected:
     /**
      * @brief Implemented run function from QThread
@@ -141,18 +177,41 @@ protected:
 
 signals:
     /**
-     * @brief emitted when the cache is created completely
+     * @brief emitted when all sprites are rendered and packed
+     *
+     * Will not be emitted if the thread is aborted inbetween
+     *
+     * @param atlas the atlas with all sprites
+    */
+    void atlasReady( SpriteAtlas_T atlas );
+
+    /**
+     * @brief emitted when a batch of sprites is rendered
      *
      * Will not be emitted if the thread is aborted inbetween
      *
-     * @param newCache The QMap cache with all sprites
+     * @param sprites the rendered sprites with all rotations
     */
-    void cacheUpdateReady( ImageCache newCache );
+    void spritesReady( ImageCache sprites );
 
 private:
+    /**
+     * @brief Renders one batch of sprites, called in a thread of the QThreadPool
+     *
+     * @param sprites the sprites of this batch
+     * @return the rendered sprites or an empty cache if the rendering was aborted
+    */
+    ImageCache renderSprites( const QStringList &sprites );
+
+    /**
+     * @brief Returns if abort() was called since the last start
+    */
+    bool isAborted();
+
     /**
      * @brief Draw the actual sprite with the SvgRendere and given rotation
      *
+     * @param renderer the QSvgRenderer of the calling thread
      * @param painter the painter to draw on
      * @param rotation rotation parameter
      *        @li @c 0 - No rotation
@@ -163,13 +222,14 @@ private:
      * @param dy midpoint of the sprite used to rotate the painter
      * @param svg the sprite string to render
     */
-    void drawSprite( QPainter *painter, int rotation, qreal dx, qreal dy, QString svg );
+    void drawSprite( QSvgRenderer *renderer, QPainter *painter, int rotation, qreal dx, qreal dy, QString svg );
 
     QString m_svgThemeFile;     /**< The used svg theme file */
     QStringList m_spriteList;   /**< The sprites used to render */
     qreal m_scale;              /**< The scale factor foreach element */
     bool m_rotateSprites;       /**< If sprites should be rotated or not */
-    QSvgRenderer *m_renderer;   /**< The used QSvgRender instace */
+    QString m_atlasFile;        /**< The file the complete cache is stored in */
+    QSvgRenderer *m_renderer;   /**< QSvgRender instance to check the theme file, the batches use their own */
 
     bool m_abortRendering;      /**< Saves if the thread should be canceled */
     QMutex m_mutex;             /**< Mutex to block several threads changing the abort value */
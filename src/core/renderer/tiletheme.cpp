@@ -23,6 +23,35 @@ using namespace Renderer;
 TileTheme::TileTheme( QStringList spriteList, qreal scale ) :
     SvgTheme( spriteList, scale, true )
 {
+    m_floorIds.fill( -1, Core::MAX_FLOOR_TILES );
+    m_floorOffIds.fill( -1, Core::MAX_FLOOR_TILES );
+    for( int i = Core::FLOOR_EDGE; i < Core::MAX_FLOOR_TILES; i++ ) {
+        QString svgTileName = Core::tileToSvg(( Core::FloorTileType )i );
+        m_floorIds[i] = spriteId( svgTileName );
+        m_floorOffIds[i] = spriteId( svgTileName + QString( "_Off" ) );
+    }
+
+    m_wallIds.fill( -1, Core::MAX_WALL_TILES );
+    m_wallOffIds.fill( -1, Core::MAX_WALL_TILES );
+    for( int i = Core::WALL_NONE; i < Core::MAX_WALL_TILES; i++ ) {
+        QString svgTileName = Core::tileToSvg(( Core::WallTileType )i );
+        m_wallIds[i] = spriteId( svgTileName );
+        m_wallOffIds[i] = spriteId( svgTileName + QString( "_Off" ) );
+    }
+
+    m_specialIds.fill( -1, Core::MAX_SPECIAL_TILES );
+    for( int i = 0; i < Core::MAX_SPECIAL_TILES; i++ ) {
+        m_specialIds[i] = spriteId( Core::tileToSvg(( Core::SpecialTileType )i ) );
+    }
+
+    QStringList phaseMarkers;
+    phaseMarkers << "Phase_F_%1" << "Phase_WN_%1" << "Phase_WE_%1" << "Phase_WS_%1" << "Phase_WW_%1";
+    m_phaseIds.fill( -1, MAX_PHASE_MARKERS * 5 );
+    for( int m = 0; m < MAX_PHASE_MARKERS; m++ ) {
+        for( int p = 0; p < 5; p++ ) {
+            m_phaseIds[m * 5 + p] = spriteId( phaseMarkers.at( m ).arg( p + 1 ) );
+        }
+    }
 }
 
 TileTheme::~TileTheme()
@@ -37,29 +66,51 @@ QImage TileTheme::getTile( const QString &name, int rotation, int frame )
 
 QImage TileTheme::getTile( Core::FloorTileType tile, Core::Orientation rotation, int frame, bool activeInPhase )
 {
-    QString svgTileName = Core::tileToSvg( tile );
+    return getSprite( tileId( tile, activeInPhase ), ( int ) rotation, frame );
+}
+
+QImage TileTheme::getTile( Core::WallTileType tile, Core::Orientation rotation, int frame, bool activeInPhase )
+{
+    return getSprite( tileId( tile, activeInPhase ), ( int ) rotation, frame );
+}
+
+QImage TileTheme::getTile( Core::SpecialTileType tile, Core::Orientation rotation, int frame )
+{
+    return getSprite( m_specialIds.value( tile, -1 ), ( int ) rotation, frame );
+}
+
+int TileTheme::tileId( Core::FloorTileType tile, bool activeInPhase ) const
+{
     if( !activeInPhase ) {
         if(tile == Core::FLOOR_AUTOPIT) {
-            svgTileName.append(QString("_Off"));
+            return m_floorOffIds.value( tile, -1 );
         }
     }
 
-    return getImage( svgTileName, ( int ) rotation, frame );
+    return m_floorIds.value( tile, -1 );
 }
 
-QImage TileTheme::getTile( Core::WallTileType tile, Core::Orientation rotation, int frame, bool activeInPhase )
+int TileTheme::tileId( Core::WallTileType tile, bool activeInPhase ) const
 {
-    QString svgTileName = Core::tileToSvg( tile );
     if( !activeInPhase ) {
         if(tile == Core::WALL_FIRE) {
-            svgTileName.append(QString("_Off"));
+            return m_wallOffIds.value( tile, -1 );
         }
     }
 
-    return getImage( svgTileName, ( int ) rotation, frame );
+    return m_wallIds.value( tile, -1 );
 }
 
-QImage TileTheme::getTile( Core::SpecialTileType tile, Core::Orientation rotation, int frame )
+QImage TileTheme::getPhaseMarker( PhaseMarker marker, int phase )
+{
+    return getSprite( phaseMarkerId( marker, phase ) );
+}
+
+int TileTheme::phaseMarkerId( PhaseMarker marker, int phase ) const
 {
-    return getImage( Core::tileToSvg( tile ), ( int ) rotation, frame );
+    if( phase < 0 || phase >= 5 ) {
+        return -1;
+    }
+
+    return m_phaseIds.value( marker * 5 + phase, -1 );
 }
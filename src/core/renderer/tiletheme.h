@@ -24,6 +24,20 @@
 
 namespace BotRace {
 namespace Renderer {
+
+/**
+ * @brief Markers drawn on tiles that are only active in some phases
+ */
+enum PhaseMarker {
+    PHASE_FLOOR,        /**< Phase_F_x sprites for the floor */
+    PHASE_WALL_NORTH,   /**< Phase_WN_x sprites for the north wall */
+    PHASE_WALL_EAST,    /**< Phase_WE_x sprites for the east wall */
+    PHASE_WALL_SOUTH,   /**< Phase_WS_x sprites for the south wall */
+    PHASE_WALL_WEST,    /**< Phase_WW_x sprites for the west wall */
+
+    MAX_PHASE_MARKERS
+};
+
 /**
  * @brief Sprites for the board tile
  *
@@ -32,6 +46,9 @@ namespace Renderer {
  * Overloads the getImage() function to allow a more
  * intuitiv usage
  *
+ * The sprite ids of all tile types are looked up once, so the enum based getTile()
+ * functions use the sprite table directly instead of the sprite names.
+ *
 */
 class TileTheme : public SvgTheme {
     Q_OBJECT
@@ -74,6 +91,46 @@ public:
      * @overload
     */
     QImage getTile( Core::SpecialTileType tile, Core::Orientation rotation, int frame = 0 );
+
+    /**
+     * @brief Returns the marker that shows a tile is active in @p phase
+     *
+     * @param marker floor or wall side of the marker
+     * @param phase the phase, 0-4
+     * @return QImage image from the cache
+    */
+    QImage getPhaseMarker( PhaseMarker marker, int phase );
+
+    /**
+     * @brief Returns the sprite id of a floor tile for getSprite()
+     *
+     * @param tile the floor tile
+     * @param activeInPhase @c false to get the inactive sprite of tiles that have one
+     * @return the sprite id or -1 if the tile has no sprite
+    */
+    int tileId( Core::FloorTileType tile, bool activeInPhase = true ) const;
+
+    /**
+     * @overload
+    */
+    int tileId( Core::WallTileType tile, bool activeInPhase = true ) const;
+
+    /**
+     * @brief Returns the sprite id of a phase marker for getSprite()
+     *
+     * @param marker floor or wall side of the marker
+     * @param phase the phase, 0-4
+     * @return the sprite id or -1 if the theme has no such marker
+    */
+    int phaseMarkerId( PhaseMarker marker, int phase ) const;
+
+private:
+    QVector<int> m_floorIds;        /**< Sprite id for each FloorTileType */
+    QVector<int> m_floorOffIds;     /**< Sprite id of the inactive FloorTileType or -1 */
+    QVector<int> m_wallIds;         /**< Sprite id for each WallTileType */
+    QVector<int> m_wallOffIds;      /**< Sprite id of the inactive WallTileType or -1 */
+    QVector<int> m_specialIds;      /**< Sprite id for each SpecialTileType */
+    QVector<int> m_phaseIds;        /**< Sprite id for each PhaseMarker and phase */
 };
 
 }
@@ -43,6 +43,11 @@ QImage UiTheme::getUiElement( const QString &name, int frame )
     return getImage( name, 0, frame );
 }
 
+void UiTheme::drawUiElement( QPainter *painter, const QRectF &target, const QString &name, int frame )
+{
+    drawSprite( painter, target, spriteId( name ), 0, frame );
+}
+
 void UiTheme::readThemeFile()
 {
     QSettings themeSettings( theme(), QSettings::IniFormat );
@@ -125,6 +125,18 @@ public:
      */
     QImage getUiElement( const QString &name, int frame = 0 );
 
+    /**
+     * @brief draws a ui element directly from the sprite atlas
+     *
+     * Avoids the copy of getUiElement() for elements that are painted every frame
+     *
+     * @param painter the painter to draw with
+     * @param target the area the element is scaled into
+     * @param name sprite name
+     * @param frame frame number
+     */
+    void drawUiElement( QPainter *painter, const QRectF &target, const QString &name, int frame = 0 );
+
 protected:
     /**
      * @brief Reimplemented function to read the additional theme details
@@ -20,6 +20,7 @@
 
 #include "generalsettings.h"
 #include "themesettings.h"
+#include "engine/clientsettings.h"
 
 #include <QAbstractButton>
 #include <QListWidgetItem>
@@ -63,6 +64,9 @@ ConfigDialog::ConfigDialog( Renderer::GameTheme *gameTheme ) :
     connect( this, SIGNAL( saveChanges() ), cardSettings, SLOT( applyChanges() ) );
     connect( this, SIGNAL( cancelChanges() ), cardSettings, SLOT( cancelChanges() ) );
 
+    // after all pages wrote their settings
+    connect( this, SIGNAL( saveChanges() ), ClientSettings::instance(), SLOT( reload() ) );
+
     connect( ui->buttonBox, SIGNAL( clicked( QAbstractButton * ) ), this, SLOT( updateChanges( QAbstractButton * ) ) );
 }
 
@@ -104,7 +104,8 @@ void GameSettingsWidget::resetSettings()
     // game tab
     ui->killsToWin->setValue( 5 );
     ui->pointsToWin->setValue( 10 );
-
+    ui->animationTimeout->setValue( 10 );
+    ui->skipAnimations->setChecked( false );
 }
 
 void GameSettingsWidget::setSettings( Core::GameSettings_T settings)
@@ -127,6 +128,8 @@ void GameSettingsWidget::setSettings( Core::GameSettings_T settings)
     ui->modeComboBox->setCurrentIndex( (int)settings.mode );
     ui->killsToWin->setValue( settings.killsToWin );
     ui->pointsToWin->setValue( settings.pointsToWinKingOf );
+    ui->animationTimeout->setValue( settings.animationTimeout );
+    ui->skipAnimations->setChecked( settings.skipAnimations );
 }
 
 bool GameSettingsWidget::hasValidScenario()
@@ -187,6 +190,8 @@ Core::GameSettings_T GameSettingsWidget::selectedSettings()
     //# game rules
     settings.killsToWin = ui->killsToWin->value();
     settings.pointsToWinKingOf = ui->pointsToWin->value();
+    settings.animationTimeout = ui->animationTimeout->value();
+    settings.skipAnimations = ui->skipAnimations->isChecked();
 
     return settings;
 }
@@ -271,4 +276,6 @@ void GameSettingsWidget::setUpDialog()
 
     ui->killsToWin->setValue( settings.value( "GameSettings/killsToWin", 5 ).toInt() );
     ui->pointsToWin->setValue( settings.value( "GameSettings/pointsToWinKingOf", 10 ).toInt() );
+    ui->animationTimeout->setValue( settings.value( "GameSettings/animationTimeout", 10 ).toInt() );
+    ui->skipAnimations->setChecked( settings.value( "GameSettings/skipAnimations", false ).toBool() );
 }
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "boardcommands.h"
+
+#include "boardwidget.h"
+
+using namespace BotRace;
+using namespace Editor;
+
+namespace {
+
+const int PAINT_COMMAND_ID = 1; /**< id of all mergeable paint commands */
+
+}
+
+static int tileKey( const QPoint &position )
+{
+    return ( position.x() << 16 ) | ( position.y() & 0xffff );
+}
+
+ChangeTilesCommand::ChangeTilesCommand( BoardWidget *board, const QVector<TileChange_T> &changes, const QString &text, int stroke, QUndoCommand *parent ) :
+    QUndoCommand( text, parent ),
+    m_board( board ),
+    m_changes( changes ),
+    m_stroke( stroke )
+{
+    // only paint strokes are merged and need the lookup
+    if( m_stroke >= 0 ) {
+        for( int i = 0; i < m_changes.size(); i++ ) {
+            m_changeIndex.insert( tileKey( m_changes.at( i ).position ), i );
+        }
+    }
+}
+
+void ChangeTilesCommand::undo()
+{
+    m_board->applyTileChanges( m_changes, true );
+}
+
+void ChangeTilesCommand::redo()
+{
+    m_board->applyTileChanges( m_changes, false );
+}
+
+int ChangeTilesCommand::id() const
+{
+    if( m_stroke < 0 ) {
+        return -1;
+    }
+
+    return PAINT_COMMAND_ID;
+}
+
+bool ChangeTilesCommand::mergeWith( const QUndoCommand *other )
+{
+    const ChangeTilesCommand *command = static_cast<const ChangeTilesCommand *>( other );
+    if( command->m_board != m_board || command->m_stroke != m_stroke ) {
+        return false;
+    }
+
+    // a tile painted twice in one stroke keeps its first old tile
+    foreach( const TileChange_T &change, command->m_changes ) {
+        int key = tileKey( change.position );
+
+        QHash<int, int>::const_iterator slot = m_changeIndex.constFind( key );
+        if( slot != m_changeIndex.constEnd() ) {
+            m_changes[slot.value()].newTile = change.newTile;
+        }
+        else {
+            m_changeIndex.insert( key, m_changes.size() );
+            m_changes.append( change );
+        }
+    }
+
+    return true;
+}
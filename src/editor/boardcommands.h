@@ -0,0 +1,85 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOARDCOMMANDS_H
+#define BOARDCOMMANDS_H
+
+#include <QUndoCommand>
+#include <QVector>
+#include <QHash>
+#include <QPoint>
+
+#include "engine/board.h"
+
+namespace BotRace {
+namespace Editor {
+class BoardWidget;
+
+/**
+ * @brief One changed tile of a ChangeTilesCommand
+ */
+struct TileChange_T {
+    QPoint position;            /**< The x/y coordinates of the tile on the board */
+    Core::BoardTile_T oldTile;  /**< The tile before the change, restored on undo */
+    Core::BoardTile_T newTile;  /**< The tile after the change, set on redo */
+};
+
+/**
+ * @brief Undo command that replaces a set of tiles on a BoardWidget
+ *
+ * Only the changed tiles are stored, so a single click and a region fill on a large board cost the same per tile.
+ * Commands created with the same paint stroke are merged, so dragging the mouse over the board
+ * is undone in one step.
+ */
+class ChangeTilesCommand : public QUndoCommand {
+public:
+    /**
+     * @brief Creates the command, the changes are applied on the first redo() when it is pushed onto the undo stack
+     * @param board the board the tiles belong to
+     * @param changes the changed tiles
+     * @param text the text shown in the undo/redo actions
+     * @param stroke the paint stroke of the change or -1 if the command should not be merged
+     * @param parent the parent command
+     */
+    ChangeTilesCommand( BoardWidget *board, const QVector<TileChange_T> &changes, const QString &text, int stroke = -1, QUndoCommand *parent = 0 );
+
+    void undo();
+    void redo();
+
+    /**
+     * @brief Returns the id of paint commands or -1 for commands that are never merged
+     */
+    int id() const;
+
+    /**
+     * @brief Adds the tiles of @p other if it belongs to the same paint stroke
+     * @param other the command pushed after this one
+     * @return @c true if the commands were merged
+     */
+    bool mergeWith( const QUndoCommand *other );
+
+private:
+    BoardWidget *m_board;               /**< The board the tiles belong to */
+    QVector<TileChange_T> m_changes;    /**< The changed tiles */
+    QHash<int, int> m_changeIndex;      /**< Position key of each tile to its slot in m_changes, for paint strokes only */
+    int m_stroke;                       /**< The paint stroke or -1 */
+};
+
+}
+}
+
+#endif // BOARDCOMMANDS_H
@@ -17,26 +17,121 @@
 
 #include "boardwidget.h"
 
-#include "boardtile.h"
 #include "tilelist.h"
 
 #include "renderer/gametheme.h"
-#include "renderer/boardtheme.h"
+#include "renderer/tiletheme.h"
 
 #include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QPen>
+#include <QMap>
+#include <QUndoStack>
 #include <QDebug>
 
 using namespace BotRace;
 using namespace Editor;
 
+namespace {
+
+bool sameTile( const Core::BoardTile_T &a, const Core::BoardTile_T &b )
+{
+    return a.type == b.type && a.alignment == b.alignment
+           && a.northWall == b.northWall && a.eastWall == b.eastWall
+           && a.southWall == b.southWall && a.westWall == b.westWall
+           && a.floorActiveInPhase == b.floorActiveInPhase
+           && a.northWallActiveInPhase == b.northWallActiveInPhase
+           && a.eastWallActiveInPhase == b.eastWallActiveInPhase
+           && a.southWallActiveInPhase == b.southWallActiveInPhase
+           && a.westWallActiveInPhase == b.westWallActiveInPhase;
+}
+
+QList<bool> allPhasesActive()
+{
+    QList<bool> activatedPhase;
+    for( int i = 0; i < 5; i++ ) {
+        activatedPhase.append( true );
+    }
+
+    return activatedPhase;
+}
+
+void setPhase( QList<bool> &activeInPhase, int phase, bool active )
+{
+    // boards of older files might list less than 5 phases
+    while( activeInPhase.size() < 5 ) {
+        activeInPhase.append( true );
+    }
+
+    activeInPhase.replace( phase - 1, active );
+}
+
+void setFloor( Core::BoardTile_T &tile, Core::FloorTileType floor, Core::Orientation rotation, const QList<bool> &activeIn )
+{
+    tile.type = floor;
+    tile.alignment = rotation;
+    tile.floorActiveInPhase = activeIn;
+}
+
+void setWall( Core::BoardTile_T &tile, Core::WallTileType wall, Core::Orientation rotation, const QList<bool> &activeIn )
+{
+    switch( rotation ) {
+    case Core::NORTH:
+        tile.northWall = wall;
+        tile.northWallActiveInPhase = activeIn;
+        break;
+    case Core::EAST:
+        tile.eastWall = wall;
+        tile.eastWallActiveInPhase = activeIn;
+        break;
+    case Core::SOUTH:
+        tile.southWall = wall;
+        tile.southWallActiveInPhase = activeIn;
+        break;
+    case Core::WEST:
+        tile.westWall = wall;
+        tile.westWallActiveInPhase = activeIn;
+        break;
+    }
+}
+
+Core::BoardTile_T rotateTile( const Core::BoardTile_T &tile )
+{
+    Core::BoardTile_T rotated = tile;
+    rotated.alignment = ( Core::Orientation )( ( tile.alignment + 1 ) % 4 );
+
+    rotated.northWall = tile.westWall;
+    rotated.eastWall = tile.northWall;
+    rotated.southWall = tile.eastWall;
+    rotated.westWall = tile.southWall;
+
+    rotated.northWallActiveInPhase = tile.westWallActiveInPhase;
+    rotated.eastWallActiveInPhase = tile.northWallActiveInPhase;
+    rotated.southWallActiveInPhase = tile.eastWallActiveInPhase;
+    rotated.westWallActiveInPhase = tile.southWallActiveInPhase;
+
+    return rotated;
+}
+
+}
+
 BoardWidget::BoardWidget( QWidget *parent ) :
     QWidget( parent ),
     m_renderer( 0 ),
-    m_currentTile( 0 )
+    m_currentTile( 0 ),
+    m_selectedTile( -1, -1 ),
+    m_highlightTile( -1, -1 ),
+    m_undoStack( new QUndoStack( this ) ),
+    m_paintStroke( 0 ),
+    m_painting( false )
 {
     m_tileSize = QSize( 50, 50 );
     setMinimumSize( 12 * m_tileSize );
     setMaximumSize( 12 * m_tileSize );
+    setMouseTracking( true );
+    setAttribute( Qt::WA_OpaquePaintEvent );
+    m_board.size = QSize( 0, 0 );
     m_boardChanged = false;
     m_drawModeEnabled = true;
 }
@@ -44,52 +139,43 @@ BoardWidget::BoardWidget( QWidget *parent ) :
 void BoardWidget::setRenderer( Renderer::GameTheme *renderer )
 {
     m_renderer = renderer;
+    connect( m_renderer->getTileTheme(), SIGNAL( updateAvailable() ), this, SLOT( update() ) );
 }
 
 void BoardWidget::clearBoard()
 {
-    foreach( QObject * child, children() ) {
-        delete child;
-    }
-
-    m_author.clear();
-    m_email.clear();
-    m_description.clear();
-    m_name.clear();
-    m_boardSize = QSize( 0, 0 );
+    m_board = Core::Board_T();
+    m_board.size = QSize( 0, 0 );
+    m_selectedTile = QPoint( -1, -1 );
+    m_highlightTile = QPoint( -1, -1 );
+    m_selectedRegion = QRect();
+    m_undoStack->clear();
+
+    update();
 }
 
 void BoardWidget::loadBoard( const Core::Board_T &board )
 {
     clearBoard();
 
-    m_author = board.author;
-    m_email = board.email;
-    m_description = board.description;
-    m_name = board.name;
-    m_boardSize = board.size;
-
-    setMinimumSize( m_boardSize.width() * m_tileSize.width() * m_renderer->getTileScale(),
-                    m_boardSize.height() * m_tileSize.height() * m_renderer->getTileScale() );
-    setMaximumSize( m_boardSize.width() * m_tileSize.width() * m_renderer->getTileScale(),
-                    m_boardSize.height() * m_tileSize.height() * m_renderer->getTileScale() );
-
-    for( int y = 0; y < board.size.height(); y++ ) {
-        for( int x = 0; x < board.size.width(); x++ ) {
-            BoardTile *tile = new BoardTile( m_renderer->getTileTheme(), this );
-            Core::BoardTile_T tileInfo = board.tiles.at( Core::toPos( x, y, board.size.width() ) );
-            tile->changeFloor( tileInfo.type, tileInfo.alignment, tileInfo.floorActiveInPhase );
-            tile->changeWall( tileInfo.northWall, Core::NORTH, tileInfo.northWallActiveInPhase );
-            tile->changeWall( tileInfo.eastWall, Core::EAST, tileInfo.eastWallActiveInPhase );
-            tile->changeWall( tileInfo.southWall, Core::SOUTH, tileInfo.southWallActiveInPhase );
-            tile->changeWall( tileInfo.westWall, Core::WEST, tileInfo.westWallActiveInPhase );
-            tile->setPosition( x, y );
-            tile->move( x * m_tileSize.width() * m_renderer->getTileScale(),
-                        y * m_tileSize.width() * m_renderer->getTileScale() );
-            tile->show();
+    m_board.author = board.author;
+    m_board.email = board.email;
+    m_board.description = board.description;
+    m_board.name = board.name;
+    m_board.size = board.size;
+    m_board.tiles = board.tiles;
+
+    int tileCount = m_board.size.width() * m_board.size.height();
+    if( m_board.tiles.size() != tileCount ) {
+        qWarning() << "BoardWidget::loadBoard || board" << board.name << "has" << m_board.tiles.size() << "tiles instead of" << tileCount;
+        m_board.tiles.resize( qMin( m_board.tiles.size(), tileCount ) );
+        while( m_board.tiles.size() < tileCount ) {
+            m_board.tiles.append( emptyTile() );
         }
     }
 
+    resizeToBoard();
+
     m_boardChanged = true;
 }
 
@@ -97,53 +183,256 @@ void BoardWidget::createNewBoard( QSize boardsize )
 {
     clearBoard();
 
-    m_boardSize = boardsize;
+    m_board.size = boardsize;
+    m_board.tiles.fill( emptyTile(), boardsize.width() * boardsize.height() );
+
+    resizeToBoard();
+
+    m_boardChanged = true;
+}
+
+Core::Board_T BoardWidget::saveBoard()
+{
+    Core::Board_T newBoard;
+    newBoard.name = m_board.name;
+    newBoard.email = m_board.email;
+    newBoard.description = m_board.description;
+    newBoard.author = m_board.author;
+    newBoard.size = m_board.size;
+    newBoard.tiles = m_board.tiles;
+
+    m_boardChanged = false;
+    m_undoStack->setClean();
+    return newBoard;
+}
+
+Core::BoardTile_T BoardWidget::tileAt( const QPoint &position ) const
+{
+    if( !isOnBoard( position ) ) {
+        return emptyTile();
+    }
+
+    return m_board.tiles.at( Core::toPos( position.x(), position.y(), m_board.size.width() ) );
+}
+
+void BoardWidget::setTile( const QPoint &position, const Core::BoardTile_T &tile )
+{
+    if( !isOnBoard( position ) ) {
+        qWarning() << "BoardWidget::setTile || position" << position << "is not on the board";
+        return;
+    }
+
+    TileChange_T change;
+    change.position = position;
+    change.oldTile = tileAt( position );
+    change.newTile = tile;
+
+    pushTileChanges( QVector<TileChange_T>() << change, tr( "Change Tile" ) );
+}
+
+void BoardWidget::applyTileChanges( const QVector<TileChange_T> &changes, bool revert )
+{
+    QRect dirtyRegion;
+    bool selectedTileChanged = false;
+
+    foreach( const TileChange_T &change, changes ) {
+        if( !isOnBoard( change.position ) ) {
+            qWarning() << "BoardWidget::applyTileChanges || position" << change.position << "is not on the board";
+            continue;
+        }
 
-    setMinimumSize( m_boardSize.width() * m_tileSize.width() * m_renderer->getTileScale(),
-                    m_boardSize.height() * m_tileSize.height() * m_renderer->getTileScale() );
-    setMaximumSize( m_boardSize.width() * m_tileSize.width() * m_renderer->getTileScale(),
-                    m_boardSize.height() * m_tileSize.height() * m_renderer->getTileScale() );
+        Core::BoardTile_T &boardTile = m_board.tiles[Core::toPos( change.position.x(), change.position.y(), m_board.size.width() )];
+        boardTile = revert ? change.oldTile : change.newTile;
+        boardTile.robot = 0;
 
-    for( int y = 0; y < boardsize.height(); y++ ) {
-        for( int x = 0; x < boardsize.width(); x++ ) {
-            BoardTile *tile = new BoardTile( m_renderer->getTileTheme(), this );
-            tile->setPosition( x, y );
-            tile->move( x * m_tileSize.width() * m_renderer->getTileScale(),
-                        y * m_tileSize.width() * m_renderer->getTileScale() );
-            tile->show();
+        dirtyRegion = dirtyRegion.united( QRect( change.position, QSize( 1, 1 ) ) );
+        if( change.position == m_selectedTile ) {
+            selectedTileChanged = true;
         }
     }
 
+    if( dirtyRegion.isEmpty() ) {
+        return;
+    }
+
     m_boardChanged = true;
+
+    // one repaint for the bounding box of all changed tiles
+    update( regionRect( dirtyRegion ) );
+
+    // the TileDetailWidget shows the selected tile again after undo, redo and region changes
+    if( selectedTileChanged ) {
+        emit activatedTile( this, m_selectedTile );
+    }
 }
 
-Core::Board_T BoardWidget::saveBoard()
+QUndoStack *BoardWidget::undoStack() const
 {
-    Core::Board_T newBoard;
-    newBoard.name = m_name;
-    newBoard.email = m_email;
-    newBoard.description = m_description;
-    newBoard.author = m_author;
-    newBoard.size = m_boardSize;
-
-    BoardTile *tempTile = qobject_cast<BoardTile *>( childAt( 10, 10 ) );
-
-    for( int y = 0; y < m_boardSize.height(); y++ ) {
-        for( int x = 0; x < m_boardSize.width(); x++ ) {
-            Core::BoardTile_T newTile;
-            BoardTile *boardTile = qobject_cast<BoardTile *>( childAt( x * tempTile->width() + 2, y * tempTile->width() + 2 ) );
-            if( !boardTile ) {
-                qWarning() << "couldn't cast object to BoardTile while saving";
-                return newBoard;
+    return m_undoStack;
+}
+
+void BoardWidget::changeFloor( const QPoint &position, Core::FloorTileType newTile, Core::Orientation rotation, QList<bool> activeIn )
+{
+    if( activeIn.isEmpty() ) {
+        activeIn = allPhasesActive();
+    }
+
+    Core::BoardTile_T tile = tileAt( position );
+    setFloor( tile, newTile, rotation, activeIn );
+
+    setTile( position, tile );
+}
+
+void BoardWidget::changeWall( const QPoint &position, Core::WallTileType newWall, Core::Orientation rotation, QList<bool> activeIn )
+{
+    if( activeIn.isEmpty() ) {
+        activeIn = allPhasesActive();
+    }
+
+    Core::BoardTile_T tile = tileAt( position );
+    setWall( tile, newWall, rotation, activeIn );
+
+    setTile( position, tile );
+}
+
+void BoardWidget::setActivePhase( const QPoint &position, int type, int phase, bool active )
+{
+    if( phase < 1 || phase > 5 ) {
+        return;
+    }
+
+    Core::BoardTile_T tile = tileAt( position );
+
+    if( type == 0 ) {
+        setPhase( tile.floorActiveInPhase, phase, active );
+    }
+    if( type == 1 ) {
+        setPhase( tile.northWallActiveInPhase, phase, active );
+    }
+    if( type == 2 ) {
+        setPhase( tile.eastWallActiveInPhase, phase, active );
+    }
+    if( type == 3 ) {
+        setPhase( tile.southWallActiveInPhase, phase, active );
+    }
+    if( type == 4 ) {
+        setPhase( tile.westWallActiveInPhase, phase, active );
+    }
+
+    setTile( position, tile );
+}
+
+QPoint BoardWidget::selectedTile() const
+{
+    return m_selectedTile;
+}
+
+QRect BoardWidget::selectedRegion() const
+{
+    return m_selectedRegion;
+}
+
+BoardRegion_T BoardWidget::copyRegion() const
+{
+    BoardRegion_T region;
+    region.size = m_selectedRegion.size();
+
+    for( int y = m_selectedRegion.top(); y <= m_selectedRegion.bottom(); y++ ) {
+        for( int x = m_selectedRegion.left(); x <= m_selectedRegion.right(); x++ ) {
+            region.tiles.append( tileAt( QPoint( x, y ) ) );
+        }
+    }
+
+    return region;
+}
+
+void BoardWidget::pasteRegion( const BoardRegion_T &region )
+{
+    if( m_selectedRegion.isEmpty() || region.tiles.size() != region.size.width() * region.size.height() ) {
+        return;
+    }
+
+    QVector<TileChange_T> changes;
+    for( int y = 0; y < region.size.height(); y++ ) {
+        for( int x = 0; x < region.size.width(); x++ ) {
+            TileChange_T change;
+            change.position = m_selectedRegion.topLeft() + QPoint( x, y );
+            if( !isOnBoard( change.position ) ) {
+                continue;
+            }
+            change.oldTile = tileAt( change.position );
+            change.newTile = region.tiles.at( Core::toPos( x, y, region.size.width() ) );
+            changes.append( change );
+        }
+    }
+
+    pushTileChanges( changes, tr( "Paste Region" ) );
+
+    QRect pastedRegion( m_selectedRegion.topLeft(), region.size );
+    setSelectedRegion( pastedRegion.intersected( QRect( QPoint( 0, 0 ), m_board.size ) ) );
+}
+
+void BoardWidget::rotateRegion()
+{
+    if( m_selectedRegion.isEmpty() ) {
+        return;
+    }
+
+    BoardRegion_T region = copyRegion();
+    QRect rotatedRegion( m_selectedRegion.topLeft(), QSize( region.size.height(), region.size.width() ) );
+    rotatedRegion = rotatedRegion.intersected( QRect( QPoint( 0, 0 ), m_board.size ) );
+
+    // the old region is cleared first, the rotated tiles replace the empty tiles afterwards
+    QMap<int, Core::BoardTile_T> newTiles;
+    for( int y = m_selectedRegion.top(); y <= m_selectedRegion.bottom(); y++ ) {
+        for( int x = m_selectedRegion.left(); x <= m_selectedRegion.right(); x++ ) {
+            newTiles.insert( Core::toPos( x, y, m_board.size.width() ), emptyTile() );
+        }
+    }
+
+    for( int y = 0; y < region.size.height(); y++ ) {
+        for( int x = 0; x < region.size.width(); x++ ) {
+            QPoint position = rotatedRegion.topLeft() + QPoint( region.size.height() - 1 - y, x );
+            if( !rotatedRegion.contains( position ) ) {
+                continue;
             }
+            newTiles.insert( Core::toPos( position.x(), position.y(), m_board.size.width() ),
+                             rotateTile( region.tiles.at( Core::toPos( x, y, region.size.width() ) ) ) );
+        }
+    }
+
+    QVector<TileChange_T> changes;
+    QMapIterator<int, Core::BoardTile_T> i( newTiles );
+    while( i.hasNext() ) {
+        i.next();
+        TileChange_T change;
+        change.position = QPoint( i.key() % m_board.size.width(), i.key() / m_board.size.width() );
+        change.oldTile = tileAt( change.position );
+        change.newTile = i.value();
+        changes.append( change );
+    }
 
-            newTile = boardTile->getBoardTileInfo();
-            newBoard.tiles.append( newTile );
+    pushTileChanges( changes, tr( "Rotate Region" ) );
+    setSelectedRegion( rotatedRegion );
+}
+
+void BoardWidget::fillRegion()
+{
+    QVector<TileChange_T> changes;
+    for( int y = m_selectedRegion.top(); y <= m_selectedRegion.bottom(); y++ ) {
+        for( int x = m_selectedRegion.left(); x <= m_selectedRegion.right(); x++ ) {
+            TileChange_T change;
+            change.position = QPoint( x, y );
+            change.oldTile = tileAt( change.position );
+            change.newTile = change.oldTile;
+            if( !drawOnTile( change.newTile, false ) ) {
+                return;
+            }
+            changes.append( change );
         }
     }
 
-    m_boardChanged = false;
-    return newBoard;
+    pushTileChanges( changes, tr( "Fill Region" ) );
 }
 
 void BoardWidget::setFileName(const QString &filename)
@@ -168,51 +457,51 @@ void BoardWidget::tileSelectionChanged(QListWidgetItem* newSelection)
 
 void BoardWidget::setName( const QString &name )
 {
-    m_name = name;
+    m_board.name = name;
     m_boardChanged = true;
 }
 
 QString BoardWidget::getName() const
 {
-    return m_name;
+    return m_board.name;
 }
 
 void BoardWidget::setEmail( const QString &email )
 {
-    m_email = email;
+    m_board.email = email;
     m_boardChanged = true;
 }
 
 QString BoardWidget::getEmail() const
 {
-    return m_email;
+    return m_board.email;
 }
 
 void BoardWidget::setDescription( const QString &dsc )
 {
-    m_description = dsc;
+    m_board.description = dsc;
     m_boardChanged = true;
 }
 
 QString BoardWidget::getDescription() const
 {
-    return m_description;
+    return m_board.description;
 }
 
 void BoardWidget::setAuthor( const QString &name )
 {
-    m_author = name;
+    m_board.author = name;
     m_boardChanged = true;
 }
 
 QString BoardWidget::getAuthor() const
 {
-    return m_author;
+    return m_board.author;
 }
 
 QSize BoardWidget::getSize() const
 {
-    return m_boardSize;
+    return m_board.size;
 }
 
 bool BoardWidget::getBoardChanged() const
@@ -232,46 +521,189 @@ void BoardWidget::setToEditMode()
 
 void BoardWidget::mousePressEvent( QMouseEvent *event )
 {
-    BoardTile *boardTile = qobject_cast<BoardTile *>( childAt( event->pos() ) );
+    QPoint position = tilePosition( event->pos() );
+    m_painting = false;
+
+    if( !isOnBoard( position ) ) {
+        emit activatedTile( 0, position );
+        return;
+    }
 
-    emit activatedTile( boardTile );
+    // shift + click extends the selection to a region, the selected tile stays its corner
+    if( ( event->modifiers() & Qt::ShiftModifier ) && isOnBoard( m_selectedTile ) ) {
+        setSelectedRegion( QRect( m_selectedTile, position ).normalized() );
+        return;
+    }
+
+    if( position != m_selectedTile ) {
+        if( isOnBoard( m_selectedTile ) ) {
+            update( tileRect( m_selectedTile ) );
+        }
+        m_selectedTile = position;
+        update( tileRect( m_selectedTile ) );
+    }
+    setSelectedRegion( QRect( position, QSize( 1, 1 ) ) );
+
+    emit activatedTile( this, position );
 
     if( !m_drawModeEnabled ) {
         return;
     }
 
-    bool eraseMode = false;
-    if( event->button() == Qt::RightButton) {
-        eraseMode = true;
+    // all tiles drawn until the button is released are undone together
+    m_paintStroke++;
+    m_painting = true;
+    paintTile( position, event->button() == Qt::RightButton );
+}
+
+void BoardWidget::mouseMoveEvent( QMouseEvent *event )
+{
+    QPoint position = tilePosition( event->pos() );
+    if( position == m_highlightTile ) {
+        return;
+    }
+
+    if( m_painting && m_drawModeEnabled && isOnBoard( position ) && ( event->buttons() & ( Qt::LeftButton | Qt::RightButton ) ) ) {
+        paintTile( position, event->buttons().testFlag( Qt::RightButton ) );
+    }
+
+    // only the old and the new highlighted tile are repainted
+    if( isOnBoard( m_highlightTile ) ) {
+        update( tileRect( m_highlightTile ) );
+    }
+    m_highlightTile = position;
+    if( isOnBoard( m_highlightTile ) ) {
+        update( tileRect( m_highlightTile ) );
+    }
+}
+
+void BoardWidget::mouseReleaseEvent( QMouseEvent *event )
+{
+    Q_UNUSED( event );
+
+    m_painting = false;
+}
+
+void BoardWidget::leaveEvent( QEvent *event )
+{
+    Q_UNUSED( event );
+
+    if( isOnBoard( m_highlightTile ) ) {
+        update( tileRect( m_highlightTile ) );
     }
+    m_highlightTile = QPoint( -1, -1 );
+}
+
+void BoardWidget::paintEvent( QPaintEvent *event )
+{
+    QPainter painter( this );
+    painter.fillRect( event->rect(), palette().window() );
 
-    if( !boardTile ) {
+    if( !m_renderer || m_board.size.isEmpty() ) {
         return;
     }
 
-    if( !m_currentTile ) {
+    Renderer::TileTheme *tileTheme = m_renderer->getTileTheme();
+
+    QPen gridPen;
+    gridPen.setColor( Qt::black );
+    gridPen.setWidth( 1 );
+
+    // only the tiles of the dirty region are drawn
+    QRect exposed = event->rect();
+    QPoint topLeft = tilePosition( exposed.topLeft() );
+    QPoint bottomRight = tilePosition( exposed.bottomRight() );
+    int firstX = qMax( 0, topLeft.x() );
+    int firstY = qMax( 0, topLeft.y() );
+    int lastX = bottomRight.x() < 0 ? m_board.size.width() - 1 : bottomRight.x();
+    int lastY = bottomRight.y() < 0 ? m_board.size.height() - 1 : bottomRight.y();
+
+    for( int y = firstY; y <= lastY; y++ ) {
+        for( int x = firstX; x <= lastX; x++ ) {
+            QRect drawRect = tileRect( QPoint( x, y ) );
+            if( !event->region().intersects( drawRect ) ) {
+                continue;
+            }
+
+            const Core::BoardTile_T &tile = m_board.tiles.at( Core::toPos( x, y, m_board.size.width() ) );
+
+            painter.setPen( gridPen );
+            painter.drawRect( drawRect.adjusted( 0, 0, -1, -1 ) );
+
+            if( tile.type != Core::FLOOR_ERROR ) {
+                tileTheme->drawSprite( &painter, drawRect, tileTheme->tileId( tile.type ), tile.alignment );
+            }
+            if( tile.northWall != Core::WALL_ERROR ) {
+                tileTheme->drawSprite( &painter, drawRect, tileTheme->tileId( tile.northWall ), Core::NORTH );
+            }
+            if( tile.eastWall != Core::WALL_ERROR ) {
+                tileTheme->drawSprite( &painter, drawRect, tileTheme->tileId( tile.eastWall ), Core::EAST );
+            }
+            if( tile.southWall != Core::WALL_ERROR ) {
+                tileTheme->drawSprite( &painter, drawRect, tileTheme->tileId( tile.southWall ), Core::SOUTH );
+            }
+            if( tile.westWall != Core::WALL_ERROR ) {
+                tileTheme->drawSprite( &painter, drawRect, tileTheme->tileId( tile.westWall ), Core::WEST );
+            }
+
+            if( m_selectedRegion.width() * m_selectedRegion.height() > 1 && m_selectedRegion.contains( x, y ) ) {
+                painter.fillRect( drawRect, QColor( 0, 0, 255, 60 ) );
+            }
+
+            if( m_selectedTile == QPoint( x, y ) ) {
+                QPen pen;
+                pen.setColor( Qt::blue );
+                pen.setWidth( 2 );
+                painter.setPen( pen );
+                painter.drawRect( drawRect.adjusted( 1, 1, -1, -1 ) );
+            }
+
+            if( m_highlightTile == QPoint( x, y ) ) {
+                QPen pen;
+                pen.setColor( Qt::red );
+                pen.setWidth( 2 );
+                painter.setPen( pen );
+                painter.drawRect( drawRect.adjusted( 1, 1, -1, -1 ) );
+            }
+        }
+    }
+}
+
+void BoardWidget::pushTileChanges( const QVector<TileChange_T> &changes, const QString &text, int stroke )
+{
+    // only real changes are stored, so the command size depends on the changed tiles and not on the board
+    QVector<TileChange_T> changedTiles;
+    foreach( const TileChange_T &change, changes ) {
+        if( !sameTile( change.oldTile, change.newTile ) ) {
+            changedTiles.append( change );
+        }
+    }
+
+    if( changedTiles.isEmpty() ) {
         return;
     }
 
+    m_undoStack->push( new ChangeTilesCommand( this, changedTiles, text, stroke ) );
+}
+
+bool BoardWidget::drawOnTile( Core::BoardTile_T &tile, bool eraseMode ) const
+{
+    if( !m_currentTile ) {
+        return false;
+    }
+
     // it is a floor item
     if( (TileSelection)m_currentTile->data( TILE_SELECTION ).toInt() == TILE_FLOOR ) {
-        Core::FloorTileType floor;
-        Core::Orientation orientation;
-
         if(eraseMode) {
-            floor = Core::FLOOR_EDGE;
-            orientation = Core::NORTH;
+            setFloor( tile, Core::FLOOR_EDGE, Core::NORTH, allPhasesActive() );
         }
         else {
-            floor = ( Core::FloorTileType )m_currentTile->data( TILE_TYPE ).toInt();
-            orientation = ( Core::Orientation )m_currentTile->data( TILE_ORIENTATION ).toInt();
+            setFloor( tile, ( Core::FloorTileType )m_currentTile->data( TILE_TYPE ).toInt(),
+                      ( Core::Orientation )m_currentTile->data( TILE_ORIENTATION ).toInt(), allPhasesActive() );
         }
-
-        boardTile->changeFloor( floor, orientation );
     }
     //it is a wall item
     else if( (TileSelection)m_currentTile->data( TILE_SELECTION ).toInt() == TILE_WALL ) {
-
         Core::WallTileType wall;
         Core::Orientation orientation = ( Core::Orientation )m_currentTile->data( TILE_ORIENTATION ).toInt();
         if(eraseMode) {
@@ -281,13 +713,106 @@ void BoardWidget::mousePressEvent( QMouseEvent *event )
             wall = ( Core::WallTileType )m_currentTile->data( TILE_TYPE ).toInt();
         }
 
-        boardTile->changeWall( wall, orientation );
+        setWall( tile, wall, orientation, allPhasesActive() );
     }
     //it is a special item
-    else if( (TileSelection)m_currentTile->data( TILE_SELECTION ).toInt() == TILE_SPECIAL ) {
+    else {
         qWarning() << "tried to add a special item to a board. Can only be done on a scene";
+        return false;
     }
 
-    m_boardChanged = true;
+    return true;
 }
 
+void BoardWidget::paintTile( const QPoint &position, bool eraseMode )
+{
+    TileChange_T change;
+    change.position = position;
+    change.oldTile = tileAt( position );
+    change.newTile = change.oldTile;
+
+    if( !drawOnTile( change.newTile, eraseMode ) ) {
+        return;
+    }
+
+    pushTileChanges( QVector<TileChange_T>() << change, eraseMode ? tr( "Erase Tiles" ) : tr( "Draw Tiles" ), m_paintStroke );
+}
+
+void BoardWidget::setSelectedRegion( const QRect &region )
+{
+    if( region == m_selectedRegion ) {
+        return;
+    }
+
+    if( !m_selectedRegion.isEmpty() ) {
+        update( regionRect( m_selectedRegion ) );
+    }
+    m_selectedRegion = region;
+    if( !m_selectedRegion.isEmpty() ) {
+        update( regionRect( m_selectedRegion ) );
+    }
+}
+
+Core::BoardTile_T BoardWidget::emptyTile()
+{
+    Core::BoardTile_T tile;
+    tile.type = Core::FLOOR_EDGE;
+    tile.alignment = Core::NORTH;
+    tile.northWall = Core::WALL_NONE;
+    tile.eastWall = Core::WALL_NONE;
+    tile.southWall = Core::WALL_NONE;
+    tile.westWall = Core::WALL_NONE;
+
+    tile.floorActiveInPhase = allPhasesActive();
+    tile.northWallActiveInPhase = allPhasesActive();
+    tile.eastWallActiveInPhase = allPhasesActive();
+    tile.southWallActiveInPhase = allPhasesActive();
+    tile.westWallActiveInPhase = allPhasesActive();
+
+    tile.robot = 0;
+
+    return tile;
+}
+
+QRect BoardWidget::tileRect( const QPoint &position ) const
+{
+    QSize tileSize = m_tileSize * m_renderer->getTileScale();
+    return QRect( position.x() * tileSize.width(), position.y() * tileSize.height(),
+                  tileSize.width(), tileSize.height() );
+}
+
+QPoint BoardWidget::tilePosition( const QPoint &pos ) const
+{
+    QSize tileSize = m_tileSize * m_renderer->getTileScale();
+    if( tileSize.isEmpty() || pos.x() < 0 || pos.y() < 0 ) {
+        return QPoint( -1, -1 );
+    }
+
+    QPoint position( pos.x() / tileSize.width(), pos.y() / tileSize.height() );
+    if( !isOnBoard( position ) ) {
+        return QPoint( -1, -1 );
+    }
+
+    return position;
+}
+
+QRect BoardWidget::regionRect( const QRect &region ) const
+{
+    return tileRect( region.topLeft() ).united( tileRect( region.bottomRight() ) );
+}
+
+bool BoardWidget::isOnBoard( const QPoint &position ) const
+{
+    return position.x() >= 0 && position.y() >= 0
+           && position.x() < m_board.size.width() && position.y() < m_board.size.height();
+}
+
+void BoardWidget::resizeToBoard()
+{
+    setMinimumSize( m_board.size.width() * m_tileSize.width() * m_renderer->getTileScale(),
+                    m_board.size.height() * m_tileSize.height() * m_renderer->getTileScale() );
+    setMaximumSize( m_board.size.width() * m_tileSize.width() * m_renderer->getTileScale(),
+                    m_board.size.height() * m_tileSize.height() * m_renderer->getTileScale() );
+
+    update();
+}
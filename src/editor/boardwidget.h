@@ -21,11 +21,17 @@
 #include <QWidget>
 #include <QString>
 #include <QSize>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
 
 #include "engine/board.h"
+#include "boardcommands.h"
 
 class QMouseEvent;
+class QPaintEvent;
 class QListWidgetItem;
+class QUndoStack;
 
 namespace BotRace {
 namespace Renderer {
@@ -34,15 +40,25 @@ namespace Renderer {
 
 namespace Editor {
 class TileList;
-class BoardTile;
+
+/**
+ * @brief A rectangular part of a board copied with BoardWidget::copyRegion()
+ */
+struct BoardRegion_T {
+    QSize size;                         /**< Width and height of the region in tiles */
+    QVector<Core::BoardTile_T> tiles;   /**< The tiles row by row, like Core::Board_T::tiles */
+};
 
 /**
  * @brief The BoardWidget represents the complete gameboard which can be used in a scenario to play the game on.
  *
  * The board is represented internally as Core::Board_T and as such consists of several tiles each with a floor and 4 walls.
- * The board is implemented as QWidget which holds a bunch of other QWidgets (the tiles) in a gridlike position.
- * Each tile can draw itself and handle all repquests on it sown. The BoardWidget keeps track of changes and the general
- * board information.
+ * The widget is one canvas that draws all tiles from the sprite cache of the Renderer::TileTheme. A change of a tile
+ * only repaints the area of this tile. The selected tile and the tile under the mouse are kept as board positions,
+ * so loading and saving the board simply copies the Core::Board_T.
+ *
+ * Every change of the tiles is pushed as ChangeTilesCommand onto the undoStack() and can be undone.
+ * Shift + click selects a rectangular region that can be copied, pasted, rotated and filled as one command.
  */
 class BoardWidget : public QWidget {
     Q_OBJECT
@@ -56,23 +72,116 @@ public:
     void setRenderer( Renderer::GameTheme *renderer );
 
     /**
-     * @brief Sets up a new board of the size @p boardsize and creates al BoardTile elements
+     * @brief Sets up a new board of the size @p boardsize with empty tiles
      * @param boardsize the size of the board
      */
     void createNewBoard( QSize boardsize );
 
     /**
-     * @brief loads an existing board and creates all BoardTile elements from it
+     * @brief loads an existing board, the tiles are copied as they are
      * @param board the board which should be loaded
      */
     void loadBoard( const Core::Board_T &board );
 
     /**
-     * @brief Created the Core::Board_T object from all BoardTile elements
+     * @brief Returns the Core::Board_T object of the edited board
      * @return the Core::Board_T which can be saved by the boardparser
      */
     Core::Board_T saveBoard();
 
+    /**
+     * @brief Returns the tile at @p position
+     * @param position the x/y coordinates of the tile on the board
+     * @return the tile information or an empty tile if @p position is not on the board
+     */
+    Core::BoardTile_T tileAt( const QPoint &position ) const;
+
+    /**
+     * @brief Replaces the tile at @p position as one undoable command
+     * @param position the x/y coordinates of the tile on the board
+     * @param tile the new tile information
+     */
+    void setTile( const QPoint &position, const Core::BoardTile_T &tile );
+
+    /**
+     * @brief Applies the tile changes of a ChangeTilesCommand and repaints the changed area once
+     *
+     * All changes of the board tiles go through this function. It does not add anything to the undo stack.
+     * @param changes the changed tiles
+     * @param revert @c true to restore the old tiles, @c false to set the new tiles
+     */
+    void applyTileChanges( const QVector<TileChange_T> &changes, bool revert );
+
+    /**
+     * @brief Returns the undo stack with all tile changes since the board was created or loaded
+     */
+    QUndoStack *undoStack() const;
+
+    /**
+     * @brief Changes the floor type of the tile at @p position
+     * @param position the x/y coordinates of the tile on the board
+     * @param newTile The floor tile type
+     * @param rotation the orientation on the board
+     * @param activeIn defines in which of the 5 phases the board element is active
+     */
+    void changeFloor( const QPoint &position, Core::FloorTileType newTile, Core::Orientation rotation, QList<bool> activeIn = QList<bool>() );
+
+    /**
+     * @brief Changes one wall of the tile at @p position
+     * @param position the x/y coordinates of the tile on the board
+     * @param newWall The wall tile type
+     * @param rotation the orientation on the board (so north, east, south, west wall)
+     * @param activeIn defines in which of the 5 phases the board element is active
+     */
+    void changeWall( const QPoint &position, Core::WallTileType newWall, Core::Orientation rotation, QList<bool> activeIn = QList<bool>() );
+
+    /**
+     * @brief Change the active phases of a board element of the tile at @p position
+     * @param position the x/y coordinates of the tile on the board
+     * @param type tells what element to change (floor, northwall, eastwall, southwall, westwall)
+     * @param phase the phase which should be changed (1-5)
+     * @param active if it is active @c true or passive @c false
+     */
+    void setActivePhase( const QPoint &position, int type, int phase, bool active );
+
+    /**
+     * @brief Returns the position of the tile the user clicked on last
+     * @return the tile position or (-1, -1) if no tile is selected
+     */
+    QPoint selectedTile() const;
+
+    /**
+     * @brief Returns the selected region
+     * @return the selected tiles in board coordinates or an empty rect if no tile is selected
+     */
+    QRect selectedRegion() const;
+
+    /**
+     * @brief Copies the tiles of the selected region
+     * @return the copied tiles or an empty region if nothing is selected
+     */
+    BoardRegion_T copyRegion() const;
+
+    /**
+     * @brief Pastes @p region with its top left corner on the selected region as one command
+     *
+     * Tiles outside the board are skipped.
+     * @param region the tiles to paste
+     */
+    void pasteRegion( const BoardRegion_T &region );
+
+    /**
+     * @brief Rotates the selected region by 90° clockwise around its top left corner as one command
+     *
+     * Floor alignment and walls are rotated with the tiles. Tiles uncovered by the rotated region are cleared.
+     */
+    void rotateRegion();
+
+    /**
+     * @brief Draws the tile selected in the tile list on all tiles of the selected region as one command
+     */
+    void fillRegion();
+
     /**
      * @brief Sets the filename and pather where the board was saved to
      * @param filename the filename where the board was saved
@@ -165,9 +274,10 @@ signals:
      * @brief Returns the last tile the user clicked on.
      *
      * Additional tile information will be shown in the connected TileDetailWidget
-     * @param tile the selected board tile
+     * @param board this board or 0 if the user clicked beside the tiles
+     * @param position the x/y coordinates of the selected tile
      */
-    void activatedTile(BoardTile *tile);
+    void activatedTile( BoardWidget *board, const QPoint &position );
 
 public slots:
     /**
@@ -194,16 +304,99 @@ protected:
      */
     void mousePressEvent( QMouseEvent *event );
 
+    /**
+     * @brief Moves the highlight to the tile under the mouse cursor
+     * @param event some additional event information
+     */
+    void mouseMoveEvent( QMouseEvent *event );
+
+    /**
+     * @brief Ends the current paint stroke
+     * @param event some additional event information
+     */
+    void mouseReleaseEvent( QMouseEvent *event );
+
+    /**
+     * @brief Removes the highlight when the mouse leaves the board
+     * @param event some additional event information
+     */
+    void leaveEvent( QEvent *event );
+
+    /**
+     * @brief Draws all tiles in the exposed region
+     * @param event some additional event information
+     */
+    void paintEvent( QPaintEvent *event );
+
 private:
+    /**
+     * @brief Returns a tile with the board edge as floor, no walls and all phases active
+     */
+    static Core::BoardTile_T emptyTile();
+
+    /**
+     * @brief Pushes the @p changes that really change a tile as ChangeTilesCommand onto the undo stack
+     * @param changes the tile changes
+     * @param text the text shown in the undo/redo actions
+     * @param stroke the paint stroke the changes should be merged with or -1
+     */
+    void pushTileChanges( const QVector<TileChange_T> &changes, const QString &text, int stroke = -1 );
+
+    /**
+     * @brief Draws the tile list selection on @p tile
+     * @param tile the tile which gets the new floor or wall
+     * @param eraseMode @c true resets the floor or wall instead
+     * @return @c false if no floor or wall item is selected in the tile list
+     */
+    bool drawOnTile( Core::BoardTile_T &tile, bool eraseMode ) const;
+
+    /**
+     * @brief Draws the tile list selection on the tile at @p position, merged with the current paint stroke
+     */
+    void paintTile( const QPoint &position, bool eraseMode );
+
+    /**
+     * @brief Changes the selected region and repaints the old and the new selection
+     */
+    void setSelectedRegion( const QRect &region );
+
+    /**
+     * @brief Returns the widget area of the tile at @p position
+     */
+    QRect tileRect( const QPoint &position ) const;
+
+    /**
+     * @brief Returns the widget area of all tiles in @p region
+     */
+    QRect regionRect( const QRect &region ) const;
+
+    /**
+     * @brief Returns the board position of the tile at the widget coordinates @p pos or (-1, -1)
+     */
+    QPoint tilePosition( const QPoint &pos ) const;
+
+    /**
+     * @brief Checks if @p position is on the board
+     */
+    bool isOnBoard( const QPoint &position ) const;
+
+    /**
+     * @brief Resizes the widget to the size of the board
+     */
+    void resizeToBoard();
+
     Renderer::GameTheme *m_renderer;    /**< The used renderer to draw the tiles */
     QListWidgetItem *m_currentTile;     /**< Saves which tile should be drawn on the next left-click */
 
-    QString m_name;         /**< Saves the name of the board */
-    QString m_author;       /**< Saves the author of the board */
-    QString m_email;        /**< Saves the author email of the board */
-    QString m_description;  /**< Saves a longer board description */
-    QSize m_boardSize;      /**< Saves the board size */
-    QSize m_tileSize;       /**< Saves the size of one tile used to determine the BoardTile size*/
+    Core::Board_T m_board;  /**< The board model with name, author, size and all tiles */
+    QSize m_tileSize;       /**< Saves the unscaled size of one tile */
+    QPoint m_selectedTile;  /**< The tile the user clicked on last or (-1, -1) */
+    QPoint m_highlightTile; /**< The tile under the mouse cursor or (-1, -1) */
+    QRect m_selectedRegion; /**< The selected tiles, the selected tile or a region selected with shift + click */
+
+    QUndoStack *m_undoStack;    /**< All tile changes as ChangeTilesCommand */
+    int m_paintStroke;          /**< Counts the mouse presses, changes of one press are merged into one command */
+    bool m_painting;            /**< Saves if a press started a paint stroke that is continued while the mouse is dragged */
 
     QString m_fileName;     /**< Saves the filename where the board was saved last */
     bool m_boardChanged;    /**< Saves if the boar dwas changed since the last save */
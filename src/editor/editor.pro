@@ -34,7 +34,7 @@ HEADERS += \
     tilelist.h \
     editorwindow.h \
     boardwidget.h \
-    boardtile.h \
+    boardcommands.h \
     boarddetails.h \
     tiledetailwidget.h \
     boardscenarioscene.h \
@@ -46,7 +46,7 @@ SOURCES += \
     tilelist.cpp \
     editorwindow.cpp \
     boardwidget.cpp \
-    boardtile.cpp \
+    boardcommands.cpp \
     boarddetails.cpp \
     tiledetailwidget.cpp \
     boardscenarioscene.cpp \
@@ -35,6 +35,7 @@
 
 #include <QSettings>
 #include <QHBoxLayout>
+#include <QUndoGroup>
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -52,10 +53,23 @@ using namespace Editor;
 EditorWindow::EditorWindow( QWidget *parent ) :
     QMainWindow( parent ),
     ui( new Ui::EditorWindow ),
-    m_renderer( 0 )
+    m_renderer( 0 ),
+    m_undoGroup( new QUndoGroup( this ) )
 {
     ui->setupUi( this );
 
+    // undo and redo always work on the board of the current tab
+    QAction *undoAction = m_undoGroup->createUndoAction( this );
+    undoAction->setShortcut( QKeySequence::Undo );
+    QAction *redoAction = m_undoGroup->createRedoAction( this );
+    redoAction->setShortcut( QKeySequence::Redo );
+    ui->menuEdit_Board->insertAction( ui->actionBoard_properties, undoAction );
+    ui->menuEdit_Board->insertAction( ui->actionBoard_properties, redoAction );
+    ui->menuEdit_Board->insertSeparator( ui->actionBoard_properties );
+    ui->toolBar->addSeparator();
+    ui->toolBar->addAction( undoAction );
+    ui->toolBar->addAction( redoAction );
+
     QSettings settings;
 
     m_renderer = new Renderer::GameTheme();
@@ -113,11 +127,12 @@ void EditorWindow::newBoard()
         bw->setEmail( dialog.getEmail() );
         bw->setDescription( dialog.getDescription() );
         m_openBoards.append(bw);
+        m_undoGroup->addStack( bw->undoStack() );
 
         connect( ui->tileList_Floor, SIGNAL( itemClicked (QListWidgetItem*) ), bw, SLOT( tileSelectionChanged(QListWidgetItem*) ));
         connect( ui->tileList_Wall, SIGNAL( itemClicked (QListWidgetItem*) ), bw, SLOT( tileSelectionChanged(QListWidgetItem*) ));
 
-        connect(bw, SIGNAL(activatedTile(BoardTile*)), ui->tileDetails, SLOT(showBoardTile(BoardTile*)));
+        connect(bw, SIGNAL(activatedTile(BoardWidget*,QPoint)), ui->tileDetails, SLOT(showBoardTile(BoardWidget*,QPoint)));
         connect(ui->actionUpdate_Laserbeams, SIGNAL(triggered()), bw, SLOT(updateLasers()) );
 
         // now add a new tab and show the board there
@@ -156,11 +171,12 @@ void EditorWindow::loadBoard()
         bw->setRenderer(m_renderer);
         bw->loadBoard( newBoard );
         m_openBoards.append(bw);
+        m_undoGroup->addStack( bw->undoStack() );
 
         connect( ui->tileList_Floor, SIGNAL( itemClicked(QListWidgetItem*) ), bw, SLOT( tileSelectionChanged(QListWidgetItem*) ));
         connect( ui->tileList_Wall, SIGNAL( itemClicked(QListWidgetItem*) ), bw, SLOT( tileSelectionChanged(QListWidgetItem*) ));
 
-        connect(bw, SIGNAL(activatedTile(BoardTile*)), ui->tileDetails, SLOT(showBoardTile(BoardTile*)));
+        connect(bw, SIGNAL(activatedTile(BoardWidget*,QPoint)), ui->tileDetails, SLOT(showBoardTile(BoardWidget*,QPoint)));
         connect(ui->actionUpdate_Laserbeams, SIGNAL(triggered()), bw, SLOT(updateLasers()) );
 
         // now add a new tab and show the board there
@@ -528,6 +544,47 @@ void EditorWindow::addCurrentBoardToScenario()
     qDebug() << "Slot add board to scenario";
 }
 
+void EditorWindow::copyRegion()
+{
+    BoardWidget *bw = currentBoard();
+    if(!bw) {
+        return;
+    }
+
+    m_copiedRegion = bw->copyRegion();
+    statusBar()->showMessage( tr( "Copied %1 x %2 tiles" ).arg(m_copiedRegion.size.width()).arg(m_copiedRegion.size.height()), 2000 );
+}
+
+void EditorWindow::pasteRegion()
+{
+    BoardWidget *bw = currentBoard();
+    if(!bw || m_copiedRegion.tiles.isEmpty()) {
+        return;
+    }
+
+    bw->pasteRegion( m_copiedRegion );
+}
+
+void EditorWindow::rotateRegion()
+{
+    BoardWidget *bw = currentBoard();
+    if(!bw) {
+        return;
+    }
+
+    bw->rotateRegion();
+}
+
+void EditorWindow::fillRegion()
+{
+    BoardWidget *bw = currentBoard();
+    if(!bw) {
+        return;
+    }
+
+    bw->fillRegion();
+}
+
 void EditorWindow::addBoardToScenario()
 {
     //open board selection menu
@@ -594,6 +651,9 @@ void EditorWindow::boardTabChanged(int newTabIndex)
     BoardWidget *bw = qobject_cast<BoardWidget *>(ui->tabWidget_Boards->widget(newTabIndex) );
     QGraphicsView *gv = qobject_cast<QGraphicsView *>(ui->tabWidget_Boards->widget(newTabIndex) );
 
+    // only the history of the shown board can be undone
+    m_undoGroup->setActiveStack( bw ? bw->undoStack() : 0 );
+
     // board edit
     if(bw) {
         ui->menuEdit_Board->setEnabled(true);
@@ -629,6 +689,11 @@ void EditorWindow::boardTabChanged(int newTabIndex)
     }
 }
 
+BoardWidget *EditorWindow::currentBoard() const
+{
+    return qobject_cast<BoardWidget *>( ui->tabWidget_Boards->currentWidget() );
+}
+
 QString EditorWindow::findDefaultDataDirectory()
 {
     QString dataDirectory;
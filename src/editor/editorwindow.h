@@ -20,7 +20,10 @@
 
 #include <QMainWindow>
 
+#include "boardwidget.h"
+
 class QGraphicsView;
+class QUndoGroup;
 
 namespace Ui {
 class EditorWindow;
@@ -32,7 +35,6 @@ class GameTheme;
 }
 namespace Editor {
 class TileList;
-class BoardWidget;
 
 class EditorWindow : public QMainWindow {
     Q_OBJECT
@@ -63,6 +65,11 @@ public slots:
     void changeBoardProperties();
     void addCurrentBoardToScenario();
 
+    void copyRegion();
+    void pasteRegion();
+    void rotateRegion();
+    void fillRegion();
+
     //Edit scenario menu
     void addBoardToScenario();
     void changeScenarioProperties();
@@ -77,11 +84,15 @@ public slots:
 
 private:
     QString findDefaultDataDirectory();
+    BoardWidget *currentBoard() const;
     Ui::EditorWindow *ui;
 
     Renderer::GameTheme *m_renderer;
     QList<BoardWidget *> m_openBoards;
     QList<QGraphicsView *> m_openScenarios;
+
+    QUndoGroup *m_undoGroup;
+    BoardRegion_T m_copiedRegion;
 };
 
 }
@@ -18,7 +18,7 @@
 #include "tiledetailwidget.h"
 #include "ui_tiledetailwidget.h"
 
-#include "boardtile.h"
+#include "boardwidget.h"
 #include "engine/board.h"
 #include "renderer/tiletheme.h"
 
@@ -27,7 +27,8 @@ using namespace Editor;
 
 TileDetailWidget::TileDetailWidget(QWidget *parent) :
     QWidget(parent),
-    ui(new Ui::TileDetailWidget)
+    ui(new Ui::TileDetailWidget),
+    m_board( 0 )
 {
     ui->setupUi(this);
     setEnabled( false );
@@ -44,11 +45,12 @@ void TileDetailWidget::setRenderer( Renderer::TileTheme *renderer )
     connect( m_renderer, SIGNAL( updateAvailable() ), this, SLOT( setupUi() ) );
 }
 
-void TileDetailWidget::showBoardTile(BoardTile *tile)
+void TileDetailWidget::showBoardTile( BoardWidget *board, const QPoint &position )
 {
-    m_currentTile = tile;
+    // the tile is shown first, the combobox signals must not change it
+    m_board = 0;
 
-    if( m_currentTile == 0) {
+    if( board == 0) {
         setEnabled( false );
         return;
     }
@@ -56,9 +58,9 @@ void TileDetailWidget::showBoardTile(BoardTile *tile)
         setEnabled( true );
     }
 
-    ui->groupBox->setTitle( QString("Tile %1 x %2").arg(tile->getXPosition()).arg(tile->getYPosition()) );
+    ui->groupBox->setTitle( QString("Tile %1 x %2").arg(position.x()).arg(position.y()) );
 
-    Core::BoardTile_T tileInfo = tile->getBoardTileInfo();
+    Core::BoardTile_T tileInfo = board->tileAt( position );
 
     ui->cb_FloorType->setCurrentIndex( ( (int)tileInfo.type) - 1);
     ui->cb_FloorRot->setCurrentIndex( ( (int)tileInfo.alignment));
@@ -96,90 +98,97 @@ void TileDetailWidget::showBoardTile(BoardTile *tile)
     ui->cb_westActive3->setChecked( tileInfo.westWallActiveInPhase.at(2) );
     ui->cb_westActive4->setChecked( tileInfo.westWallActiveInPhase.at(3) );
     ui->cb_westActive5->setChecked( tileInfo.westWallActiveInPhase.at(4) );
+
+    m_board = board;
+    m_currentTile = position;
 }
 
 void TileDetailWidget::changeActivePhase(bool checked)
 {
+    if( !m_board ) {
+        return;
+    }
+
     QCheckBox *cb = qobject_cast<QCheckBox *>(sender());
 
     if( cb == ui->cb_floorActive1 ) {
-        m_currentTile->setActivePhase(0, 1, checked);
+        m_board->setActivePhase(m_currentTile, 0, 1, checked);
     }
     else if( cb == ui->cb_floorActive2 ) {
-        m_currentTile->setActivePhase(0, 2, checked);
+        m_board->setActivePhase(m_currentTile, 0, 2, checked);
     }
     else if( cb == ui->cb_floorActive3 ) {
-        m_currentTile->setActivePhase(0, 3, checked);
+        m_board->setActivePhase(m_currentTile, 0, 3, checked);
     }
     else if( cb == ui->cb_floorActive4 ) {
-        m_currentTile->setActivePhase(0, 4, checked);
+        m_board->setActivePhase(m_currentTile, 0, 4, checked);
     }
     else if( cb == ui->cb_floorActive5 ) {
-        m_currentTile->setActivePhase(0, 5, checked);
+        m_board->setActivePhase(m_currentTile, 0, 5, checked);
     }
 
     else if( cb == ui->cb_northActive ) {
-        m_currentTile->setActivePhase(1, 1, checked);
+        m_board->setActivePhase(m_currentTile, 1, 1, checked);
     }
     else if( cb == ui->cb_northActive2 ) {
-        m_currentTile->setActivePhase(1, 2, checked);
+        m_board->setActivePhase(m_currentTile, 1, 2, checked);
     }
     else if( cb == ui->cb_northActive3 ) {
-        m_currentTile->setActivePhase(1, 3, checked);
+        m_board->setActivePhase(m_currentTile, 1, 3, checked);
     }
     else if( cb == ui->cb_northActive4 ) {
-        m_currentTile->setActivePhase(1, 4, checked);
+        m_board->setActivePhase(m_currentTile, 1, 4, checked);
     }
     else if( cb == ui->cb_northActive5 ) {
-        m_currentTile->setActivePhase(1, 5, checked);
+        m_board->setActivePhase(m_currentTile, 1, 5, checked);
     }
 
     else if( cb == ui->cb_eastActive1 ) {
-        m_currentTile->setActivePhase(2, 1, checked);
+        m_board->setActivePhase(m_currentTile, 2, 1, checked);
     }
     else if( cb == ui->cb_eastActive2 ) {
-        m_currentTile->setActivePhase(2, 2, checked);
+        m_board->setActivePhase(m_currentTile, 2, 2, checked);
     }
     else if( cb == ui->cb_eastActive3 ) {
-        m_currentTile->setActivePhase(2, 3, checked);
+        m_board->setActivePhase(m_currentTile, 2, 3, checked);
     }
     else if( cb == ui->cb_eastActive4 ) {
-        m_currentTile->setActivePhase(2, 4, checked);
+        m_board->setActivePhase(m_currentTile, 2, 4, checked);
     }
     else if( cb == ui->cb_eastActive5 ) {
-        m_currentTile->setActivePhase(2, 5, checked);
+        m_board->setActivePhase(m_currentTile, 2, 5, checked);
     }
 
     else if( cb == ui->cb_southActive1 ) {
-        m_currentTile->setActivePhase(3, 1, checked);
+        m_board->setActivePhase(m_currentTile, 3, 1, checked);
     }
     else if( cb == ui->cb_southActive2 ) {
-        m_currentTile->setActivePhase(3, 2, checked);
+        m_board->setActivePhase(m_currentTile, 3, 2, checked);
     }
     else if( cb == ui->cb_southActive3 ) {
-        m_currentTile->setActivePhase(3, 3, checked);
+        m_board->setActivePhase(m_currentTile, 3, 3, checked);
     }
     else if( cb == ui->cb_southActive4 ) {
-        m_currentTile->setActivePhase(3, 4, checked);
+        m_board->setActivePhase(m_currentTile, 3, 4, checked);
     }
     else if( cb == ui->cb_southActive5 ) {
-        m_currentTile->setActivePhase(3, 5, checked);
+        m_board->setActivePhase(m_currentTile, 3, 5, checked);
     }
 
     else if( cb == ui->cb_westActive1 ) {
-        m_currentTile->setActivePhase(4, 1, checked);
+        m_board->setActivePhase(m_currentTile, 4, 1, checked);
     }
     else if( cb == ui->cb_westActive2 ) {
-        m_currentTile->setActivePhase(4, 2, checked);
+        m_board->setActivePhase(m_currentTile, 4, 2, checked);
     }
     else if( cb == ui->cb_westActive3 ) {
-        m_currentTile->setActivePhase(4, 3, checked);
+        m_board->setActivePhase(m_currentTile, 4, 3, checked);
     }
     else if( cb == ui->cb_westActive4 ) {
-        m_currentTile->setActivePhase(4, 4, checked);
+        m_board->setActivePhase(m_currentTile, 4, 4, checked);
     }
     else if( cb == ui->cb_westActive5 ) {
-        m_currentTile->setActivePhase(4, 5, checked);
+        m_board->setActivePhase(m_currentTile, 4, 5, checked);
     }
 }
 
@@ -187,32 +196,36 @@ void TileDetailWidget::tileTypeChanged(int newSelection)
 {
     Q_UNUSED(newSelection)
 
+    if( !m_board ) {
+        return;
+    }
+
     QComboBox *cb = qobject_cast<QComboBox *>(sender());
 
-    Core::BoardTile_T tileInfo = m_currentTile->getBoardTileInfo();
+    Core::BoardTile_T tileInfo = m_board->tileAt( m_currentTile );
 
     if( cb == ui->cb_FloorType || cb == ui->cb_FloorRot) {
-        m_currentTile->changeFloor( Core::FloorTileType (ui->cb_FloorType->currentIndex() + 1),
+        m_board->changeFloor( m_currentTile, Core::FloorTileType (ui->cb_FloorType->currentIndex() + 1),
                                     Core::Orientation (ui->cb_FloorRot->currentIndex() ),
                                     tileInfo.floorActiveInPhase);
     }
     else if( cb == ui->cb_NorthWallType ) {
-        m_currentTile->changeWall(  Core::WallTileType (ui->cb_NorthWallType->currentIndex() + 1),
+        m_board->changeWall(  m_currentTile, Core::WallTileType (ui->cb_NorthWallType->currentIndex() + 1),
                                     Core::NORTH,
                                     tileInfo.northWallActiveInPhase);
     }
     else if( cb == ui->cb_EastWallType ) {
-        m_currentTile->changeWall(  Core::WallTileType (ui->cb_EastWallType->currentIndex() + 1),
+        m_board->changeWall(  m_currentTile, Core::WallTileType (ui->cb_EastWallType->currentIndex() + 1),
                                     Core::EAST,
                                     tileInfo.eastWallActiveInPhase);
     }
     else if( cb == ui->cb_SouthWallType ) {
-        m_currentTile->changeWall(  Core::WallTileType (ui->cb_SouthWallType->currentIndex() + 1),
+        m_board->changeWall(  m_currentTile, Core::WallTileType (ui->cb_SouthWallType->currentIndex() + 1),
                                     Core::SOUTH,
                                     tileInfo.southWallActiveInPhase);
     }
     else if( cb == ui->cb_WestWallType ) {
-        m_currentTile->changeWall(  Core::WallTileType (ui->cb_WestWallType->currentIndex() + 1),
+        m_board->changeWall(  m_currentTile, Core::WallTileType (ui->cb_WestWallType->currentIndex() + 1),
                                     Core::WEST,
                                     tileInfo.westWallActiveInPhase);
     }
@@ -19,6 +19,7 @@
 #define TILEDETAILWIDGET_H
 
 #include <QWidget>
+#include <QPoint>
 
 namespace Ui {
 class TileDetailWidget;
@@ -30,7 +31,7 @@ namespace Renderer {
 }
 
 namespace Editor {
-class BoardTile;
+class BoardWidget;
 
 /**
  * @brief The TileDetailWidget class displayes more detailed information about a single board tile.
@@ -64,9 +65,10 @@ public:
 public slots:
     /**
      * @brief called from the gameboard to display the current selected tile
-     * @param tile the selected tile
+     * @param board the board of the tile or 0 to show no tile
+     * @param position the x/y coordinates of the selected tile
      */
-    void showBoardTile(BoardTile *tile);
+    void showBoardTile( BoardWidget *board, const QPoint &position = QPoint() );
     
 private slots:
     /**
@@ -89,7 +91,8 @@ private slots:
 private:
     Ui::TileDetailWidget *ui;
     Renderer::TileTheme *m_renderer;
-    BoardTile *m_currentTile;
+    BoardWidget *m_board;   /**< The board of the shown tile */
+    QPoint m_currentTile;   /**< The position of the shown tile on m_board */
 };
 
 }
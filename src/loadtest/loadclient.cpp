@@ -0,0 +1,259 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "loadclient.h"
+
+#include "engine/carddeck.h"
+#include "engine/cards.h"
+#include "engine/coreconst.h"
+
+#include <QTcpSocket>
+#include <QTimer>
+#include <QDataStream>
+
+#include <QDebug>
+
+using namespace BotRace;
+using namespace LoadTest;
+
+LoadClient::LoadClient( const QString &name, int animationDelay, QObject *parent ) :
+    QObject( parent ),
+    m_name( name ),
+    m_animationDelay( animationDelay ),
+    m_connection( 0 ),
+    m_deck( new Core::CardDeck() ),
+    m_handshakeDone( false ),
+    m_animationPending( false ),
+    m_animationBarrier( 0 ),
+    m_pendingBarrier( 0 ),
+    m_waitForBarrier( false ),
+    m_waitForRound( false )
+{
+}
+
+LoadClient::~LoadClient()
+{
+    delete m_connection;
+    delete m_deck;
+}
+
+void LoadClient::connectToServer( const QString &host, quint16 port )
+{
+    QTcpSocket *tcpSocket = new QTcpSocket( this );
+    tcpSocket->connectToHost( host, port );
+
+    m_connection = new Network::Connection( tcpSocket );
+    connect( m_connection, SIGNAL( dataReceived( BotRace::Network::DataType_T, QByteArray ) ),
+             this, SLOT( onDataReceived( BotRace::Network::DataType_T, QByteArray ) ) );
+    connect( m_connection, SIGNAL( disconnected() ), this, SLOT( onDisconnected() ) );
+}
+
+bool LoadClient::isConnected() const
+{
+    return m_handshakeDone;
+}
+
+void LoadClient::onDataReceived( BotRace::Network::DataType_T dataType, QByteArray data )
+{
+    // any message of the server after our acknowledgement means the barrier is released
+    if( m_waitForBarrier && dataType != Network::DATA_LOG_AND_CHAT_ENTRY ) {
+        m_waitForBarrier = false;
+        emit barrierFinished( m_barrierTimer.elapsed() );
+    }
+
+    switch( dataType ) {
+    case Network::HANDSHAKE: {
+        QUuid uuid;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> uuid;
+
+        m_connection->setUid( uuid );
+
+        QByteArray answer;
+        QDataStream outstream( &answer, QIODevice::WriteOnly );
+        outstream << m_name << QUuid() << false << Network::PROTOCOL_VERSION;
+
+        m_connection->sendData( Network::HANDSHAKE, answer );
+
+        m_handshakeDone = true;
+        emit connected();
+        break;
+    }
+    case Network::DATA_SELECT_STARTPOINT: {
+        QList<QPoint> allowedStartingPoints;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> allowedStartingPoints;
+
+        if( allowedStartingPoints.isEmpty() ) {
+            break;
+        }
+
+        QByteArray answer;
+        QDataStream outstream( &answer, QIODevice::WriteOnly );
+        outstream << allowedStartingPoints.at( qrand() % allowedStartingPoints.size() );
+
+        m_connection->sendData( Network::DATA_SELECTED_STARTING_POINT, answer );
+        break;
+    }
+    case Network::DATA_SELECT_STARTORIENTATION: {
+        QList<quint16> orientations;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> orientations;
+
+        if( orientations.isEmpty() ) {
+            break;
+        }
+
+        QByteArray answer;
+        QDataStream outstream( &answer, QIODevice::WriteOnly );
+        outstream << orientations.at( qrand() % orientations.size() );
+
+        m_connection->sendData( Network::DATA_SELECTED_STARTING_ORIENTATION, answer );
+        break;
+    }
+    case Network::SIGNAL_CLEAR_DECK:
+        m_deck->clearCards();
+        break;
+    case Network::DATA_REMOVE_PROGRAM_CARD: {
+        ushort slotnr;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> slotnr;
+
+        m_deck->removeCardFromProgram( slotnr );
+        break;
+    }
+    case Network::DATA_DECK_CARD_RECEIVED: {
+        ushort slot;
+        ushort type;
+        Core::GameCard_T newCard;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> slot;
+        instream >> type;
+        newCard.type = ( Core::CardType )type;
+        instream >> newCard.priority;
+
+        m_deck->addCardToDeck( newCard );
+        break;
+    }
+    case Network::DATA_PROGRAM_CARD_RECEIVED: {
+        ushort slot;
+        ushort type;
+        Core::GameCard_T newCard;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> slot;
+        instream >> type;
+        newCard.type = ( Core::CardType )type;
+        instream >> newCard.priority;
+
+        m_deck->addCardToLockedProgram( newCard );
+        break;
+    }
+    case Network::DATA_LOCKED_SLOT: {
+        ushort slotnr;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> slotnr;
+
+        m_deck->lockProgramSlot( slotnr );
+        break;
+    }
+    case Network::SIGNAL_START_PROGRAMMING:
+        if( m_waitForRound ) {
+            m_waitForRound = false;
+            emit roundFinished( m_roundTimer.elapsed() );
+        }
+        sendRandomProgram();
+        break;
+    case Network::DATA_ANIMATION_BARRIER: {
+        QDataStream instream( &data, QIODevice::ReadOnly );
+        instream >> m_animationBarrier;
+        break;
+    }
+    case Network::SIGNAL_ANIMATE_ROBOTS:
+    case Network::DATA_ANIMATE_ROBOTS_LIST:
+    case Network::DATA_ANIMATE_ELEMENTS:
+        scheduleAnimationFinished();
+        break;
+    case Network::DATA_PROTOCOL_MISMATCH:
+        qWarning() << "LoadClient::onDataReceived ||" << m_name << "refused, the server uses another protocol version";
+        break;
+    default:
+        // everything else is only of interest for a real gui
+        break;
+    }
+}
+
+void LoadClient::onDisconnected()
+{
+    m_handshakeDone = false;
+    emit disconnected();
+}
+
+void LoadClient::scheduleAnimationFinished()
+{
+    // one game state sends several animation requests (board elements + robots)
+    // the real client also answers them with one finished signal after all animations are done
+    if( m_animationPending ) {
+        return;
+    }
+
+    m_animationPending = true;
+    m_pendingBarrier = m_animationBarrier;
+    QTimer::singleShot( m_animationDelay, this, SLOT( sendAnimationFinished() ) );
+}
+
+void LoadClient::sendAnimationFinished()
+{
+    m_animationPending = false;
+
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+    outstream << m_pendingBarrier;
+
+    m_connection->sendData( Network::DATA_ANIMATION_FINISHED, data );
+
+    m_waitForBarrier = true;
+    m_barrierTimer.start();
+}
+
+void LoadClient::sendRandomProgram()
+{
+    QList<ushort> deckSlots;
+    for( ushort slot = 1; slot <= MAX_DECK_SIZE; slot++ ) {
+        if( m_deck->getCardFromDeck( slot ).type != Core::CARD_EMPTY ) {
+            deckSlots.insert( qrand() % ( deckSlots.size() + 1 ), slot );
+        }
+    }
+
+    for( ushort slot = 1; slot <= MAX_PROGRAM_SIZE && !deckSlots.isEmpty(); slot++ ) {
+        if( m_deck->isProgramSlotLocked( slot ) ||
+            m_deck->getCardFromProgram( slot ).type != Core::CARD_EMPTY ) {
+            continue;
+        }
+
+        m_deck->moveCardToProgram( deckSlots.takeFirst(), slot );
+    }
+
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+    outstream << m_deck->allCardsFromProgram();
+
+    m_connection->sendData( Network::DATA_SEND_PROGRAM_LIST, data );
+
+    m_waitForRound = true;
+    m_roundTimer.start();
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LOADCLIENT_H
+#define LOADCLIENT_H
+
+#include <QObject>
+#include <QTime>
+#include <QPoint>
+
+#include "network/connection.h"
+
+class QTcpSocket;
+
+namespace BotRace {
+namespace Core {
+    class CardDeck;
+}
+
+namespace LoadTest {
+
+/**
+ * @brief A scripted network player used to put load on the botrace-server
+ *
+ * The LoadClient talks the same protocol as the NetworkClient, but without any gui.
+ * It answers every request of the server automatically:
+ * @li HANDSHAKE with a generated name
+ * @li DATA_SELECT_STARTPOINT / DATA_SELECT_STARTORIENTATION with a random allowed value
+ * @li SIGNAL_START_PROGRAMMING with a random legal program from the dealt cards
+ * @li all animation requests with DATA_ANIMATION_FINISHED and the id of the last DATA_ANIMATION_BARRIER, optionally after an artificial delay
+ *
+ * The time the server needs for a complete round and for each animation barrier is reported
+ * via the roundFinished() and barrierFinished() signals.
+ */
+class LoadClient : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Creates a new scripted client
+     *
+     * @param name the player name send in the handshake
+     * @param animationDelay time in ms before an animation is acknowledged (0 = immediately)
+     * @param parent the parent object
+     */
+    LoadClient( const QString &name, int animationDelay, QObject *parent = 0 );
+    ~LoadClient();
+
+    /**
+     * @brief Opens the connection to the server
+     *
+     * @param host the server address
+     * @param port the server port
+     */
+    void connectToServer( const QString &host, quint16 port );
+
+    /**
+     * @brief Returns @c true after the server accepted the handshake
+     */
+    bool isConnected() const;
+
+signals:
+    /**
+     * @brief Emitted when the server asks for the next program
+     *
+     * @param msec time between sending the last program and receiving the next programming request
+     */
+    void roundFinished( int msec );
+
+    /**
+     * @brief Emitted when the server continues the game after an acknowledged animation
+     *
+     * @param msec time between sending DATA_ANIMATION_FINISHED and the next message of the server
+     */
+    void barrierFinished( int msec );
+
+    void connected();
+    void disconnected();
+
+private slots:
+    void onDataReceived( BotRace::Network::DataType_T dataType, QByteArray data );
+    void onDisconnected();
+
+    /**
+     * @brief Sends the DATA_ANIMATION_FINISHED for all animations received so far
+     */
+    void sendAnimationFinished();
+
+private:
+    /**
+     * @brief Fills all free program slots with random cards and sends the program
+     */
+    void sendRandomProgram();
+
+    /**
+     * @brief Collects the animation requests of one game state into a single acknowledgement
+     */
+    void scheduleAnimationFinished();
+
+    QString m_name;
+    int m_animationDelay;
+    Network::Connection *m_connection;
+    Core::CardDeck *m_deck;
+    bool m_handshakeDone;
+    bool m_animationPending;  /**< An acknowledgement is already scheduled */
+    quint32 m_animationBarrier;   /**< Id of the last animation barrier received from the server */
+    quint32 m_pendingBarrier;     /**< Id of the barrier the scheduled acknowledgement belongs to */
+    bool m_waitForBarrier;    /**< An acknowledgement was send and the answer of the server is measured */
+    bool m_waitForRound;      /**< A program was send and the next programming request is measured */
+    QTime m_barrierTimer;
+    QTime m_roundTimer;
+};
+
+}
+}
+
+#endif // LOADCLIENT_H
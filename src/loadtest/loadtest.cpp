@@ -0,0 +1,225 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "loadtest.h"
+#include "loadclient.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+using namespace BotRace;
+using namespace LoadTest;
+
+LoadTest::LoadTest( const LoadTestSettings_T &settings, QObject *parent ) :
+    QObject( parent ),
+    m_settings( settings ),
+    m_connectTimer( new QTimer( this ) ),
+    m_reportTimer( new QTimer( this ) ),
+    m_connectedClients( 0 ),
+    m_lastCpuTime( -1 )
+{
+    connect( m_connectTimer, SIGNAL( timeout() ), this, SLOT( connectNextClient() ) );
+    connect( m_reportTimer, SIGNAL( timeout() ), this, SLOT( report() ) );
+}
+
+LoadTest::~LoadTest()
+{
+    qDeleteAll( m_clients );
+}
+
+void LoadTest::start()
+{
+    qDebug() << "LoadTest::start || connect" << m_settings.clients << "clients to"
+             << m_settings.host << m_settings.port << "animation delay" << m_settings.animationDelay << "ms";
+
+    if( m_settings.clients > TABLE_CAPACITY ) {
+        qWarning() << "LoadTest::start || only" << TABLE_CAPACITY << "clients can play, the other"
+                   << m_settings.clients - TABLE_CAPACITY << "only load the lobby broadcast";
+    }
+
+    m_runTime.start();
+    m_reportTime.start();
+
+    m_connectTimer->start( m_settings.connectInterval );
+    m_reportTimer->start( m_settings.reportInterval * 1000 );
+
+    if( m_settings.duration > 0 ) {
+        QTimer::singleShot( m_settings.duration * 1000, this, SLOT( finish() ) );
+    }
+}
+
+void LoadTest::connectNextClient()
+{
+    if( m_clients.size() >= m_settings.clients ) {
+        m_connectTimer->stop();
+        return;
+    }
+
+    LoadClient *client = new LoadClient( QString( "LoadBot %1" ).arg( m_clients.size() + 1 ),
+                                         m_settings.animationDelay );
+
+    connect( client, SIGNAL( roundFinished( int ) ), this, SLOT( addRoundLatency( int ) ) );
+    connect( client, SIGNAL( barrierFinished( int ) ), this, SLOT( addBarrierLatency( int ) ) );
+    connect( client, SIGNAL( connected() ), this, SLOT( clientConnected() ) );
+    connect( client, SIGNAL( disconnected() ), this, SLOT( clientDisconnected() ) );
+
+    m_clients.append( client );
+    client->connectToServer( m_settings.host, m_settings.port );
+}
+
+void LoadTest::addRoundLatency( int msec )
+{
+    m_roundLatency.append( msec );
+}
+
+void LoadTest::addBarrierLatency( int msec )
+{
+    m_barrierLatency.append( msec );
+}
+
+void LoadTest::clientConnected()
+{
+    m_connectedClients++;
+}
+
+void LoadTest::clientDisconnected()
+{
+    m_connectedClients--;
+}
+
+void LoadTest::report()
+{
+    QTextStream out( stdout );
+
+    out << QString( "[%1s] clients %2/%3 | rounds %4 | barriers %5" )
+        .arg( m_runTime.elapsed() / 1000, 5 )
+        .arg( m_connectedClients )
+        .arg( m_settings.clients )
+        .arg( formatSamples( m_roundLatency ) )
+        .arg( formatSamples( m_barrierLatency ) );
+
+    // the rounds and barriers are measured by the players only
+    if( m_connectedClients > TABLE_CAPACITY ) {
+        out << QString( " | lobby only %1" ).arg( m_connectedClients - TABLE_CAPACITY );
+    }
+
+    qint64 cpuTime;
+    qint64 rssKb;
+    if( m_settings.serverPid > 0 && readServerUsage( cpuTime, rssKb ) ) {
+        int elapsed = m_reportTime.elapsed();
+        if( m_lastCpuTime >= 0 && elapsed > 0 ) {
+            out << QString( " | server cpu %1% rss %2 kB" )
+                .arg( 100.0 * ( cpuTime - m_lastCpuTime ) / elapsed, 0, 'f', 1 )
+                .arg( rssKb );
+        }
+        else {
+            out << QString( " | server rss %1 kB" ).arg( rssKb );
+        }
+        m_lastCpuTime = cpuTime;
+    }
+    else if( m_settings.serverPid > 0 ) {
+        out << QLatin1String( " | server cpu n/a rss n/a" );
+    }
+
+    out << endl;
+
+    m_roundLatency.clear();
+    m_barrierLatency.clear();
+    m_reportTime.restart();
+}
+
+void LoadTest::finish()
+{
+    report();
+    QCoreApplication::quit();
+}
+
+int LoadTest::percentile( const QVector<int> &samples, int p )
+{
+    if( samples.isEmpty() ) {
+        return 0;
+    }
+
+    int index = ( samples.size() - 1 ) * p / 100;
+    return samples.at( index );
+}
+
+QString LoadTest::formatSamples( QVector<int> samples )
+{
+    if( samples.isEmpty() ) {
+        return QLatin1String( "-" );
+    }
+
+    qSort( samples );
+
+    return QString( "n=%1 p50=%2 p90=%3 p99=%4 max=%5 ms" )
+           .arg( samples.size() )
+           .arg( percentile( samples, 50 ) )
+           .arg( percentile( samples, 90 ) )
+           .arg( percentile( samples, 99 ) )
+           .arg( samples.last() );
+}
+
+bool LoadTest::readServerUsage( qint64 &cpuTime, qint64 &rssKb ) const
+{
+#ifdef Q_OS_LINUX
+    QFile statFile( QString( "/proc/%1/stat" ).arg( m_settings.serverPid ) );
+    if( !statFile.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    // the process name can contain spaces, so start parsing after the closing bracket
+    QString stat = QString::fromLatin1( statFile.readAll() );
+    QStringList fields = stat.mid( stat.lastIndexOf( ')' ) + 2 ).split( ' ' );
+    if( fields.size() < 13 ) {
+        return false;
+    }
+
+    // utime and stime are field 14 and 15 in clock ticks
+    qint64 ticks = fields.at( 11 ).toLongLong() + fields.at( 12 ).toLongLong();
+    cpuTime = ticks * 1000 / sysconf( _SC_CLK_TCK );
+
+    QFile statusFile( QString( "/proc/%1/status" ).arg( m_settings.serverPid ) );
+    if( !statusFile.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    rssKb = 0;
+    foreach( const QByteArray & line, statusFile.readAll().split( '\n' ) ) {
+        if( line.startsWith( "VmRSS:" ) ) {
+            rssKb = line.mid( 6 ).trimmed().split( ' ' ).first().toLongLong();
+            break;
+        }
+    }
+
+    return true;
+#else
+    Q_UNUSED( cpuTime );
+    Q_UNUSED( rssKb );
+    return false;
+#endif
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LOADTEST_H
+#define LOADTEST_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QTime>
+
+class QTimer;
+
+namespace BotRace {
+namespace LoadTest {
+class LoadClient;
+
+/**
+ * @brief Players of the one game table of the server, all other clients stay in the lobby
+ */
+const int TABLE_CAPACITY = 8;
+
+/**
+ * @brief Settings for one load test run
+ */
+struct LoadTestSettings_T {
+    QString host;        /**< Server address, only local connections are allowed */
+    quint16 port;        /**< Server port */
+    int clients;         /**< Number of scripted clients */
+    int animationDelay;  /**< Delay in ms before a client acknowledges an animation */
+    int connectInterval; /**< Delay in ms between two connection attempts */
+    int duration;        /**< Runtime in seconds, 0 runs until the process is stopped */
+    int reportInterval;  /**< Time in seconds between two reports */
+    qint64 serverPid;    /**< Process id of the server used for the cpu/memory report, 0 to disable */
+};
+
+/**
+ * @brief Drives a number of LoadClient against a running botrace-server
+ *
+ * The clients are connected one after another. In a fixed interval the latency of the
+ * finished game rounds and animation barriers are printed as percentiles together
+ * with the cpu time and memory usage of the server process.
+ *
+ * The cpu/memory values are read from /proc and are only available on linux, elsewhere
+ * they are reported as n/a.
+ *
+ * The server plays one table with at most TABLE_CAPACITY players. The round and barrier
+ * latencies come from these players only, all further clients just receive the lobby
+ * broadcast and are listed as "lobby only" in the report.
+ */
+class LoadTest : public QObject {
+    Q_OBJECT
+public:
+    explicit LoadTest( const LoadTestSettings_T &settings, QObject *parent = 0 );
+    ~LoadTest();
+
+public slots:
+    /**
+     * @brief Starts to connect the clients and the report timer
+     */
+    void start();
+
+private slots:
+    void connectNextClient();
+    void addRoundLatency( int msec );
+    void addBarrierLatency( int msec );
+    void clientConnected();
+    void clientDisconnected();
+
+    /**
+     * @brief Prints the statistic since the last report and clears the collected samples
+     */
+    void report();
+
+    void finish();
+
+private:
+    /**
+     * @brief Returns the value at percentile @p p from the sorted @p samples
+     */
+    static int percentile( const QVector<int> &samples, int p );
+
+    /**
+     * @brief Formats count, p50, p90, p99 and max of @p samples for the report
+     */
+    static QString formatSamples( QVector<int> samples );
+
+    /**
+     * @brief Reads the used cpu time in ms and the resident memory in kB of the server process
+     *
+     * @return @c false if the values could not be read or the platform is not linux
+     */
+    bool readServerUsage( qint64 &cpuTime, qint64 &rssKb ) const;
+
+    LoadTestSettings_T m_settings;
+    QList<LoadClient *> m_clients;
+    QTimer *m_connectTimer;
+    QTimer *m_reportTimer;
+    QVector<int> m_roundLatency;
+    QVector<int> m_barrierLatency;
+    int m_connectedClients;
+    QTime m_runTime;
+    QTime m_reportTime;
+    qint64 m_lastCpuTime;
+};
+
+}
+}
+
+#endif // LOADTEST_H
@@ -0,0 +1,49 @@
+#-------------------------------------------------
+#
+# Headless load generator for the botrace-server
+#
+#-------------------------------------------------
+
+include (../../config.pri)
+
+QT       += core network xml svg gui
+CONFIG   += console
+
+TARGET = botrace-loadtest
+TEMPLATE = app
+CONFIG += thread
+
+# define prefix for installation
+unix {
+    target.path = $${PREFIX}/bin
+}
+win32 {
+    target.path = $${PREFIX}
+}
+
+INSTALLS += target
+
+message("------------------------------------------------------------------------")
+message(Install botrace-loadtest into: $$target.path)
+message("------------------------------------------------------------------------")
+
+HEADERS += \
+    loadclient.h \
+    loadtest.h
+
+SOURCES += \
+    main.cpp \
+    loadclient.cpp \
+    loadtest.cpp
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../core/release/ -lbotrace-core
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../core/debug/ -lbotrace-core
+else:symbian: LIBS += -lbotrace-core
+else:unix: LIBS += -L$$OUT_PWD/../core/ -lbotrace-core
+
+INCLUDEPATH += $$PWD/../core
+DEPENDPATH += $$PWD/../core
+
+win32:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/libbotrace-core.a
+else:win32:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/libbotrace-core.a
+else:unix:!symbian: PRE_TARGETDEPS += $$OUT_PWD/../core/libbotrace-core.a
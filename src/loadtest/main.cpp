@@ -0,0 +1,114 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QHostAddress>
+#include <QTimer>
+#include <QTime>
+#include <QDebug>
+
+#include "loadtest.h"
+
+static void printUsage()
+{
+    qWarning( "Usage: botrace-loadtest [options]\n"
+              "  --host <address>      server address, must be a local address (default 127.0.0.1)\n"
+              "  --port <port>         server port (default 2323)\n"
+              "  --clients <n>         number of scripted clients, only 8 of them play (default 100)\n"
+              "  --delay <ms>          delay before an animation is acknowledged (default 0)\n"
+              "  --connect-interval <ms> delay between two new connections (default 20)\n"
+              "  --duration <s>        stop after n seconds, 0 runs forever (default 0)\n"
+              "  --interval <s>        report interval (default 5)\n"
+              "  --server-pid <pid>    report cpu and memory usage of this process (linux only)" );
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication a( argc, argv );
+
+    BotRace::LoadTest::LoadTestSettings_T settings;
+    settings.host = QLatin1String( "127.0.0.1" );
+    settings.port = 2323;
+    settings.clients = 100;
+    settings.animationDelay = 0;
+    settings.connectInterval = 20;
+    settings.duration = 0;
+    settings.reportInterval = 5;
+    settings.serverPid = 0;
+
+    QStringList args = a.arguments();
+    for( int i = 1; i < args.size(); i++ ) {
+        QString option = args.at( i );
+        if( option == QLatin1String( "--help" ) ) {
+            printUsage();
+            return 0;
+        }
+
+        if( i + 1 >= args.size() ) {
+            printUsage();
+            return 1;
+        }
+
+        QString value = args.at( ++i );
+        if( option == QLatin1String( "--host" ) ) {
+            settings.host = value;
+        }
+        else if( option == QLatin1String( "--port" ) ) {
+            settings.port = value.toUShort();
+        }
+        else if( option == QLatin1String( "--clients" ) ) {
+            settings.clients = value.toInt();
+        }
+        else if( option == QLatin1String( "--delay" ) ) {
+            settings.animationDelay = value.toInt();
+        }
+        else if( option == QLatin1String( "--connect-interval" ) ) {
+            settings.connectInterval = value.toInt();
+        }
+        else if( option == QLatin1String( "--duration" ) ) {
+            settings.duration = value.toInt();
+        }
+        else if( option == QLatin1String( "--interval" ) ) {
+            settings.reportInterval = qMax( 1, value.toInt() );
+        }
+        else if( option == QLatin1String( "--server-pid" ) ) {
+            settings.serverPid = value.toLongLong();
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // the load generator is meant to test a local server only
+    QHostAddress address( settings.host );
+    if( settings.host != QLatin1String( "localhost" ) &&
+        address != QHostAddress( QHostAddress::LocalHost ) &&
+        address != QHostAddress( QHostAddress::LocalHostIPv6 ) ) {
+        qCritical() << "botrace-loadtest only connects to localhost, refused:" << settings.host;
+        return 1;
+    }
+
+    qsrand( QTime::currentTime().msec() );
+
+    BotRace::LoadTest::LoadTest loadTest( settings );
+    QTimer::singleShot( 0, &loadTest, SLOT( start() ) );
+
+    return a.exec();
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gametable.h"
+
+#include "serverclient.h"
+#include "serverbroadcast.h"
+#include "network/connection.h"
+
+#include "engine/participant.h"
+#include "engine/gamelogandchat.h"
+#include "engine/gameengine.h"
+
+#include <QThread>
+#include <QMetaType>
+
+#include <QDebug>
+
+using namespace BotRace;
+using namespace Network;
+
+GameTable::GameTable( Core::GameLogAndChat *logAndChat, ServerBroadcast *lobbyBroadcast, int reconnectGraceTime ) :
+    QObject( 0 ),
+    m_lobbyThread( thread() ),
+    m_logAndChat( logAndChat ),
+    m_lobbyBroadcast( lobbyBroadcast ),
+    m_broadcast( 0 ),
+    m_gameEngine( 0 ),
+    m_gameRunning( false ),
+    m_reconnectGraceTime( reconnectGraceTime )
+{
+    // arguments of the queued calls between the lobby and the table thread
+    qRegisterMetaType<BotRace::Network::ServerClient *> ( "BotRace::Network::ServerClient*" );
+    qRegisterMetaType<BotRace::Network::Connection *> ( "BotRace::Network::Connection*" );
+    qRegisterMetaType<BotRace::Core::GameSettings_T> ( "BotRace::Core::GameSettings_T" );
+    qRegisterMetaType<QUuid> ( "QUuid" );
+}
+
+void GameTable::addClient( BotRace::Network::ServerClient *client )
+{
+    m_clients.append( client );
+    connect( client, SIGNAL( graceTimeExpired( BotRace::Network::ServerClient * ) ), this, SLOT( dropClient( BotRace::Network::ServerClient * ) ) );
+}
+
+void GameTable::addSpectator( BotRace::Network::ServerClient *spectator )
+{
+    m_spectators.append( spectator );
+
+    if( m_gameRunning ) {
+        watchGame( spectator );
+        m_broadcast->sendSpectatorSnapshot( spectator->getConnection() );
+        spectator->getConnection()->sendSignal( SIGNAL_GAME_STARTED );
+    }
+}
+
+void GameTable::removeSpectator( BotRace::Network::ServerClient *spectator )
+{
+    m_spectators.removeOne( spectator );
+    if( m_broadcast ) {
+        m_broadcast->removeConnection( spectator->getConnection() );
+    }
+
+    spectator->deleteLater();
+}
+
+void GameTable::startGame( BotRace::Core::GameSettings_T settings )
+{
+    qDebug() << "GameTable::startGame || running in thread" << QThread::currentThread();
+
+    m_gameEngine = new Core::GameEngine( m_logAndChat );
+    m_gameEngine->setParent( this );
+    m_gameEngine->setUpGame( settings );
+
+    connect( m_gameEngine, SIGNAL( gameOver( BotRace::Core::Participant * ) ), this, SLOT( gameOver( BotRace::Core::Participant * ) ) );
+
+    // the lobby broadcast already sends the log entries to all clients
+    m_broadcast = new ServerBroadcast( this );
+    m_broadcast->setLogAndChat( m_logAndChat, false );
+    m_broadcast->setGameEngine( m_gameEngine );
+
+    //now add all players to the game
+    foreach( ServerClient * participant, m_clients ) {
+        participant->setBroadcast( m_broadcast );
+        m_broadcast->addGameConnection( participant->getConnection() );
+        m_gameEngine->joinGame( participant );
+
+        // send the used scenario xml to the player
+        participant->setGameEngine( m_gameEngine );
+        participant->sendScenarioChanges();
+    }
+
+    // spectators don't get the participants from a ServerClient
+    // and need them before the game starts
+    foreach( ServerClient * spectator, m_spectators ) {
+        watchGame( spectator );
+    }
+    m_broadcast->sendSnapshotToSpectators();
+
+    m_gameRunning = true;
+    if( m_gameEngine->start() ) {
+        emit gameStarted();
+    }
+    else {
+        finishGame();
+    }
+}
+
+void GameTable::stopGame()
+{
+    if( !m_gameRunning ) {
+        return;
+    }
+
+    m_gameEngine->stop();
+    finishGame();
+}
+
+void GameTable::clientDisconnected( BotRace::Network::ServerClient *client )
+{
+    // the game ended meanwhile, the lobby removes the client
+    if( !m_gameRunning || !m_clients.contains( client ) ) {
+        return;
+    }
+
+    m_broadcast->removeConnection( client->getConnection() );
+
+    if( m_reconnectGraceTime > 0 ) {
+        client->suspend( m_reconnectGraceTime );
+        m_logAndChat->addEntry( Core::GAMEINFO_PARTICIPANT_NEGATIVE, tr( "%1 lost the connection" ).arg( client->getName() ) );
+    }
+    else {
+        dropClient( client );
+    }
+}
+
+void GameTable::resumeClient( BotRace::Network::Connection *connection, QUuid sessionToken )
+{
+    ServerClient *suspendedClient = 0;
+    if( m_gameRunning ) {
+        foreach( ServerClient * ac, m_clients ) {
+            if( ac->isSuspended() && ac->getSessionToken() == sessionToken ) {
+                suspendedClient = ac;
+                break;
+            }
+        }
+    }
+
+    // the game is over or the grace time expired, join as new client
+    if( !suspendedClient ) {
+        connection->moveToThread( m_lobbyThread );
+        emit resumeFailed( connection );
+        return;
+    }
+
+    suspendedClient->resume( connection );
+    connection->resumeReading();
+    m_broadcast->addGameConnection( connection );
+
+    suspendedClient->sendSettingsChanged( m_gameEngine->getGameSettings() );
+    suspendedClient->sendScenarioChanges();
+    suspendedClient->sendGameSnapshot();
+
+    emit clientResumed( suspendedClient );
+}
+
+void GameTable::gameOver( BotRace::Core::Participant *p )
+{
+    foreach( ServerClient * spectator, m_spectators ) {
+        spectator->gameOver( p );
+    }
+
+    finishGame();
+}
+
+void GameTable::dropClient( BotRace::Network::ServerClient *client )
+{
+    m_clients.removeOne( client );
+    m_broadcast->removeConnection( client->getConnection() );
+
+    // the engine deletes the client once the lobby acknowledged it with clientForgotten()
+    m_droppedClients.append( client );
+    emit clientDropped( client );
+}
+
+void GameTable::clientForgotten( BotRace::Network::ServerClient *client )
+{
+    if( !m_droppedClients.removeOne( client ) ) {
+        qWarning() << "GameTable::clientForgotten || client was not dropped by this table";
+        return;
+    }
+
+    // deletes the client and lets a bot take over its robot
+    m_gameEngine->clientLeft( client->getUuid() );
+
+    // the last acknowledgement of a finished game
+    if( !m_gameRunning && m_droppedClients.isEmpty() ) {
+        emit gameFinished();
+    }
+}
+
+void GameTable::watchGame( ServerClient *spectator )
+{
+    spectator->setBroadcast( m_broadcast );
+    spectator->setGameEngine( m_gameEngine );
+    m_broadcast->addSpectatorConnection( spectator->getConnection() );
+    spectator->sendScenarioChanges();
+}
+
+void GameTable::finishGame()
+{
+    if( !m_gameRunning ) {
+        return;
+    }
+    m_gameRunning = false;
+
+    foreach( ServerClient * client, m_clients ) {
+        if( client->isSuspended() ) {
+            dropClient( client );
+        }
+    }
+
+    m_broadcast->setGameEngine( 0 );
+
+    // from now on the clients are used by the lobby again
+    QList<ServerClient *> clients = m_clients + m_spectators;
+    foreach( ServerClient * client, clients ) {
+        disconnect( client, 0, this, 0 );
+        client->setBroadcast( m_lobbyBroadcast );
+        client->changeThread( m_lobbyThread );
+    }
+    m_clients.clear();
+    m_spectators.clear();
+
+    // otherwise the last clientForgotten() finishes the game
+    if( m_droppedClients.isEmpty() ) {
+        emit gameFinished();
+    }
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GAMETABLE_H
+#define GAMETABLE_H
+
+#include <QObject>
+#include <QList>
+#include <QUuid>
+
+#include "engine/gamesettings.h"
+
+class QThread;
+
+namespace BotRace {
+namespace Core {
+    class Participant;
+    class GameEngine;
+    class GameLogAndChat;
+}
+
+namespace Network {
+    class Connection;
+    class ServerClient;
+    class ServerBroadcast;
+
+/**
+ * @brief The GameTable runs one game with its own event loop in its own thread
+ *
+ * The table owns the GameEngine of the game and a ServerBroadcast for the game events. When the game
+ * starts, the Server moves all players and spectators together with their Connection and socket to
+ * the thread of the table. Until the game is over they are only used in this thread, so a slow bot
+ * decision or a long animation barrier does not stall the lobby or the accept loop.
+ *
+ * The Server talks to the table only with queued calls of its slots, the table answers with signals.
+ * Lobby messages send to the clients of the table from the Server thread are passed to the thread of
+ * the Connection, see Connection::sendPacket().
+ *
+ * When the game is over, the table drops all suspended clients, moves the others back to the thread
+ * it was created in and emits gameFinished().
+ */
+class GameTable : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Creates the table in the lobby thread, move it to its own thread afterwards
+     *
+     * @param logAndChat the log shared with the lobby
+     * @param lobbyBroadcast the broadcast the clients get back when the game is over
+     * @param reconnectGraceTime seconds a client can rejoin the running game after a disconnect
+     */
+    GameTable( Core::GameLogAndChat *logAndChat, ServerBroadcast *lobbyBroadcast, int reconnectGraceTime );
+
+public slots:
+    /**
+     * @brief Adds a player for the next game
+     *
+     * @param client the ServerClient, already moved to the thread of the table
+     */
+    void addClient( BotRace::Network::ServerClient *client );
+
+    /**
+     * @brief Adds a spectator, who gets a snapshot at once if the game is running already
+     *
+     * @param spectator the ServerClient, already moved to the thread of the table
+     */
+    void addSpectator( BotRace::Network::ServerClient *spectator );
+
+    /**
+     * @brief Removes a spectator that lost its connection and deletes it
+     */
+    void removeSpectator( BotRace::Network::ServerClient *spectator );
+
+    /**
+     * @brief Creates the GameEngine, lets all added clients join and starts the game
+     *
+     * @param settings the game settings selected in the lobby
+     */
+    void startGame( BotRace::Core::GameSettings_T settings );
+
+    /**
+     * @brief Stops the running game by request of the admin
+     */
+    void stopGame();
+
+    /**
+     * @brief Keeps the place of a player that lost its connection
+     *
+     * The client is suspended for the reconnect grace time or replaced by a bot at once.
+     * @param client the ServerClient of the lost connection
+     */
+    void clientDisconnected( BotRace::Network::ServerClient *client );
+
+    /**
+     * @brief Continues the game of the suspended client with the same session token
+     *
+     * If no client waits for the token, the connection is moved back to the lobby thread
+     * and resumeFailed() is emitted. The connection is paused by the lobby and resumed by
+     * the client that takes it over.
+     *
+     * @param connection the new connection, already moved to the thread of the table
+     * @param sessionToken the token the client received with its first handshake
+     */
+    void resumeClient( BotRace::Network::Connection *connection, QUuid sessionToken );
+
+    /**
+     * @brief The lobby removed the dropped client, the GameEngine can delete it now
+     *
+     * Invoke queued from the lobby thread as answer to clientDropped().
+     *
+     * @param client the ServerClient passed with clientDropped()
+     */
+    void clientForgotten( BotRace::Network::ServerClient *client );
+
+signals:
+    /**
+     * @brief The GameEngine started the game
+     */
+    void gameStarted();
+
+    /**
+     * @brief The game is over or stopped, all remaining clients are back in the lobby thread
+     *
+     * Emitted only after the lobby acknowledged all dropped clients, the table does not
+     * wait for the lobby anymore afterwards.
+     */
+    void gameFinished();
+
+    /**
+     * @brief The client left the game for good, the GameEngine deletes it afterwards
+     *
+     * The lobby must answer with clientForgotten() once it does not use the client anymore.
+     */
+    void clientDropped( BotRace::Network::ServerClient *client );
+
+    /**
+     * @brief The suspended client continues the game with a new connection
+     */
+    void clientResumed( BotRace::Network::ServerClient *client );
+
+    /**
+     * @brief No client waits for the session token, the connection should join as new client
+     *
+     * @param connection the connection, already moved back to the lobby thread
+     */
+    void resumeFailed( BotRace::Network::Connection *connection );
+
+private slots:
+    /**
+     * @brief Called by the GameEngine when the game is won or all robots are dead
+     */
+    void gameOver( BotRace::Core::Participant *p );
+
+    /**
+     * @brief Removes the client from the game and lets a bot take over its robot
+     */
+    void dropClient( BotRace::Network::ServerClient *client );
+
+private:
+    /**
+     * @brief Sends the scenario to the spectator and adds it to the game broadcast
+     */
+    void watchGame( ServerClient *spectator );
+
+    /**
+     * @brief Drops the suspended clients and hands all others back to the lobby thread
+     */
+    void finishGame();
+
+    QThread *m_lobbyThread;                 /**< Thread the clients are moved back to after the game */
+    Core::GameLogAndChat *m_logAndChat;     /**< Log shared with the lobby */
+    ServerBroadcast *m_lobbyBroadcast;      /**< Broadcast of the lobby, used by the clients after the game */
+    ServerBroadcast *m_broadcast;           /**< Broadcast for the events of this game */
+    Core::GameEngine *m_gameEngine;         /**< Engine of the game, deleted with the table */
+    bool m_gameRunning;
+    int m_reconnectGraceTime;               /**< Seconds a client can rejoin the running game after a disconnect */
+
+    QList<ServerClient *> m_clients;        /**< Players of this table */
+    QList<ServerClient *> m_spectators;     /**< Spectators of this table */
+    QList<ServerClient *> m_droppedClients; /**< Dropped clients the lobby did not acknowledge yet */
+};
+
+}
+}
+
+#endif // GAMETABLE_H
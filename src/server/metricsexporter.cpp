@@ -0,0 +1,94 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metricsexporter.h"
+
+#include "engine/runtimemetrics.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QFile>
+
+#include <QDebug>
+
+using namespace BotRace;
+using namespace Network;
+
+MetricsExporter::MetricsExporter( QObject *parent ) :
+    QObject( parent ),
+    m_adminServer( 0 ),
+    m_dumpTimer( 0 )
+{
+}
+
+bool MetricsExporter::listen( quint16 port )
+{
+    if( !m_adminServer ) {
+        m_adminServer = new QTcpServer( this );
+        connect( m_adminServer, SIGNAL( newConnection() ), this, SLOT( sendMetrics() ) );
+    }
+
+    // the metrics are meant for a collector on the same machine only
+    if( !m_adminServer->listen( QHostAddress::LocalHost, port ) ) {
+        qWarning() << "MetricsExporter::listen || unable to open the admin socket:" << m_adminServer->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void MetricsExporter::setDumpFile( const QString &fileName, int interval )
+{
+    m_dumpFile = fileName;
+
+    if( !m_dumpTimer ) {
+        m_dumpTimer = new QTimer( this );
+        connect( m_dumpTimer, SIGNAL( timeout() ), this, SLOT( writeDumpFile() ) );
+    }
+
+    m_dumpTimer->start( qMax( interval, 1 ) * 1000 );
+}
+
+void MetricsExporter::sendMetrics()
+{
+    while( m_adminServer->hasPendingConnections() ) {
+        QTcpSocket *socket = m_adminServer->nextPendingConnection();
+        connect( socket, SIGNAL( disconnected() ), socket, SLOT( deleteLater() ) );
+
+        socket->write( Core::RuntimeMetrics::dump().toLatin1() );
+        socket->disconnectFromHost();
+    }
+}
+
+void MetricsExporter::writeDumpFile()
+{
+    // write to a temporary file first, so the collector never reads half a dump
+    QString tempFile = m_dumpFile + QLatin1String( ".tmp" );
+
+    QFile file( tempFile );
+    if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) ) {
+        qWarning() << "MetricsExporter::writeDumpFile || can't write" << tempFile;
+        return;
+    }
+
+    file.write( Core::RuntimeMetrics::dump().toLatin1() );
+    file.close();
+
+    QFile::remove( m_dumpFile );
+    QFile::rename( tempFile, m_dumpFile );
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+#include <QString>
+
+class QTcpServer;
+class QTimer;
+
+namespace BotRace {
+namespace Network {
+
+/**
+ * @brief Makes the Core::RuntimeMetrics of the server available to a local collector
+ *
+ * There are two ways to read the metrics, both are disabled by default:
+ * @li the admin socket listens on localhost only, sends the plain text dump to every
+ *     connecting client and closes the connection afterwards
+ * @li the dump file is rewritten periodically
+ *
+ * Both are configured in the server settings with the keys Server/metrics_port,
+ * Server/metrics_file and Server/metrics_interval (seconds).
+ */
+class MetricsExporter : public QObject {
+    Q_OBJECT
+public:
+    explicit MetricsExporter( QObject *parent = 0 );
+
+    /**
+     * @brief Opens the admin socket on localhost
+     *
+     * @param port the port to listen on
+     * @return @c false if the port could not be used
+     */
+    bool listen( quint16 port );
+
+    /**
+     * @brief Starts to write the metrics to @p fileName every @p interval seconds
+     */
+    void setDumpFile( const QString &fileName, int interval );
+
+private slots:
+    void sendMetrics();
+    void writeDumpFile();
+
+private:
+    QTcpServer *m_adminServer;      /**< Admin socket, only created when listen() was called */
+    QTimer *m_dumpTimer;            /**< Writes the dump file periodically */
+    QString m_dumpFile;             /**< Path of the dump file */
+};
+
+}
+}
+
+#endif // METRICSEXPORTER_H
@@ -18,12 +18,13 @@
 #include "server.h"
 
 #include "serverclient.h"
+#include "serverbroadcast.h"
+#include "gametable.h"
+#include "metricsexporter.h"
 #include "network/connection.h"
 
 #include "engine/abstractclient.h"
-#include "engine/participant.h"
 #include "engine/gamelogandchat.h"
-#include "engine/gameengine.h"
 
 #include "ui/serverlobbydialog.h"
 
@@ -34,6 +35,7 @@
 #include <QNetworkConfigurationManager>
 #include <QNetworkSession>
 #include <QTcpServer>
+#include <QThread>
 #include <QUuid>
 
 #include <QSettings>
@@ -50,12 +52,40 @@ Server::Server( ServerSettings_T settings ) :
     m_tcpServer( 0 ),
     m_networkSession( 0 ),
     m_logAndChat( new Core::GameLogAndChat() ),
-    m_gameEngine( 0 ),
-    m_gameIsRunning(false)
+    m_broadcast( 0 ),
+    m_metrics( 0 ),
+    m_table( 0 ),
+    m_tableThread( 0 ),
+    m_gameIsRunning(false),
+    m_quitRequested(false),
+    m_reconnectGraceTime( 0 )
 {
     m_sld = new ServerLobbyDialog();
     m_sld->setLogAndChat( m_logAndChat );
 
+    m_broadcast = new ServerBroadcast( this );
+    m_broadcast->setLogAndChat( m_logAndChat );
+
+    // log entries dropped from the in memory history can be archived on disk
+    QSettings serverConfig( QSettings::UserScope, QLatin1String( "BotRace" ) );
+    m_logAndChat->setArchiveFile( serverConfig.value( QLatin1String( "Server/log_archive" ) ).toString() );
+
+    // 0 replaces a disconnected client by a bot right away
+    m_reconnectGraceTime = serverConfig.value( QLatin1String( "Server/reconnect_grace" ), 60 ).toInt();
+
+    // runtime metrics for a local collector, disabled unless configured
+    m_metrics = new MetricsExporter( this );
+    int metricsPort = serverConfig.value( QLatin1String( "Server/metrics_port" ), 0 ).toInt();
+    if( metricsPort > 0 ) {
+        m_metrics->listen( metricsPort );
+    }
+    QString metricsFile = serverConfig.value( QLatin1String( "Server/metrics_file" ) ).toString();
+    if( !metricsFile.isEmpty() ) {
+        m_metrics->setDumpFile( metricsFile, serverConfig.value( QLatin1String( "Server/metrics_interval" ), 10 ).toInt() );
+    }
+
+    connect( m_sld, SIGNAL( settingsChanged( BotRace::Core::GameSettings_T ) ), m_broadcast, SLOT( sendSettingsChanged( BotRace::Core::GameSettings_T ) ) );
+
     connect( m_sld, SIGNAL( startStopGame() ), this, SLOT( startStopGame() ) );
     connect( m_sld, SIGNAL( stopServer() ), this, SLOT( quitServer() ) );
 
@@ -67,7 +97,7 @@ Server::Server( ServerSettings_T settings ) :
 
 Server::~Server()
 {
-    delete m_gameEngine;
+    delete m_table;
     delete m_logAndChat;
     delete m_sld;
 
@@ -129,9 +159,13 @@ void Server::initializeServer()
 
 void Server::quitServer()
 {
-    m_gameEngine->stop();
-    delete m_gameEngine;
-    m_gameEngine = 0;
+    // the table hands its clients back first, gameFinished() quits again afterwards
+    if( m_gameIsRunning ) {
+        m_quitRequested = true;
+        stopGame();
+        return;
+    }
+
     delete m_sld;
     m_sld = 0;
 
@@ -151,48 +185,74 @@ void Server::startStopGame()
         stopGame();
     }
     else {
-        m_gameEngine = new Core::GameEngine( m_logAndChat );
-        m_gameEngine->setUpGame( m_sld->getServerSettings() );
-
-        connect( m_gameEngine, SIGNAL( gameOver( BotRace::Core::Participant * ) ), this, SLOT( gameOver(BotRace::Core::Participant*) ) );
-
-        //now add all players to the game
-        foreach(ServerClient* participant, m_lobbyList) {
-            m_gameEngine->joinGame(participant);
-
-            // send the used scenario xml to the player
-            participant->setGameEngine(m_gameEngine);
-            participant->sendScenarioChanges();
+        m_gameIsRunning = true;
+
+        m_tableThread = new QThread( this );
+        m_table = new GameTable( m_logAndChat, m_broadcast, m_reconnectGraceTime );
+        m_table->moveToThread( m_tableThread );
+
+        connect( m_table, SIGNAL( gameStarted() ), this, SLOT( gameStarted() ) );
+        connect( m_table, SIGNAL( gameFinished() ), this, SLOT( gameFinished() ) );
+        connect( m_table, SIGNAL( clientResumed(BotRace::Network::ServerClient*) ), this, SLOT( clientResumed(BotRace::Network::ServerClient*) ) );
+        connect( m_table, SIGNAL( resumeFailed(BotRace::Network::Connection*) ), this, SLOT( resumeFailed(BotRace::Network::Connection*) ) );
+        // the lobby acknowledges dropped clients with GameTable::clientForgotten()
+        connect( m_table, SIGNAL( clientDropped(BotRace::Network::ServerClient*) ), this, SLOT( clientDropped(BotRace::Network::ServerClient*) ) );
+
+        m_tableThread->start();
+
+        // hand all players and spectators over to the table, until the game is over
+        // they are only used in the thread of the table
+        m_tableClients = m_lobbyList;
+        foreach(ServerClient* participant, m_tableClients) {
+            participant->changeThread( m_tableThread );
+            QMetaObject::invokeMethod( m_table, "addClient", Qt::QueuedConnection, Q_ARG( BotRace::Network::ServerClient*, participant ) );
         }
 
-        if( m_gameEngine->start() ) {
-            m_sld->gameStarted();
-            m_gameIsRunning = true;
-        }
-        else {
-            stopGame();
+        foreach(ServerClient* spectator, m_spectatorList) {
+            spectator->changeThread( m_tableThread );
+            QMetaObject::invokeMethod( m_table, "addSpectator", Qt::QueuedConnection, Q_ARG( BotRace::Network::ServerClient*, spectator ) );
         }
+
+        QMetaObject::invokeMethod( m_table, "startGame", Qt::QueuedConnection, Q_ARG( BotRace::Core::GameSettings_T, m_sld->getServerSettings() ) );
     }
 }
 
 void Server::stopGame()
 {
-    m_gameIsRunning = false;
-
-    m_gameEngine->stop();
-    m_gameEngine->deleteLater();
+    QMetaObject::invokeMethod( m_table, "stopGame", Qt::QueuedConnection );
+}
 
-    m_sld->gameStopped();
+void Server::gameStarted()
+{
+    m_sld->gameStarted();
 }
 
-void Server::gameOver(BotRace::Core::Participant *p)
+void Server::gameFinished()
 {
-    Q_UNUSED(p)
+    // the table emits gameFinished() last and does not wait for the lobby anymore
+    m_tableThread->quit();
+    m_tableThread->wait();
+
+    delete m_table;
+    m_table = 0;
+    delete m_tableThread;
+    m_tableThread = 0;
+
     m_gameIsRunning = false;
 
-    m_gameEngine->deleteLater();
+    // the disconnect of these clients reached the table after the game was over
+    foreach( ServerClient* ac, m_tableClients ) {
+        if( !ac->getConnection()->isOk() ) {
+            removeClient( ac );
+        }
+    }
+    m_tableClients.clear();
 
     m_sld->gameStopped();
+
+    if( m_quitRequested ) {
+        quitServer();
+    }
 }
 
 void Server::sessionOpened()
@@ -262,18 +322,26 @@ void Server::clientConnected()
     connect( connection, SIGNAL( disconnected() ), this, SLOT( clientDisconnected() ) );
 
     if( connection->isOk() ) {
-        // create a new client object
-        ServerClient *sc = new ServerClient( connection );
+        createClient( connection );
+    }
+}
 
-        connect (sc, SIGNAL(handshakesSuccessful(BotRace::Network::ServerClient*)), this, SLOT(addClient(BotRace::Network::ServerClient*)));
+void Server::createClient( Connection *connection )
+{
+    // create a new client object
+    ServerClient *sc = new ServerClient( connection, m_broadcast );
 
-        connect( m_sld, SIGNAL( settingsChanged( BotRace::Core::GameSettings_T ) ), sc, SLOT( sendSettingsChanged( BotRace::Core::GameSettings_T ) ) );
-        connect( m_logAndChat, SIGNAL( newEntry(Core::LogChatEntry_T) ), sc, SLOT( sendLogAndChatEntry(Core::LogChatEntry_T) ) );
-    }
+    connect (sc, SIGNAL(handshakesSuccessful(BotRace::Network::ServerClient*)), this, SLOT(addClient(BotRace::Network::ServerClient*)));
+    connect (sc, SIGNAL(resumeRequested(BotRace::Network::ServerClient*,QUuid)), this, SLOT(resumeClient(BotRace::Network::ServerClient*,QUuid)));
 }
 
 void Server::addClient(BotRace::Network::ServerClient *newParticipant)
 {
+    if( newParticipant->isSpectator() ) {
+        addSpectator( newParticipant );
+        return;
+    }
+
     // send current game settings
     newParticipant->sendSettingsChanged( m_sld->getServerSettings() );
 
@@ -284,26 +352,136 @@ void Server::addClient(BotRace::Network::ServerClient *newParticipant)
     }
 
     m_lobbyList.append( newParticipant );
+    m_broadcast->addLobbyConnection( newParticipant->getConnection() );
     m_sld->addParticipant( newParticipant );
 
     m_logAndChat->addEntry( Core::GAMEINFO_PARTICIPANT_POSITIVE, tr( "%1 joined the game" ).arg( newParticipant->getName() ) );
 }
 
+void Server::addSpectator(BotRace::Network::ServerClient *spectator)
+{
+    if( !m_settings.spectators ) {
+        qWarning() << "Server::addSpectator || spectators are not allowed, refuse" << spectator->getName();
+        spectator->getConnection()->disconnect();
+        spectator->deleteLater();
+        return;
+    }
+
+    spectator->sendSettingsChanged( m_sld->getServerSettings() );
+
+    m_spectatorList.append( spectator );
+    m_broadcast->addSpectatorConnection( spectator->getConnection() );
+
+    // the table sends the scenario and a snapshot if the game is running already
+    if( m_table ) {
+        spectator->changeThread( m_tableThread );
+        QMetaObject::invokeMethod( m_table, "addSpectator", Qt::QueuedConnection, Q_ARG( BotRace::Network::ServerClient*, spectator ) );
+    }
+
+    m_logAndChat->addEntry( Core::GAMEINFO_PARTICIPANT_POSITIVE, tr( "%1 is watching the game" ).arg( spectator->getName() ) );
+}
+
 void Server::clientDisconnected()
 {
     Connection *c = qobject_cast<Connection *>( sender() );
 
     // find the client which was disconnected by its unique Uuid
     foreach( ServerClient* ac, m_lobbyList ) {
-        if( ac->getUuid() == c->getUuid() ) {
+        if( ac->getUuid() != c->getUuid() ) {
+            continue;
+        }
+
+        // keep the place in the running game, the client may come back
+        if( m_tableClients.contains( ac ) ) {
+            m_broadcast->removeConnection( c );
+            QMetaObject::invokeMethod( m_table, "clientDisconnected", Qt::QueuedConnection, Q_ARG( BotRace::Network::ServerClient*, ac ) );
+        }
+        else {
             removeClient( ac );
         }
     }
+
+    foreach( ServerClient* spectator, m_spectatorList ) {
+        if( spectator->getUuid() == c->getUuid() ) {
+            m_spectatorList.removeOne( spectator );
+            m_broadcast->removeConnection( c );
+
+            if( m_table ) {
+                QMetaObject::invokeMethod( m_table, "removeSpectator", Qt::QueuedConnection, Q_ARG( BotRace::Network::ServerClient*, spectator ) );
+            }
+            else {
+                spectator->deleteLater();
+            }
+        }
+    }
+}
+
+void Server::resumeClient( BotRace::Network::ServerClient *newParticipant, const QUuid &sessionToken )
+{
+    // only the running game has clients waiting for a reconnect
+    if( !m_table ) {
+        addClient( newParticipant );
+        return;
+    }
+
+    Connection *connection = newParticipant->takeConnection();
+    newParticipant->deleteLater();
+
+    // called while the connection reads the handshake, the following packets stay in
+    // the socket and the connection is moved after the read returned
+    connection->pauseReading();
+    QMetaObject::invokeMethod( this, "moveToTable", Qt::QueuedConnection,
+                               Q_ARG( BotRace::Network::Connection*, connection ), Q_ARG( QUuid, sessionToken ) );
+}
+
+void Server::moveToTable( BotRace::Network::Connection *connection, const QUuid &sessionToken )
+{
+    // the game ended meanwhile
+    if( !m_table ) {
+        resumeFailed( connection );
+        return;
+    }
+
+    connection->moveToThread( m_tableThread );
+    QMetaObject::invokeMethod( m_table, "resumeClient", Qt::QueuedConnection,
+                               Q_ARG( BotRace::Network::Connection*, connection ), Q_ARG( QUuid, sessionToken ) );
+}
+
+void Server::clientResumed( BotRace::Network::ServerClient *participant )
+{
+    m_broadcast->addLobbyConnection( participant->getConnection() );
+
+    m_logAndChat->addEntry( Core::GAMEINFO_PARTICIPANT_POSITIVE, tr( "%1 rejoined the game" ).arg( participant->getName() ) );
+}
+
+void Server::resumeFailed( BotRace::Network::Connection *connection )
+{
+    // the client answers the new handshake without token and joins the lobby
+    createClient( connection );
+    connection->resumeReading();
+}
+
+void Server::clientDropped( BotRace::Network::ServerClient *participant )
+{
+    m_tableClients.removeOne( participant );
+    m_lobbyList.removeOne( participant );
+    m_broadcast->removeConnection( participant->getConnection() );
+    m_sld->removeParticipant( participant );
+
+    foreach(ServerClient *existingParticipant, m_lobbyList) {
+        existingParticipant->clientRemoved(participant);
+    }
+
+    m_logAndChat->addEntry( Core::GAMEINFO_PARTICIPANT_NEGATIVE, tr( "%1 left the game" ).arg( participant->getName() ) );
+
+    // now the engine of the table may delete the client
+    QMetaObject::invokeMethod( m_table, "clientForgotten", Qt::QueuedConnection, Q_ARG( BotRace::Network::ServerClient*, participant ) );
 }
 
 void Server::removeClient( BotRace::Network::ServerClient *participant)
 {
     m_lobbyList.removeOne( participant );
+    m_broadcast->removeConnection( participant->getConnection() );
     m_sld->removeParticipant( participant );
 
 
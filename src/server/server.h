@@ -19,6 +19,7 @@
 #define SERVER_H
 
 #include <QObject>
+#include <QUuid>
 
 #include "hostserverdialog.h"
 #include "engine/gamesettings.h"
@@ -27,17 +28,20 @@ class QTcpServer;
 class QNetworkSession;
 class QSystemTrayIcon;
 class QMenu;
+class QThread;
 
 namespace BotRace {
 namespace Core {
-    class Participant;
-    class GameEngine;
     class GameLogAndChat;
 }
 
 namespace Network {
     class ServerLobbyDialog;
+    class Connection;
     class ServerClient;
+    class GameTable;
+    class ServerBroadcast;
+    class MetricsExporter;
 
  /**
  * @brief The Server class contains all connected ServerClients and the GameEngine to play the game
@@ -48,7 +52,12 @@ namespace Network {
  * The main connection between Server and Client is realized via the ServerClient and NetworkClient classes and done with the Connection object between them.
  * All game related changes will be send via the ServerClient.
  *
- * @todo add spectator mode
+ * If the server allows it, clients can join as spectators. They are kept in their own list, never join
+ * a game and receive the game only via the ServerBroadcast.
+ *
+ * The Server itself runs in the main thread, accepts new connections, does the handshake and keeps the lobby.
+ * A running game is played by a GameTable in its own thread. All players and spectators are handed over to
+ * the table when the game starts and come back when it is over. The table is only used with queued calls.
  */
 class Server : public QObject {
     Q_OBJECT
@@ -68,6 +77,8 @@ private slots:
     /**
      * @brief Shut down the server
      *
+     * A running game is stopped first, the server quits once the table finished it.
+     *
      * @todo notify the clients that server is going down
      */
     void quitServer();
@@ -75,8 +86,8 @@ private slots:
     /**
      * @brief Starts a new game or stops the current one
      *
-     * If no game is runnung create a new GameEngine object and start the game
-     * All connected clients will be added to the new game
+     * If no game is runnung create a new GameTable in its own thread and start the game there
+     * All connected clients will be moved to the table and added to the new game
      *
      * if a game is already running, stop it and clean up all game related parts
      * @see stopGame()
@@ -84,20 +95,22 @@ private slots:
     void startStopGame();
 
     /**
-     * @brief Stops a running game, either by the admin or when the game ends
+     * @brief Asks the GameTable to stop the running game
      */
     void stopGame();
 
     /**
-     * @brief Called by the GameEngine when a game is finished (won or lost)
-     *
-     * Stops the game and notify all connected clients about the stopped game
-     *
-     * @param p the winning Participant of the game or 0 if all Robots are dead
+     * @brief Called by the GameTable when the GameEngine started the game
+     */
+    void gameStarted();
+
+    /**
+     * @brief Called by the GameTable when the game is over or stopped
      *
-     * @see stopGame()
+     * All clients are back in the lobby thread. Stops the table thread and removes
+     * the clients that lost their connection in the meantime.
      */
-    void gameOver(BotRace::Core::Participant *p);
+    void gameFinished();
 
     /**
      * @brief Starts a new server instance and opens the tcp server that listens to clients that want to connect
@@ -120,6 +133,16 @@ private slots:
      */
     void addClient(BotRace::Network::ServerClient *newParticipant);
 
+    /**
+     * @brief Adds a client that only watches the lobby and the games
+     *
+     * If a game is running the spectator receives the scenario and a snapshot of the game at once.
+     * Spectators are refused if the server does not allow them.
+     *
+     * @param spectator the ServerClient object of the spectator
+     */
+    void addSpectator(BotRace::Network::ServerClient *spectator);
+
     /**
      * @brief Called when the NetworkClient left the game
      *
@@ -139,6 +162,46 @@ private slots:
      */
     void removeClient(BotRace::Network::ServerClient *participant);
 
+    /**
+     * @brief Called when a NetworkClient rejoins a running game with its session token
+     *
+     * The new connection is handed over to the GameTable, where the suspended ServerClient with the same
+     * token takes it over. If no game is running, the client is added as new one.
+     *
+     * @param newParticipant the temporary ServerClient created for the new connection
+     * @param sessionToken the token the client received with its first handshake
+     */
+    void resumeClient(BotRace::Network::ServerClient *newParticipant, const QUuid &sessionToken);
+
+    /**
+     * @brief Called by the GameTable when the suspended client continues the game
+     */
+    void clientResumed(BotRace::Network::ServerClient *participant);
+
+    /**
+     * @brief Called by the GameTable when no client waited for the session token
+     *
+     * Creates a new ServerClient for the connection, which joins the lobby after the handshake.
+     */
+    void resumeFailed(BotRace::Network::Connection *connection);
+
+    /**
+     * @brief Hands the paused connection of a resuming client over to the GameTable
+     *
+     * Queued by resumeClient(), so the connection is not read anymore while it is moved.
+     */
+    void moveToTable(BotRace::Network::Connection *connection, const QUuid &sessionToken);
+
+    /**
+     * @brief Removes a client that left the running game for good from the lobby
+     *
+     * Called by the GameTable before the GameEngine replaces the client by a SimpleBot.
+     * Answers with GameTable::clientForgotten(), the client is deleted by the table afterwards.
+     *
+     * @param participant the dropped ServerClient
+     */
+    void clientDropped(BotRace::Network::ServerClient *participant);
+
 private:
     /**
      * @brief Creates the trayicon object
@@ -152,6 +215,11 @@ private:
      */
     void initializeServer();
 
+    /**
+     * @brief Creates the ServerClient for a new connection and waits for its handshake
+     */
+    void createClient( Connection *connection );
+
     QSystemTrayIcon *m_trayIcon;                /**< Server trayicon Object */
     QMenu *m_trayIconMenu;                      /**< Menu to show in the trayicon */
     QAction *m_restoreAction;                   /**< Show lobby via tray icon */
@@ -163,10 +231,17 @@ private:
 
     Network::ServerLobbyDialog *m_sld;          /**< Dialog for the participant list, chat, game settings */
     Core::GameLogAndChat *m_logAndChat;         /**< Chat-/Loginstance for the server and all games */
-    Core::GameEngine *m_gameEngine;             /**< Holds the game engine for each game, will be deleted after each round */
+    ServerBroadcast *m_broadcast;               /**< Encodes all events for the lobby and the game once for all clients */
+    MetricsExporter *m_metrics;                 /**< Admin socket and dump file for the runtime metrics */
+    GameTable *m_table;                         /**< Plays the running game, will be deleted after each round */
+    QThread *m_tableThread;                     /**< Event loop of the running game */
     bool m_gameIsRunning;
+    bool m_quitRequested;                       /**< quitServer() waits for the running game to finish */
+    int m_reconnectGraceTime;                   /**< Seconds a client can rejoin the running game after a disconnect */
 
     QList<ServerClient*> m_lobbyList;           /**< Holds all clients connected to the server */
+    QList<ServerClient*> m_spectatorList;       /**< Holds all clients watching the games */
+    QList<ServerClient*> m_tableClients;        /**< Clients handed over to the running game */
 };
 
 }
@@ -29,12 +29,18 @@ message("-----------------------------------------------------------------------
 HEADERS += \
     serverclient.h \
     server.h \
+    serverbroadcast.h \
+    gametable.h \
+    metricsexporter.h \
     hostserverdialog.h
 
 SOURCES += \
     main.cpp \
     serverclient.cpp \
     server.cpp \
+    serverbroadcast.cpp \
+    gametable.cpp \
+    metricsexporter.cpp \
     hostserverdialog.cpp
 
 FORMS += \
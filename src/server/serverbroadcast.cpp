@@ -0,0 +1,426 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "serverbroadcast.h"
+
+#include "engine/participant.h"
+#include "engine/boardmanager.h"
+#include "engine/gamesettings.h"
+#include "engine/scenariocache.h"
+#include "engine/coreconst.h"
+
+#include <QDataStream>
+#include <QFileInfo>
+#include <QTimer>
+
+#include <QDebug>
+
+using namespace BotRace;
+using namespace Network;
+
+ServerBroadcast::ServerBroadcast( QObject *parent ) :
+    QObject( parent ),
+    m_gameEngine( 0 ),
+    m_logAndChat( 0 )
+{
+    m_snapshotTimer = new QTimer( this );
+    m_snapshotTimer->setInterval( SPECTATOR_SNAPSHOT_INTERVAL );
+    connect( m_snapshotTimer, SIGNAL( timeout() ), this, SLOT( sendSnapshotToLaggingSpectators() ) );
+}
+
+void ServerBroadcast::addLobbyConnection( Connection *connection )
+{
+    if( !m_lobbyConnections.contains( connection ) ) {
+        m_lobbyConnections.append( connection );
+    }
+}
+
+void ServerBroadcast::addGameConnection( Connection *connection )
+{
+    if( !m_gameConnections.contains( connection ) ) {
+        m_gameConnections.append( connection );
+    }
+}
+
+void ServerBroadcast::addSpectatorConnection( Connection *connection )
+{
+    if( !m_spectatorConnections.contains( connection ) ) {
+        m_spectatorConnections.append( connection );
+    }
+}
+
+void ServerBroadcast::removeConnection( Connection *connection )
+{
+    m_lobbyConnections.removeAll( connection );
+    m_gameConnections.removeAll( connection );
+    m_spectatorConnections.removeAll( connection );
+    m_laggingSpectators.removeAll( connection );
+}
+
+void ServerBroadcast::setGameEngine( Core::GameEngine *ge )
+{
+    if( m_gameEngine ) {
+        disconnect( m_gameEngine, 0, this, 0 );
+        disconnect( m_gameEngine->getBoard(), 0, this, 0 );
+    }
+
+    m_gameEngine = ge;
+    m_gameConnections.clear();
+    m_scenarioHash.clear();
+    m_scenarioFileName.clear();
+    m_encodedScenario.clear();
+
+    if( !m_gameEngine ) {
+        return;
+    }
+
+    // the scenario does not change while the game is running, so encode it only once
+    Core::BoardScenario_T scenario = m_gameEngine->getBoard()->getScenario();
+    m_scenarioHash = Core::ScenarioCache::scenarioHash( scenario );
+    m_scenarioFileName = QFileInfo( m_gameEngine->getGameSettings().scenario ).fileName();
+    m_encodedScenario = Core::ScenarioCache::encodeScenario( scenario );
+
+    connect( m_gameEngine, SIGNAL( settingsChanged(BotRace::Core::GameSettings_T) ), this, SLOT( sendSettingsChanged(BotRace::Core::GameSettings_T) ) );
+    connect( m_gameEngine, SIGNAL( gameStarted() ), this, SLOT( sendGameStarted() ) );
+    connect( m_gameEngine, SIGNAL( animateRobotMovement() ), this, SLOT( sendAnimateRobotMovement() ) );
+    connect( m_gameEngine, SIGNAL( animateRobotMovement(BotRace::Core::RobotAnimation_T) ), this, SLOT( sendAnimateRobotMovement(BotRace::Core::RobotAnimation_T) ) );
+    connect( m_gameEngine, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ), this, SLOT( sendAnimateGraphicElements(BotRace::Core::AnimateElements,int) ) );
+    connect( m_gameEngine, SIGNAL( animationBarrierStarted(quint32) ), this, SLOT( sendAnimationBarrier(quint32) ) );
+    connect( m_gameEngine, SIGNAL( phaseChanged(int) ), this, SLOT( sendPhaseChanged(int) ) );
+    connect( m_gameEngine->getBoard(), SIGNAL( kingOfFlagChanges(bool,QPoint) ), this, SLOT( sendKingOfFlagChanged(bool,QPoint) ) );
+}
+
+void ServerBroadcast::setLogAndChat( Core::GameLogAndChat *glac, bool sendEntries )
+{
+    m_logAndChat = glac;
+
+    if( !sendEntries ) {
+        return;
+    }
+
+    connect( glac, SIGNAL( newEntry(Core::LogChatEntry_T) ), this, SLOT( sendLogAndChatEntry(Core::LogChatEntry_T) ) );
+}
+
+Core::GameLogAndChat *ServerBroadcast::getLogAndChat() const
+{
+    return m_logAndChat;
+}
+
+QByteArray ServerBroadcast::scenarioHash() const
+{
+    return m_scenarioHash;
+}
+
+QString ServerBroadcast::scenarioFileName() const
+{
+    return m_scenarioFileName;
+}
+
+QByteArray ServerBroadcast::encodedScenario() const
+{
+    return m_encodedScenario;
+}
+
+void ServerBroadcast::watchParticipant( Core::Participant *player )
+{
+    connect( player, SIGNAL( nameChanged() ), this, SLOT( sendParticipantChanges() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( destroyed() ), this, SLOT( sendParticipantDead() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( resurrected() ), this, SLOT( sendParticipantResurrected() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( gotHit( BotRace::Core::Robot::DamageReason_T ) ), this, SLOT( sendParticipantGotHit( BotRace::Core::Robot::DamageReason_T ) ), Qt::UniqueConnection );
+
+    connect( player, SIGNAL( lifeCountChanged( ushort ) ), this, SLOT( sendParticipantChanges() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( damageTokenCountChanged( ushort ) ), this, SLOT( sendParticipantChanges() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( positionChanged( QPoint, BotRace::Core::Orientation ) ), this, SLOT( sendParticipantChanges() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( flagGoalChanged( ushort ) ), this, SLOT( sendParticipantChanges() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( archiveMarkerChanged( QPoint ) ), this, SLOT( sendParticipantChanges() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( shootsTo(QPoint) ), this, SLOT( sendRobotShootLasers(QPoint) ), Qt::UniqueConnection );
+    connect( player, SIGNAL( statisticsChaged() ), this, SLOT( sendParticipantChanges() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( isVirtualRobot(bool) ), this, SLOT( sendParticipantChanges() ), Qt::UniqueConnection );
+    connect( player, SIGNAL( powerDownChanged(bool) ), this, SLOT( sendParticipantChanges() ), Qt::UniqueConnection );
+}
+
+void ServerBroadcast::sendSpectatorSnapshot( Connection *connection )
+{
+    if( !m_gameEngine ) {
+        return;
+    }
+
+    connection->sendPacket( createSpectatorSnapshot() );
+}
+
+void ServerBroadcast::sendSnapshotToSpectators()
+{
+    if( !m_gameEngine ) {
+        return;
+    }
+
+    m_laggingSpectators.clear();
+    broadcast( m_spectatorConnections, createSpectatorSnapshot() );
+}
+
+void ServerBroadcast::sendSnapshotToLaggingSpectators()
+{
+    QByteArray packet;
+
+    foreach( Connection * connection, m_laggingSpectators ) {
+        // still busy with the old events
+        if( connection->queuedBytes() > 0 ) {
+            continue;
+        }
+
+        if( m_gameEngine ) {
+            if( packet.isEmpty() ) {
+                packet = createSpectatorSnapshot();
+            }
+            connection->sendPacket( packet );
+        }
+
+        m_laggingSpectators.removeAll( connection );
+    }
+
+    if( m_laggingSpectators.isEmpty() ) {
+        m_snapshotTimer->stop();
+    }
+}
+
+QByteArray ServerBroadcast::createSpectatorSnapshot()
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    // same layout as ServerClient::sendGameSnapshot(), but without the identity and cards of a participant
+    outstream << QUuid() << QUuid();
+    outstream << m_gameEngine->getCurrentPhase();
+    outstream << m_logAndChat->lastSequence();
+
+    outstream << m_gameEngine->getBoard()->isKingOfFlagDropped() << m_gameEngine->getBoard()->getKingOfFlagPosition();
+
+    QList<Core::Participant *> participants = m_gameEngine->getParticipants();
+    outstream << ( quint16 )participants.size();
+    foreach( Core::Participant * p, participants ) {
+        outstream << *p;
+
+        // with bots only no ServerClient watches the participants
+        watchParticipant( p );
+    }
+
+    outstream << QList<Core::GameCard_T>() << QList<Core::GameCard_T>();
+    outstream << ( quint16 )( MAX_PROGRAM_SIZE + 1 );
+
+    return Connection::createPacket( DATA_GAME_SNAPSHOT, data );
+}
+
+void ServerBroadcast::sendSettingsChanged( BotRace::Core::GameSettings_T settings )
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << settings;
+
+    broadcastLobbyEvent( Connection::createPacket( DATA_SETTINGS_CHANGED, data ) );
+}
+
+void ServerBroadcast::sendParticipantChanges()
+{
+    Core::Participant *p = qobject_cast<Core::Participant *>( sender() );
+
+    if( !p ) {
+        return;
+    }
+
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << *p;
+
+    broadcastGameEvent( Connection::createPacket( PARTICIPANT_CHANGES, data ) );
+}
+
+void ServerBroadcast::sendParticipantDead()
+{
+    Core::Participant *p = qobject_cast<Core::Participant *>( sender() );
+
+    if( !p ) {
+        return;
+    }
+
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << p->getUuid();
+
+    broadcastGameEvent( Connection::createPacket( SIGNAL_PARTICIPANT_DEAD, data ) );
+}
+
+void ServerBroadcast::sendParticipantResurrected()
+{
+    Core::Participant *p = qobject_cast<Core::Participant *>( sender() );
+
+    if( !p ) {
+        return;
+    }
+
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << p->getUuid();
+
+    broadcastGameEvent( Connection::createPacket( SIGNAL_PARTICIPANT_RESURRECTED, data ) );
+}
+
+void ServerBroadcast::sendParticipantGotHit( BotRace::Core::Robot::DamageReason_T reason )
+{
+    Core::Participant *p = qobject_cast<Core::Participant *>( sender() );
+
+    if( !p ) {
+        return;
+    }
+
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << p->getUuid();
+    outstream << ( quint16 )reason;
+
+    broadcastGameEvent( Connection::createPacket( DATA_PARTICIPANT_GOT_HIT, data ) );
+}
+
+void ServerBroadcast::sendRobotShootLasers( const QPoint &target )
+{
+    Core::Participant *p = qobject_cast<Core::Participant *>( sender() );
+
+    if( !p ) {
+        return;
+    }
+
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << p->getUuid() << target;
+
+    broadcastGameEvent( Connection::createPacket( SIGNAL_ANIMATE_ROBOT_LASER, data ) );
+}
+
+void ServerBroadcast::sendGameStarted()
+{
+    broadcastGameEvent( Connection::createPacket( SIGNAL_GAME_STARTED ) );
+}
+
+void ServerBroadcast::sendAnimateRobotMovement()
+{
+    broadcastGameEvent( Connection::createPacket( SIGNAL_ANIMATE_ROBOTS ) );
+}
+
+void ServerBroadcast::sendAnimateRobotMovement( const BotRace::Core::RobotAnimation_T &sequence )
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << sequence;
+
+    broadcastGameEvent( Connection::createPacket( DATA_ANIMATE_ROBOTS_LIST, data ) );
+}
+
+void ServerBroadcast::sendAnimateGraphicElements( BotRace::Core::AnimateElements animation, int phase )
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << ( quint16 )animation << phase;
+
+    broadcastGameEvent( Connection::createPacket( DATA_ANIMATE_ELEMENTS, data ) );
+}
+
+void ServerBroadcast::sendAnimationBarrier( quint32 barrier )
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << barrier;
+
+    broadcastGameEvent( Connection::createPacket( DATA_ANIMATION_BARRIER, data ) );
+}
+
+void ServerBroadcast::sendPhaseChanged( int phase )
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << phase;
+
+    broadcastGameEvent( Connection::createPacket( DATA_PHASE_CHANGED, data ) );
+}
+
+void ServerBroadcast::sendKingOfFlagChanged( bool flagDropped, const QPoint &position )
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << flagDropped << position;
+
+    broadcastGameEvent( Connection::createPacket( DATA_KINGOFFLAG_CHANGED, data ) );
+}
+
+void ServerBroadcast::sendLogAndChatEntry( const Core::LogChatEntry_T entry )
+{
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << entry;
+
+    broadcastLobbyEvent( Connection::createPacket( DATA_LOG_AND_CHAT_ENTRY, data ) );
+}
+
+void ServerBroadcast::broadcast( const QList<Connection *> &connections, const QByteArray &packet )
+{
+    foreach( Connection * connection, connections ) {
+        connection->sendPacket( packet );
+    }
+}
+
+void ServerBroadcast::broadcastToSpectators( const QByteArray &packet )
+{
+    foreach( Connection * connection, m_spectatorConnections ) {
+        if( m_laggingSpectators.contains( connection ) ) {
+            continue;
+        }
+
+        // a slow spectator gets snapshots until it caught up, instead of growing the queue
+        if( connection->queuedBytes() > SPECTATOR_QUEUE_LIMIT ) {
+            qDebug() << "ServerBroadcast::broadcastToSpectators || spectator" << connection->getUuid() << "fell behind";
+            m_laggingSpectators.append( connection );
+            if( !m_snapshotTimer->isActive() ) {
+                m_snapshotTimer->start();
+            }
+            continue;
+        }
+
+        connection->sendPacket( packet );
+    }
+}
+
+void ServerBroadcast::broadcastLobbyEvent( const QByteArray &packet )
+{
+    broadcast( m_lobbyConnections, packet );
+    broadcastToSpectators( packet );
+}
+
+void ServerBroadcast::broadcastGameEvent( const QByteArray &packet )
+{
+    broadcast( m_gameConnections, packet );
+    broadcastToSpectators( packet );
+}
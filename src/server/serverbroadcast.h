@@ -0,0 +1,211 @@
+/*
+ * Copyright 2011 Jörg Ehrichs <joerg.ehichs@gmx.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVERBROADCAST_H
+#define SERVERBROADCAST_H
+
+#include <QObject>
+#include <QList>
+
+#include "network/connection.h"
+#include "engine/gameengine.h"
+#include "engine/robot.h"
+#include "engine/gamelogandchat.h"
+
+class QTimer;
+
+namespace BotRace {
+namespace Core {
+    class GameEngine;
+    class Participant;
+}
+
+namespace Network {
+
+/**
+ * @brief The ServerBroadcast sends all events that are the same for every client exactly once
+ *
+ * Instead of letting each ServerClient subscribe to the GameEngine and encode its own copy of
+ * each event, the ServerBroadcast subscribes once, encodes the event once into a network packet
+ * and enqueues this implicitly shared packet to all interested connections.
+ *
+ * There are three groups of connections:
+ * @li lobby connections receive the log/chat entries and settings changes
+ * @li game connections receive all events of the running game (animations, phase changes, participant changes)
+ * @li spectator connections receive both, but never the private data of a participant
+ *
+ * Spectators don't take part in the game, so a slow spectator must not let the send queue grow.
+ * When more than SPECTATOR_QUEUE_LIMIT bytes are queued, the spectator does not get further events
+ * but a snapshot of the game every SPECTATOR_SNAPSHOT_INTERVAL ms, once its queue is empty again.
+ *
+ * Data only meant for a single client (deck cards, starting point selection) is still send by the ServerClient.
+ */
+class ServerBroadcast : public QObject {
+    Q_OBJECT
+public:
+    explicit ServerBroadcast( QObject *parent = 0 );
+
+    /**
+     * @brief Adds a connection that receives all lobby events
+     * @param connection the handshaked client connection
+     */
+    void addLobbyConnection( Connection *connection );
+
+    /**
+     * @brief Adds a connection that receives all events of the running game
+     * @param connection the client connection of a game participant
+     */
+    void addGameConnection( Connection *connection );
+
+    /**
+     * @brief Adds a connection that watches the lobby and the game without taking part
+     * @param connection the handshaked spectator connection
+     */
+    void addSpectatorConnection( Connection *connection );
+
+    /**
+     * @brief Removes the connection from the lobby, the game and the spectators
+     * @param connection the connection that left
+     */
+    void removeConnection( Connection *connection );
+
+    /**
+     * @brief Connects to all signals of the game engine which are broadcasted to the game connections
+     * @param ge the GameEngine or 0 if the game is stopped
+     */
+    void setGameEngine( Core::GameEngine *ge );
+
+    /**
+     * @brief Connects to the log used by the server
+     * @param glac the GameLogAndChat which entries are send to all lobby connections
+     * @param sendEntries @c false for the broadcast of a game table, the lobby already sends the entries to all clients
+     */
+    void setLogAndChat( Core::GameLogAndChat *glac, bool sendEntries = true );
+
+    /**
+     * @brief Returns the log used by the server
+     */
+    Core::GameLogAndChat *getLogAndChat() const;
+
+    /**
+     * @brief Returns the content hash of the scenario used by the current game
+     *
+     * @see Core::ScenarioCache
+     */
+    QByteArray scenarioHash() const;
+
+    /**
+     * @brief Returns the file name of the current scenario without path
+     */
+    QString scenarioFileName() const;
+
+    /**
+     * @brief Returns the compressed current scenario for clients which don't have it yet
+     */
+    QByteArray encodedScenario() const;
+
+    /**
+     * @brief Starts to broadcast all changes of the Participant
+     *
+     * Can be called several times for the same Participant, the signals are only connected once
+     * @param player the participant
+     */
+    void watchParticipant( Core::Participant *player );
+
+    /**
+     * @brief Sends the public state of the running game to the spectator
+     *
+     * Used when the spectator joins a running game. The snapshot is the same DATA_GAME_SNAPSHOT
+     * a reconnected client receives, without uuid and cards.
+     * @param connection the spectator connection
+     */
+    void sendSpectatorSnapshot( Connection *connection );
+
+    /**
+     * @brief Sends the public state of the game to all spectators at once
+     *
+     * Used when the game starts, as spectators don't receive the participants from a ServerClient.
+     */
+    void sendSnapshotToSpectators();
+
+public slots:
+    void sendSettingsChanged( BotRace::Core::GameSettings_T settings );
+
+private slots:
+    // participant changes
+    void sendParticipantChanges();
+    void sendParticipantDead();
+    void sendParticipantResurrected();
+    void sendParticipantGotHit( BotRace::Core::Robot::DamageReason_T reason );
+    void sendRobotShootLasers( const QPoint &target );
+
+    // game engine signals
+    void sendGameStarted();
+    void sendAnimateRobotMovement();
+    void sendAnimateRobotMovement( const BotRace::Core::RobotAnimation_T &sequence );
+    void sendAnimateGraphicElements( BotRace::Core::AnimateElements animation, int phase );
+    void sendAnimationBarrier( quint32 barrier );
+    void sendPhaseChanged( int phase );
+    void sendKingOfFlagChanged( bool flagDropped, const QPoint &position );
+
+    void sendLogAndChatEntry( const Core::LogChatEntry_T entry );
+
+    // spectators that fell behind
+    void sendSnapshotToLaggingSpectators();
+
+private:
+    /**
+     * @brief Enqueues the packet to all connections in @p connections
+     */
+    void broadcast( const QList<Connection *> &connections, const QByteArray &packet );
+
+    /**
+     * @brief Enqueues the packet to all spectators that keep up with the game
+     */
+    void broadcastToSpectators( const QByteArray &packet );
+
+    /**
+     * @brief Enqueues a lobby event to the lobby connections and the spectators
+     */
+    void broadcastLobbyEvent( const QByteArray &packet );
+
+    /**
+     * @brief Enqueues a game event to the game connections and the spectators
+     */
+    void broadcastGameEvent( const QByteArray &packet );
+
+    /**
+     * @brief Encodes the public state of the running game as DATA_GAME_SNAPSHOT packet
+     */
+    QByteArray createSpectatorSnapshot();
+
+    QList<Connection *> m_lobbyConnections;  /**< All handshaked clients */
+    QList<Connection *> m_gameConnections;   /**< All clients taking part in the running game */
+    QList<Connection *> m_spectatorConnections; /**< All clients watching the lobby and the game */
+    QList<Connection *> m_laggingSpectators; /**< Spectators waiting for a snapshot instead of events */
+    QTimer *m_snapshotTimer;                 /**< Sends snapshots to lagging spectators */
+    Core::GameEngine *m_gameEngine;
+    Core::GameLogAndChat *m_logAndChat;
+    QByteArray m_scenarioHash;       /**< Content hash of the scenario of the current game */
+    QString m_scenarioFileName;      /**< File name of the scenario of the current game */
+    QByteArray m_encodedScenario;    /**< Compressed scenario, encoded once for all clients */
+};
+
+}
+}
+
+#endif // SERVERBROADCAST_H
@@ -16,22 +16,31 @@
  */
 
 #include "serverclient.h"
+#include "serverbroadcast.h"
 
 #include "engine/carddeck.h"
 #include "engine/abstractclient.h"
 #include "engine/participant.h"
 #include "engine/boardmanager.h"
 #include "engine/gamesettings.h"
+#include "engine/coreconst.h"
 
+#include <QTimer>
+#include <QThread>
 #include <QDebug>
 
 using namespace BotRace;
 using namespace Network;
 
-ServerClient::ServerClient( Connection *connection ) :
+ServerClient::ServerClient( Connection *connection, ServerBroadcast *broadcast ) :
     AbstractClient(),
     m_connection( connection ),
-    m_gameEngine( 0 )
+    m_broadcast( broadcast ),
+    m_gameEngine( 0 ),
+    m_sessionToken( QUuid::createUuid() ),
+    m_suspended( false ),
+    m_spectator( false ),
+    m_programmingPending( false )
 {
     connect( m_connection, SIGNAL( dataReceived( BotRace::Network::DataType_T, QByteArray ) ), this, SLOT( onDataReceived( BotRace::Network::DataType_T, QByteArray ) ) );
 
@@ -39,19 +48,130 @@ ServerClient::ServerClient( Connection *connection ) :
     QByteArray data;
     QDataStream outstream( &data, QIODevice::WriteOnly );
 
-    outstream << m_connection->getUuid();
+    outstream << m_connection->getUuid() << m_sessionToken << PROTOCOL_VERSION;
 
     m_connection->sendData( HANDSHAKE, data );
 
-    // connect all signals thrown by this object which in single player go to the GameScene and send them over the network to the NetworkClient
-    connect( this, SIGNAL( animateRobotMovement() ), this, SLOT( sendAnimateRobotMovement() ) );
-    connect( this, SIGNAL( animateRobotMovement(QStringList) ), this, SLOT( sendAnimateRobotMovement(QStringList) ) );
-    connect( this, SIGNAL(animateGraphicElements(BotRace::Core::AnimateElements,int)), this, SLOT(sendAnimateGraphicElements(BotRace::Core::AnimateElements,int)) );
-
-    connect(this, SIGNAL(phaseChanged(int)), this, SLOT(sendPhaseChanged(int)) );
-
+    // animations, phase changes and participant changes are the same for all clients
+    // and thus send via the ServerBroadcast, only the client specific parts are connected here
     connect( this, SIGNAL( boardChanged() ), this, SLOT( sendScenarioChanges() ) );
     connect( this, SIGNAL( participantAdded(BotRace::Core::Participant*)),this, SLOT( connectParticipant(BotRace::Core::Participant*)) );
+    connect( this, SIGNAL( skipAnimations() ), this, SLOT( sendSkipAnimations() ) );
+
+    // only used while the client is suspended, same as for the SimpleBot
+    connect( this, SIGNAL( animateRobotMovement( BotRace::Core::RobotAnimation_T ) ), this, SLOT( acknowledgeAnimation() ) );
+    connect( this, SIGNAL( animateRobotMovement() ), this, SLOT( acknowledgeAnimation() ) );
+    connect( this, SIGNAL( animateGraphicElements(BotRace::Core::AnimateElements,int) ), this, SLOT( acknowledgeAnimation() ) );
+
+    m_graceTimer = new QTimer( this );
+    m_graceTimer->setSingleShot( true );
+    connect( m_graceTimer, SIGNAL( timeout() ), this, SLOT( onGraceTimeExpired() ) );
+}
+
+Connection *ServerClient::getConnection() const
+{
+    return m_connection;
+}
+
+void ServerClient::setBroadcast( ServerBroadcast *broadcast )
+{
+    m_broadcast = broadcast;
+}
+
+void ServerClient::changeThread( QThread *thread )
+{
+    moveToThread( thread );
+    m_connection->moveToThread( thread );
+}
+
+QUuid ServerClient::getSessionToken() const
+{
+    return m_sessionToken;
+}
+
+Connection *ServerClient::takeConnection()
+{
+    disconnect( m_connection, SIGNAL( dataReceived( BotRace::Network::DataType_T, QByteArray ) ), this, SLOT( onDataReceived( BotRace::Network::DataType_T, QByteArray ) ) );
+
+    Connection *connection = m_connection;
+    m_connection = 0;
+
+    return connection;
+}
+
+void ServerClient::suspend( int graceTime )
+{
+    qDebug() << "ServerClient::suspend ||" << getName() << "waiting" << graceTime << "seconds for a reconnect";
+
+    m_suspended = true;
+    m_graceTimer->start( graceTime * 1000 );
+
+    // answer everything the engine is waiting for right now
+    if( m_programmingPending ) {
+        autoProgram();
+    }
+    if( !m_pendingStartingPoints.isEmpty() ) {
+        selectStartingPoint( m_pendingStartingPoints );
+    }
+    if( !m_pendingOrientations.isEmpty() ) {
+        selectStartingOrientation( m_pendingOrientations );
+    }
+    acknowledgeAnimation();
+}
+
+void ServerClient::resume( Connection *connection )
+{
+    qDebug() << "ServerClient::resume ||" << getName();
+
+    m_graceTimer->stop();
+    m_suspended = false;
+
+    m_connection->deleteLater();
+    m_connection = connection;
+    m_connection->setUid( getUuid() );
+
+    connect( m_connection, SIGNAL( dataReceived( BotRace::Network::DataType_T, QByteArray ) ), this, SLOT( onDataReceived( BotRace::Network::DataType_T, QByteArray ) ) );
+}
+
+bool ServerClient::isSuspended() const
+{
+    return m_suspended;
+}
+
+void ServerClient::sendGameSnapshot()
+{
+    if( !m_gameEngine ) {
+        return;
+    }
+
+    QByteArray data;
+    QDataStream outstream( &data, QIODevice::WriteOnly );
+
+    outstream << getUuid() << m_sessionToken;
+    outstream << m_gameEngine->getCurrentPhase();
+    outstream << m_broadcast->getLogAndChat()->lastSequence();
+
+    outstream << m_gameEngine->getBoard()->isKingOfFlagDropped() << m_gameEngine->getBoard()->getKingOfFlagPosition();
+
+    QList<Core::Participant *> participants = m_gameEngine->getParticipants();
+    outstream << ( quint16 )participants.size();
+    foreach( Core::Participant * p, participants ) {
+        outstream << *p;
+    }
+
+    ushort minLockedSlot = MAX_PROGRAM_SIZE + 1;
+    for( ushort slot = 1; slot <= MAX_PROGRAM_SIZE; slot++ ) {
+        if( getDeck()->isProgramSlotLocked( slot ) ) {
+            minLockedSlot = slot;
+            break;
+        }
+    }
+
+    outstream << getDeck()->allCardsFromDeck();
+    outstream << getDeck()->allCardsFromProgram();
+    outstream << ( quint16 )minLockedSlot;
+
+    m_connection->sendData( DATA_GAME_SNAPSHOT, data );
 }
 
 bool ServerClient::isBot()
@@ -59,13 +179,14 @@ bool ServerClient::isBot()
     return false;
 }
 
+bool ServerClient::isSpectator() const
+{
+    return m_spectator;
+}
+
 void ServerClient::setGameEngine( Core::GameEngine *ge )
 {
     m_gameEngine = ge;
-
-    connect( m_gameEngine, SIGNAL( settingsChanged(BotRace::Core::GameSettings_T) ), this, SLOT( sendSettingsChanged(BotRace::Core::GameSettings_T) ) );
-    connect( m_gameEngine, SIGNAL( gameStarted() ), this, SLOT( sendGameStarted() ) );
-    connect(m_gameEngine->getBoard(), SIGNAL(kingOfFlagChanges(bool,QPoint)), this, SLOT(sendKingOfFlagChanged(bool,QPoint)) );
 }
 
 void ServerClient::joinGame()
@@ -91,8 +212,6 @@ void ServerClient::clientAdded(ServerClient *client )
     outstream << client->getUuid() << client->getName() << client->isBot();
 
     m_connection->sendData( CLIENT_ADDED, data );
-
-    connect( client, SIGNAL( nameChanged() ), this, SLOT( sendParticipantChanges() ) );
 }
 
 void ServerClient::clientRemoved(ServerClient *client )
@@ -107,11 +226,26 @@ void ServerClient::clientRemoved(ServerClient *client )
 
 void ServerClient::startProgramming()
 {
+    m_programmingPending = true;
+
+    if( m_suspended ) {
+        autoProgram();
+        return;
+    }
+
     m_connection->sendSignal( SIGNAL_START_PROGRAMMING );
 }
 
 void ServerClient::selectStartingPoint( QList<QPoint> allowedStartingPoints )
 {
+    if( m_suspended ) {
+        m_pendingStartingPoints.clear();
+        emit startingPointSelected( allowedStartingPoints.first() );
+        return;
+    }
+
+    m_pendingStartingPoints = allowedStartingPoints;
+
     QByteArray data;
     QDataStream outstream( &data, QIODevice::WriteOnly );
 
@@ -122,6 +256,14 @@ void ServerClient::selectStartingPoint( QList<QPoint> allowedStartingPoints )
 
 void ServerClient::selectStartingOrientation( QList<Core::Orientation> allowedOrientations )
 {
+    if( m_suspended ) {
+        m_pendingOrientations.clear();
+        emit startingOrientationSelected( allowedOrientations.first() );
+        return;
+    }
+
+    m_pendingOrientations = allowedOrientations;
+
     QList<quint16> orientations;
     foreach( const Core::Orientation & rot, allowedOrientations ) {
         orientations.append(( quint16 )rot );
@@ -170,14 +312,30 @@ void ServerClient::powerDownRobot()
     m_connection->sendData( DATA_POWER_DOWN_REQUEST, data );
 }
 
-void ServerClient::animationFinished()
+void ServerClient::animationFinished( quint32 barrier )
 {
+    Q_UNUSED( barrier );
+
     // unused in the server
     // ondataReceived tells the gameengine directly
 }
 
 void ServerClient::onDataReceived( BotRace::Network::DataType_T dataType, QByteArray data )
 {
+    // spectators have no participant and are not part of the animation barrier
+    if( m_spectator ) {
+        switch( dataType ) {
+        case DATA_SEND_PROGRAM_LIST:
+        case DATA_POWER_DOWN_REQUEST:
+        case DATA_ANIMATION_FINISHED:
+        case DATA_SELECTED_STARTING_POINT:
+        case DATA_SELECTED_STARTING_ORIENTATION:
+            return;
+        default:
+            break;
+        }
+    }
+
     switch( dataType ) {
     case HANDSHAKE: {
         qDebug() << "ServerClient::onDataReceived || HANDSHAKE";
@@ -187,7 +345,41 @@ void ServerClient::onDataReceived( BotRace::Network::DataType_T dataType, QByteA
         instream >> name;
         setName( name );
 
-        emit handshakesSuccessful( this );
+        // clients of older versions don't send a token, the spectator flag or their protocol version
+        QUuid sessionToken;
+        quint32 protocolVersion = 0;
+        if( !instream.atEnd() ) {
+            instream >> sessionToken;
+        }
+        if( !instream.atEnd() ) {
+            instream >> m_spectator;
+        }
+        if( !instream.atEnd() ) {
+            instream >> protocolVersion;
+        }
+
+        if( protocolVersion != PROTOCOL_VERSION ) {
+            qWarning() << "ServerClient::onDataReceived || refused" << name << "with protocol version" << protocolVersion
+                       << "the server uses" << PROTOCOL_VERSION;
+
+            QByteArray answer;
+            QDataStream outstream( &answer, QIODevice::WriteOnly );
+            outstream << PROTOCOL_VERSION;
+            m_connection->sendData( DATA_PROTOCOL_MISMATCH, answer );
+
+            // the client was never handed to the server, nobody else knows it
+            m_connection->disconnect();
+            deleteLater();
+            break;
+        }
+
+        // spectators have nothing to resume, they simply receive a new snapshot
+        if( !sessionToken.isNull() && !m_spectator ) {
+            emit resumeRequested( this, sessionToken );
+        }
+        else {
+            emit handshakesSuccessful( this );
+        }
         break;
     }
     case DATA_SEND_PROGRAM_LIST: {
@@ -198,6 +390,7 @@ void ServerClient::onDataReceived( BotRace::Network::DataType_T dataType, QByteA
         instream >> program;
 
         getDeck()->setProgram( program );
+        m_programmingPending = false;
 
         emit finishedProgramming();
         break;
@@ -207,9 +400,14 @@ void ServerClient::onDataReceived( BotRace::Network::DataType_T dataType, QByteA
         powerDownRobot();
         break;
     }
-    case SIGNAL_ANIMATION_FINISHED: {
-        qDebug() << "ServerClient::onDataReceived || SIGNAL_ANIMATION_FINISHED";
-        m_gameEngine->clientAnimationFinished( this );
+    case DATA_ANIMATION_FINISHED: {
+        quint32 barrier;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+
+        instream >> barrier;
+
+        qDebug() << "ServerClient::onDataReceived || DATA_ANIMATION_FINISHED :" << barrier;
+        m_gameEngine->clientAnimationFinished( this, barrier );
         break;
     }
     case DATA_SELECTED_STARTING_POINT: {
@@ -219,6 +417,7 @@ void ServerClient::onDataReceived( BotRace::Network::DataType_T dataType, QByteA
 
         instream >> selectedPoint;
 
+        m_pendingStartingPoints.clear();
         emit startingPointSelected( selectedPoint );
         break;
     }
@@ -229,9 +428,30 @@ void ServerClient::onDataReceived( BotRace::Network::DataType_T dataType, QByteA
 
         instream >> selectedOrientation;
 
+        m_pendingOrientations.clear();
         emit startingOrientationSelected(( Core::Orientation )selectedOrientation );
         break;
     }
+    case DATA_SCENARIO_REQUEST: {
+        qDebug() << "ServerClient::onDataReceived || DATA_SCENARIO_REQUEST";
+        QByteArray hash;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+
+        instream >> hash;
+
+        sendScenario( hash );
+        break;
+    }
+    case DATA_LOG_AND_CHAT_HISTORY_REQUEST: {
+        qDebug() << "ServerClient::onDataReceived || DATA_LOG_AND_CHAT_HISTORY_REQUEST";
+        quint32 sequence;
+        QDataStream instream( &data, QIODevice::ReadOnly );
+
+        instream >> sequence;
+
+        sendLogAndChatHistory( sequence );
+        break;
+    }
     case CLIENT_ADDED:
     case CLIENT_REMOVED:
     case DATA_GAME_OVER:
@@ -259,8 +479,13 @@ void ServerClient::onDataReceived( BotRace::Network::DataType_T dataType, QByteA
     case DATA_PARTICIPANT_GOT_HIT:
     case DATA_LOG_AND_CHAT_ENTRY:
     case DATA_LOG_AND_CHAT_HISTORY:
+    case SIGNAL_SKIP_ANIMATIONS:
+    case DATA_ANIMATION_BARRIER:
     case DATA_SELECT_STARTPOINT:
     case DATA_SELECT_STARTORIENTATION:
+    case DATA_SCENARIO_DATA:
+    case DATA_GAME_SNAPSHOT:
+    case DATA_PROTOCOL_MISMATCH:
         qWarning() << "serverclient received data which can't be handled :: " << dataType;
         break;
     case INVALID:
@@ -318,105 +543,72 @@ void ServerClient::sendDeckCardsRemoved()
     m_connection->sendSignal( SIGNAL_CLEAR_DECK );
 }
 
-void ServerClient::connectParticipant( BotRace::Core::Participant *player )
+void ServerClient::sendSkipAnimations()
 {
-    qDebug() << "ServerClient::connectParticipant ::" << player->getName();
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
-
-    outstream << *player;
-
-    m_connection->sendData( PARTICIPANT_CHANGES, data );
-
-    connect( player, SIGNAL( nameChanged() ), this, SLOT( sendParticipantChanges() ) );
-    connect( player, SIGNAL( destroyed() ), this, SLOT( sendParticipantDead() ) );
-    connect( player, SIGNAL( resurrected() ), this, SLOT( sendParticipantResurrected() ) );
-    connect( player, SIGNAL( gotHit( BotRace::Core::Robot::DamageReason_T ) ), this, SLOT( sendParticipantGotHit( BotRace::Core::Robot::DamageReason_T ) ) );
-
-    connect( player, SIGNAL( lifeCountChanged( ushort ) ),this, SLOT( sendParticipantChanges() ) );
-    connect( player, SIGNAL( damageTokenCountChanged( ushort ) ),this, SLOT( sendParticipantChanges() ) );
-    connect( player, SIGNAL( positionChanged( QPoint, BotRace::Core::Orientation ) ),this, SLOT( sendParticipantChanges() ) );
-    connect( player, SIGNAL( flagGoalChanged( ushort ) ),this, SLOT( sendParticipantChanges() ) );
-    connect( player, SIGNAL( archiveMarkerChanged( QPoint ) ),this, SLOT( sendParticipantChanges() ) );
-    connect( player, SIGNAL( shootsTo(QPoint)), this, SLOT(sendRobotShootLasers(QPoint)));
-    connect( player, SIGNAL( statisticsChaged()), this, SLOT( sendParticipantChanges() ) );
-    connect( player, SIGNAL( isVirtualRobot(bool)), this, SLOT( sendParticipantChanges() ) );
-    connect( player, SIGNAL( powerDownChanged(bool)), this, SLOT( sendParticipantChanges() ) );
-
-    if(player->getUuid() == getUuid()) {
-        connect( player->getDeck(), SIGNAL( receiveDeckcard( ushort, BotRace::Core::GameCard_T ) ), this, SLOT( sendDeckCard( ushort, BotRace::Core::GameCard_T ) ) );
-        connect( player->getDeck(), SIGNAL( lockCardSlotsFrom( ushort ) ), this, SLOT( sendLockedSlots( ushort ) ) );
-        connect( player->getDeck(), SIGNAL( removeProgramCard( ushort ) ), this, SLOT( sendRemoveProgramCard( ushort ) ) );
-        connect( player->getDeck(), SIGNAL( deckCardsRemoved() ), this, SLOT( sendDeckCardsRemoved() ) );
-
-        connect( player->getDeck(), SIGNAL( programCanBeSend(bool) ), this, SLOT( sendProgramCanBeSend(bool) ) );
-        connect( player->getDeck(), SIGNAL( robotCanBeShutDown(bool) ), this, SLOT( sendRobotCanBeShutDown(bool)  ) );
-    }
+    m_connection->sendSignal( SIGNAL_SKIP_ANIMATIONS );
 }
 
-void ServerClient::sendParticipantChanges()
+void ServerClient::acknowledgeAnimation()
 {
-    Core::Participant *p = qobject_cast<Core::Participant *>( sender() );
-
-    if( !p ) {
-        return;
+    if( m_suspended && m_gameEngine ) {
+        m_gameEngine->clientAnimationFinished( this, getAnimationBarrier() );
     }
+}
 
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
-
-    outstream << *p;
-
-    m_connection->sendData( PARTICIPANT_CHANGES, data );
+void ServerClient::onGraceTimeExpired()
+{
+    emit graceTimeExpired( this );
 }
 
-void ServerClient::sendParticipantDead()
+void ServerClient::autoProgram()
 {
-    Core::Participant *p = qobject_cast<Core::Participant *>( sender() );
+    Core::CardDeck *deck = getDeck();
+    QList<Core::GameCard_T> deckCards = deck->allCardsFromDeck();
 
-    if( !p ) {
-        return;
-    }
+    // fill the free slots in the order the cards were dealt, like the SimpleBot does
+    int deckSlot = 0;
+    for( ushort slot = 1; slot <= MAX_PROGRAM_SIZE; slot++ ) {
+        if( deck->isProgramSlotLocked( slot ) || deck->getCardFromProgram( slot ).type != Core::CARD_EMPTY ) {
+            continue;
+        }
 
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
+        while( deckSlot < deckCards.size() && deckCards.at( deckSlot ).type == Core::CARD_EMPTY ) {
+            deckSlot++;
+        }
+        if( deckSlot >= deckCards.size() ) {
+            break;
+        }
 
-    outstream << p->getUuid();
+        deck->moveCardToProgram( deckSlot + 1, slot );
+        deckSlot++;
+    }
 
-    m_connection->sendData( SIGNAL_PARTICIPANT_DEAD, data );
+    m_programmingPending = false;
+    emit finishedProgramming();
 }
 
-void ServerClient::sendParticipantResurrected()
+void ServerClient::connectParticipant( BotRace::Core::Participant *player )
 {
-    Core::Participant *p = qobject_cast<Core::Participant *>( sender() );
-
-    if( !p ) {
-        return;
-    }
-
+    qDebug() << "ServerClient::connectParticipant ::" << player->getName();
     QByteArray data;
     QDataStream outstream( &data, QIODevice::WriteOnly );
 
-    outstream << p->getUuid();
-
-    m_connection->sendData( SIGNAL_PARTICIPANT_RESURRECTED, data );
-}
-
-void ServerClient::sendParticipantGotHit( BotRace::Core::Robot::DamageReason_T reason )
-{
-    Core::Participant *p = qobject_cast<Core::Participant *>( sender() );
+    outstream << *player;
 
-    if( !p ) {
-        return;
-    }
+    m_connection->sendData( PARTICIPANT_CHANGES, data );
 
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
+    // all further changes are the same for every client
+    m_broadcast->watchParticipant( player );
 
-    outstream << p->getUuid();
-    outstream << ( quint16 )reason;
+    if(player->getUuid() == getUuid()) {
+        connect( player->getDeck(), SIGNAL( receiveDeckcard( ushort, BotRace::Core::GameCard_T ) ), this, SLOT( sendDeckCard( ushort, BotRace::Core::GameCard_T ) ) );
+        connect( player->getDeck(), SIGNAL( lockCardSlotsFrom( ushort ) ), this, SLOT( sendLockedSlots( ushort ) ) );
+        connect( player->getDeck(), SIGNAL( removeProgramCard( ushort ) ), this, SLOT( sendRemoveProgramCard( ushort ) ) );
+        connect( player->getDeck(), SIGNAL( deckCardsRemoved() ), this, SLOT( sendDeckCardsRemoved() ) );
 
-    m_connection->sendData( DATA_PARTICIPANT_GOT_HIT, data );
+        connect( player->getDeck(), SIGNAL( programCanBeSend(bool) ), this, SLOT( sendProgramCanBeSend(bool) ) );
+        connect( player->getDeck(), SIGNAL( robotCanBeShutDown(bool) ), this, SLOT( sendRobotCanBeShutDown(bool)  ) );
+    }
 }
 
 void ServerClient::sendProgramCanBeSend(bool canBeSend)
@@ -456,101 +648,54 @@ void ServerClient::sendScenarioChanges()
     QByteArray data;
     QDataStream outstream( &data, QIODevice::WriteOnly );
 
-    Core::BoardScenario_T scenario = m_gameEngine->getBoard()->getScenario();
-    outstream << scenario;
+    // only the hash is send, the client loads the scenario itself or requests it
+    outstream << m_broadcast->scenarioHash();
+    outstream << m_broadcast->scenarioFileName();
 
     m_connection->sendData( DATA_SCENARIO_CHANGED, data );
 }
 
-void ServerClient::sendSettingsChanged(BotRace::Core::GameSettings_T settings)
-{
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
-
-    outstream << settings;
-
-    m_connection->sendData( DATA_SETTINGS_CHANGED, data );
-}
-
-void ServerClient::sendGameStarted()
-{
-    m_connection->sendSignal( SIGNAL_GAME_STARTED );
-}
-
-void ServerClient::sendAnimateRobotMovement()
-{
-    m_connection->sendSignal( SIGNAL_ANIMATE_ROBOTS );
-}
-
-void ServerClient::sendAnimateRobotMovement(QStringList list)
+void ServerClient::sendScenario( const QByteArray &hash )
 {
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
-
-    outstream << list;
-
-    m_connection->sendData( DATA_ANIMATE_ROBOTS_LIST, data );
-}
-
-void ServerClient::sendAnimateGraphicElements(BotRace::Core::AnimateElements animation, int phase)
-{
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
-
-    outstream << ( quint16 )animation << phase;
-
-    m_connection->sendData( DATA_ANIMATE_ELEMENTS, data );
-}
-
-void ServerClient::sendPhaseChanged(int phase)
-{
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
-
-    outstream << phase;
+    // the scenario changed meanwhile, the client requests the current one again
+    if( hash != m_broadcast->scenarioHash() ) {
+        qWarning() << "ServerClient::sendScenario || requested scenario is not used anymore";
+        sendScenarioChanges();
+        return;
+    }
 
-    m_connection->sendData( DATA_PHASE_CHANGED, data );
-}
+    QByteArray encodedScenario = m_broadcast->encodedScenario();
+    quint32 totalSize = encodedScenario.size();
 
-void ServerClient::sendKingOfFlagChanged(bool flagDropped, const QPoint &position)
-{
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
+    for( quint32 offset = 0; offset < totalSize; offset += SCENARIO_CHUNK_SIZE ) {
+        QByteArray data;
+        QDataStream outstream( &data, QIODevice::WriteOnly );
 
-    outstream << flagDropped << position;
+        outstream << hash << offset << totalSize << encodedScenario.mid( offset, SCENARIO_CHUNK_SIZE );
 
-    m_connection->sendData( DATA_KINGOFFLAG_CHANGED, data );
+        m_connection->sendData( DATA_SCENARIO_DATA, data );
+    }
 }
 
-void ServerClient::sendRobotShootLasers( const QPoint &target )
+void ServerClient::sendSettingsChanged(BotRace::Core::GameSettings_T settings)
 {
-    Core::Participant *p = qobject_cast<Core::Participant *>(sender());
-
     QByteArray data;
     QDataStream outstream( &data, QIODevice::WriteOnly );
 
-    outstream << p->getUuid() << target;
+    outstream << settings;
 
-    m_connection->sendData( SIGNAL_ANIMATE_ROBOT_LASER, data );
+    m_connection->sendData( DATA_SETTINGS_CHANGED, data );
 }
 
-void ServerClient::sendLogAndChatEntry( const Core::LogChatEntry_T entry )
+void ServerClient::sendLogAndChatHistory( quint32 sequence )
 {
-    QByteArray data;
-    QDataStream outstream( &data, QIODevice::WriteOnly );
-
-    outstream << entry;
+    Core::GameLogAndChat *glac = m_broadcast->getLogAndChat();
 
-    m_connection->sendData( DATA_LOG_AND_CHAT_ENTRY, data );
-}
-
-void ServerClient::sendLogAndChatHistory( const QList<Core::LogChatEntry_T> entry )
-{
-    // send complete Log History
     QByteArray data;
     QDataStream outstream( &data, QIODevice::WriteOnly );
 
-    outstream << entry;
+    outstream << glac->lastSequence();
+    outstream << glac->getHistorySince( sequence, LOG_HISTORY_PAGE_SIZE );
 
     m_connection->sendData( DATA_LOG_AND_CHAT_HISTORY, data );
 }
@@ -27,6 +27,11 @@
 #include "engine/cards.h"
 #include "engine/gamelogandchat.h"
 
+#include <QUuid>
+
+class QTimer;
+class QThread;
+
 namespace BotRace {
 namespace Core {
     class GameEngine;
@@ -34,6 +39,7 @@ namespace Core {
 
 namespace Network {
 class GameClient;
+class ServerBroadcast;
 
 /**
  * @brief The ServerClient class is the proxy to redirect all information of the game and other players over the network to the NetworkClient
@@ -41,15 +47,92 @@ class GameClient;
  * Connections to so so are made in
  * @li constructor all signals from the AbstractClient
  * @li setGameEngine() all signals from the gameengine which usually will be connected to the GameScene
- * @li connectParticipant() all signals for the own and other Robots and the own carddeck
+ * @li connectParticipant() all signals for the own carddeck
+ *
+ * All events which are the same for every client (animations, phase changes, participant changes)
+ * are not send from here but encoded once by the ServerBroadcast.
+ *
+ * When the NetworkClient loses its connection during a running game, the ServerClient is suspended.
+ * It keeps its place in the game and plays like a SimpleBot until the client comes back with the
+ * session token from the handshake or the grace period runs out.
  */
 class ServerClient : public Core::AbstractClient {
     Q_OBJECT
 public:
-    explicit ServerClient( Connection *connection  );
+    explicit ServerClient( Connection *connection, ServerBroadcast *broadcast );
+
+    /**
+     * @brief Returns the network connection to the NetworkClient
+     */
+    Connection *getConnection() const;
+
+    /**
+     * @brief Sets the broadcast used for the scenario, the log and the participant changes
+     *
+     * The GameTable of a running game has its own ServerBroadcast and gives the lobby
+     * broadcast back when the game is over.
+     */
+    void setBroadcast( ServerBroadcast *broadcast );
+
+    /**
+     * @brief Moves the client together with its connection and socket to @p thread
+     *
+     * Must be called from the thread the client currently lives in.
+     * @param thread the thread of the game table or the lobby
+     */
+    void changeThread( QThread *thread );
+
+    /**
+     * @brief Returns the token the NetworkClient uses to rejoin a running game after a disconnect
+     */
+    QUuid getSessionToken() const;
+
+    /**
+     * @brief Hands over the connection to the client that is resumed with it
+     *
+     * The ServerClient is not usable afterwards and should be deleted.
+     * @return the connection of this client
+     */
+    Connection *takeConnection();
+
+    /**
+     * @brief Keeps the client in the game after its connection was lost
+     *
+     * Until resume() is called all requests of the GameEngine are answered automatically.
+     * @param graceTime seconds to wait for the client before graceTimeExpired() is emitted
+     */
+    void suspend( int graceTime );
+
+    /**
+     * @brief Continues the game with the new connection of the reconnected NetworkClient
+     *
+     * Call sendGameSnapshot() afterwards so the client can restore the game.
+     * @param connection the connection taken from the temporary ServerClient of the reconnect
+     */
+    void resume( Connection *connection );
+
+    /**
+     * @brief Returns if the client lost its connection and waits for a reconnect
+     */
+    bool isSuspended() const;
+
+    /**
+     * @brief Sends the current state of the game needed by a client that rejoined a running game
+     *
+     * Contains the phase, the king of the flag, all participants, the own cards and the locked
+     * program slots as well as the newest log sequence.
+     */
+    void sendGameSnapshot();
 
     bool isBot();
 
+    /**
+     * @brief Returns if the NetworkClient asked to watch the game only
+     *
+     * Spectators are not added to a game, all their game related requests are ignored.
+     */
+    bool isSpectator() const;
+
     void setGameEngine( Core::GameEngine *ge );
     void joinGame();
     void leaveGame();
@@ -77,7 +160,7 @@ public slots:
     void startProgramming();
     void programmingFinished();
     void powerDownRobot();
-    void animationFinished();
+    void animationFinished( quint32 barrier );
 
     void selectStartingPoint( QList<QPoint> allowedStartingPoints );
     void selectStartingOrientation( QList<Core::Orientation> allowedOrientations );
@@ -87,6 +170,18 @@ public slots:
 signals:
     void handshakesSuccessful( BotRace::Network::ServerClient *client );
 
+    /**
+     * @brief The NetworkClient wants to rejoin a running game instead of joining as new client
+     * @param client this temporary client that holds the new connection
+     * @param sessionToken the token received with the handshake of the lost connection
+     */
+    void resumeRequested( BotRace::Network::ServerClient *client, const QUuid &sessionToken );
+
+    /**
+     * @brief The suspended client did not come back in time
+     */
+    void graceTimeExpired( BotRace::Network::ServerClient *client );
+
 private slots:
     void onDataReceived( BotRace::Network::DataType_T dataType, QByteArray data );
 
@@ -99,28 +194,52 @@ private slots:
 
     //player changes
     void connectParticipant(BotRace::Core::Participant *player);
-    void sendParticipantChanges();
-    void sendParticipantDead();
-    void sendParticipantResurrected();
-    void sendParticipantGotHit( BotRace::Core::Robot::DamageReason_T reason );
     void sendProgramCanBeSend(bool canBeSend);
     void sendRobotCanBeShutDown(bool canBeShuttedDown);
 
-    // game engine signals
-    void sendGameStarted();
-    void sendAnimateRobotMovement();
-    void sendAnimateRobotMovement(QStringList list);
-    void sendRobotShootLasers( const QPoint &target );
-    void sendAnimateGraphicElements(BotRace::Core::AnimateElements animation, int phase);
-    void sendPhaseChanged(int phase);
-    void sendKingOfFlagChanged(bool flagDropped, const QPoint &position);
+    // the engine stopped waiting for this client
+    void sendSkipAnimations();
 
-    void sendLogAndChatEntry( const Core::LogChatEntry_T entry );
-    void sendLogAndChatHistory( const QList<Core::LogChatEntry_T> entry );
+    // answers all animations while the client is suspended
+    void acknowledgeAnimation();
+    void onGraceTimeExpired();
 
 private:
+    /**
+     * @brief Sends the next page of log entries after @p sequence
+     *
+     * The message contains the newest sequence number of the server log, so the client
+     * knows if it has to ask for another page.
+     *
+     * @param sequence the last log entry known by the client
+     */
+    void sendLogAndChatHistory( quint32 sequence );
+
+    /**
+     * @brief Sends the compressed scenario in chunks of SCENARIO_CHUNK_SIZE
+     *
+     * If the scenario is not used anymore the hash of the current one is send instead.
+     *
+     * @param hash the content hash of the scenario requested by the client
+     */
+    void sendScenario( const QByteArray &hash );
+
+    /**
+     * @brief Fills the free program slots with the dealt cards and sends the program
+     */
+    void autoProgram();
+
     Connection *m_connection;
+    ServerBroadcast *m_broadcast;
     Core::GameEngine *m_gameEngine;
+
+    QUuid m_sessionToken;                       /**< Secret to rejoin the game, only known by the own NetworkClient */
+    bool m_suspended;                           /**< Connection is lost, requests are answered automatically */
+    bool m_spectator;                           /**< Only watches the game, set with the handshake */
+    QTimer *m_graceTimer;                       /**< Drops the suspended client when it does not reconnect */
+    bool m_programmingPending;                  /**< Programming started but no program received yet */
+    QList<QPoint> m_pendingStartingPoints;      /**< Starting point request not answered yet */
+    QList<Core::Orientation> m_pendingOrientations; /**< Starting orientation request not answered yet */
 };
 
 }